@@ -159,8 +159,6 @@ typedef struct {
 //
 // Function
 
-void gen_tabs(void);
-
 HashReturn Init(hashState *state, int hashbitlen);
 
 HashReturn Update(hashState *state, const BitSequence *data, DWORD* databitlen);
@@ -49,86 +49,75 @@ static const DWORD K512[16][2] = {0x517cc1b7, 0x27220a94, 0x2db6517c, 0xc1b72722
 								  0x0a945be8, 0x9a5fbd7d, 0x27220a94, 0x5be89a5f, 0xc1b72722, 0x0a945be8, 0x517cc1b7, 0x27220a94};
 
 
-DWORD	MDS4[4][256];
-DWORD	MDS8[8][256][2];
-BYTE	sbx[256];
+/* The tables are built by the compiler, as read-only data: sb_data lists  */
+/* the S-box, the affine transformation of the inverse in GF(2^8) with     */
+/* 0x011b as modular polynomial, and f2 .. fa multiply in that field.      */
+
+#define sb_data(w) { \
+	w(0x63), w(0x7c), w(0x77), w(0x7b), w(0xf2), w(0x6b), w(0x6f), w(0xc5), \
+	w(0x30), w(0x01), w(0x67), w(0x2b), w(0xfe), w(0xd7), w(0xab), w(0x76), \
+	w(0xca), w(0x82), w(0xc9), w(0x7d), w(0xfa), w(0x59), w(0x47), w(0xf0), \
+	w(0xad), w(0xd4), w(0xa2), w(0xaf), w(0x9c), w(0xa4), w(0x72), w(0xc0), \
+	w(0xb7), w(0xfd), w(0x93), w(0x26), w(0x36), w(0x3f), w(0xf7), w(0xcc), \
+	w(0x34), w(0xa5), w(0xe5), w(0xf1), w(0x71), w(0xd8), w(0x31), w(0x15), \
+	w(0x04), w(0xc7), w(0x23), w(0xc3), w(0x18), w(0x96), w(0x05), w(0x9a), \
+	w(0x07), w(0x12), w(0x80), w(0xe2), w(0xeb), w(0x27), w(0xb2), w(0x75), \
+	w(0x09), w(0x83), w(0x2c), w(0x1a), w(0x1b), w(0x6e), w(0x5a), w(0xa0), \
+	w(0x52), w(0x3b), w(0xd6), w(0xb3), w(0x29), w(0xe3), w(0x2f), w(0x84), \
+	w(0x53), w(0xd1), w(0x00), w(0xed), w(0x20), w(0xfc), w(0xb1), w(0x5b), \
+	w(0x6a), w(0xcb), w(0xbe), w(0x39), w(0x4a), w(0x4c), w(0x58), w(0xcf), \
+	w(0xd0), w(0xef), w(0xaa), w(0xfb), w(0x43), w(0x4d), w(0x33), w(0x85), \
+	w(0x45), w(0xf9), w(0x02), w(0x7f), w(0x50), w(0x3c), w(0x9f), w(0xa8), \
+	w(0x51), w(0xa3), w(0x40), w(0x8f), w(0x92), w(0x9d), w(0x38), w(0xf5), \
+	w(0xbc), w(0xb6), w(0xda), w(0x21), w(0x10), w(0xff), w(0xf3), w(0xd2), \
+	w(0xcd), w(0x0c), w(0x13), w(0xec), w(0x5f), w(0x97), w(0x44), w(0x17), \
+	w(0xc4), w(0xa7), w(0x7e), w(0x3d), w(0x64), w(0x5d), w(0x19), w(0x73), \
+	w(0x60), w(0x81), w(0x4f), w(0xdc), w(0x22), w(0x2a), w(0x90), w(0x88), \
+	w(0x46), w(0xee), w(0xb8), w(0x14), w(0xde), w(0x5e), w(0x0b), w(0xdb), \
+	w(0xe0), w(0x32), w(0x3a), w(0x0a), w(0x49), w(0x06), w(0x24), w(0x5c), \
+	w(0xc2), w(0xd3), w(0xac), w(0x62), w(0x91), w(0x95), w(0xe4), w(0x79), \
+	w(0xe7), w(0xc8), w(0x37), w(0x6d), w(0x8d), w(0xd5), w(0x4e), w(0xa9), \
+	w(0x6c), w(0x56), w(0xf4), w(0xea), w(0x65), w(0x7a), w(0xae), w(0x08), \
+	w(0xba), w(0x78), w(0x25), w(0x2e), w(0x1c), w(0xa6), w(0xb4), w(0xc6), \
+	w(0xe8), w(0xdd), w(0x74), w(0x1f), w(0x4b), w(0xbd), w(0x8b), w(0x8a), \
+	w(0x70), w(0x3e), w(0xb5), w(0x66), w(0x48), w(0x03), w(0xf6), w(0x0e), \
+	w(0x61), w(0x35), w(0x57), w(0xb9), w(0x86), w(0xc1), w(0x1d), w(0x9e), \
+	w(0xe1), w(0xf8), w(0x98), w(0x11), w(0x69), w(0xd9), w(0x8e), w(0x94), \
+	w(0x9b), w(0x1e), w(0x87), w(0xe9), w(0xce), w(0x55), w(0x28), w(0xdf), \
+	w(0x8c), w(0xa1), w(0x89), w(0x0d), w(0xbf), w(0xe6), w(0x42), w(0x68), \
+	w(0x41), w(0x99), w(0x2d), w(0x0f), w(0xb0), w(0x54), w(0xbb), w(0x16) }
+
+#define f2(x)		((BYTE)(((x) << 1) ^ ((((x) >> 7) & 1) * 0x11b)))
+#define f3(x)		((BYTE)(f2(x) ^ (x)))
+#define f4(x)		f2(f2(x))
+#define f8(x)		f2(f4(x))
+#define f9(x)		((BYTE)(f8(x) ^ (x)))
+#define fa(x)		((BYTE)(f8(x) ^ f2(x)))
+
+#define w4(a,b,c,d)		((DWORD)(a) | ((DWORD)(b) << 8) | ((DWORD)(c) << 16) | ((DWORD)(d) << 24))
+
+#define m40(x)	w4(f2(x), x, x, f3(x))
+#define m41(x)	w4(f3(x), f2(x), x, x)
+#define m42(x)	w4(x, f3(x), f2(x), x)
+#define m43(x)	w4(x, x, f3(x), f2(x))
+
+/* the 64-bit rotation left of m8 by 8n is m8n, as its low and high DWORDs */
+#define m8(a,b,c,d,e,f,g,h)	{ w4(a,b,c,d), w4(e,f,g,h) }
+
+#define m80(x)	m8(x, x, f4(x), x, f8(x), f9(x), fa(x), f2(x))
+#define m81(x)	m8(f2(x), x, x, f4(x), x, f8(x), f9(x), fa(x))
+#define m82(x)	m8(fa(x), f2(x), x, x, f4(x), x, f8(x), f9(x))
+#define m83(x)	m8(f9(x), fa(x), f2(x), x, x, f4(x), x, f8(x))
+#define m84(x)	m8(f8(x), f9(x), fa(x), f2(x), x, x, f4(x), x)
+#define m85(x)	m8(x, f8(x), f9(x), fa(x), f2(x), x, x, f4(x))
+#define m86(x)	m8(f4(x), x, f8(x), f9(x), fa(x), f2(x), x, x)
+#define m87(x)	m8(x, f4(x), x, f8(x), f9(x), fa(x), f2(x), x)
+
+static const DWORD MDS4[4][256] = { sb_data(m40), sb_data(m41), sb_data(m42), sb_data(m43) };
+static const DWORD MDS8[8][256][2] = { sb_data(m80), sb_data(m81), sb_data(m82), sb_data(m83),
+									   sb_data(m84), sb_data(m85), sb_data(m86), sb_data(m87) };
 
-#define ff_mult(a, b)	(a && b ? pow_tab[(log_tab[a] + log_tab[b]) % 255] : 0)
 #define byte(x, n)		((BYTE)((x) >> (8 * n)))
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-//
-// FUNCTION NAME  : gen_tabs
-//
-// DESCRIPTION    : Generate the s-box table and field multiplication table
-//
-// PARAMETERS     : void
-//                  
-//
-// RETURNS        : void
-//
-///////////////////////////////////////////////////////////////////////////////////////////////////
-void gen_tabs(void)
-{   
-	DWORD i, t[2];
-    BYTE p, q;
-	BYTE	pow_tab[256];
-	BYTE	log_tab[256];
-	DWORD temp2, temp4, temp8;
- 
-	/* log and power tables for GF(2^8) finite field with  */
-    /* 0x011b as modular polynomial - the simplest prmitive */
-    /* root is 0x03, used here to generate the tables       */
-
-    for (i = 0, p = 1; i < 256; ++i)
-    {
-        pow_tab[i] = (BYTE)p;
-		log_tab[p] = (BYTE)i;
-
-        p = p ^ (p << 1) ^ (p & 0x80 ? 0x01b : 0);
-    }
-
-    /* note that the affine byte transformation matrix in   */
-    /* ARIRANG specification is in big endian format with  */
-    /* bit 0 as the most significant bit. In the remainder  */
-    /* of the specification the bits are numbered from the  */
-    /* least significant end of a byte.                     */
-
-    for (i = 0; i < 256; ++i)
-    {   
-        p = (i ? pow_tab[255 - log_tab[i]] : 0); q = p; 
-        q = (q >> 7) | (q << 1); p ^= q; 
-        q = (q >> 7) | (q << 1); p ^= q; 
-        q = (q >> 7) | (q << 1); p ^= q; 
-        q = (q >> 7) | (q << 1); p ^= q ^ 0x63; 
-        sbx[i] = p;
-    }
-
-    for (i = 0; i < 256; ++i)
-    {
-        p = sbx[i];
-
-        t[0] = ((DWORD)ff_mult(2, p)) | ((DWORD)p <<  8) | ((DWORD)p << 16) | ((DWORD)ff_mult(3, p) << 24);
-        
-        MDS4[0][i] = t[0];			MDS4[1][i] = SS(t[0],  8);	MDS4[2][i] = SS(t[0], 16);	MDS4[3][i] = SS(t[0], 24);
-       		
-		temp2=ff_mult(2,p);
-		temp4=ff_mult(2,temp2);
-		temp8=ff_mult(2,temp4);
-
-		t[0] = ((DWORD)temp8) | ((DWORD)(temp8^p) <<  8) | ((DWORD)(temp8^temp2) << 16) | ((DWORD)(temp2) << 24);
-        t[1] = ((DWORD)p) | ((DWORD)p <<  8) | ((DWORD)temp4 << 16) | ((DWORD)p << 24);
-		        
-        MDS8[0][i][1] = t[0];				MDS8[0][i][0] = t[1];
-		MDS8[1][i][1] = SS1(t[0],t[1],  8);	MDS8[1][i][0] = SS2(t[0],t[1],  8);
-		MDS8[2][i][1] = SS1(t[0],t[1], 16);	MDS8[2][i][0] = SS2(t[0],t[1], 16);	
-		MDS8[3][i][1] = SS1(t[0],t[1], 24);	MDS8[3][i][0] = SS2(t[0],t[1], 24);
-		MDS8[4][i][1] = t[1];				MDS8[4][i][0] = t[0];
-		MDS8[5][i][1] = SS2(t[0],t[1],  8);	MDS8[5][i][0] = SS1(t[0],t[1],  8);
-		MDS8[6][i][1] = SS2(t[0],t[1], 16);	MDS8[6][i][0] = SS1(t[0],t[1], 16);
-		MDS8[7][i][1] = SS2(t[0],t[1], 24);	MDS8[7][i][0] = SS1(t[0],t[1], 24);
-	}
-}
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // FUNCTION NAME  : step256
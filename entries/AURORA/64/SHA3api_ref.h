@@ -83,6 +83,9 @@ HashReturn Update(hashState *state, const BitSequence *data, DataLength databitl
 HashReturn Final(hashState *state, BitSequence *hashval);
 HashReturn Hash(int hashbitlen, const BitSequence *data, DataLength databitlen, BitSequence *hashval);
 
+/* picks the variant of the compression functions; see aurora_opt64.c */
+HashReturn UseVariant(const char *name);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,436 @@
+/******************************************************************************
+ * Copyright 2008 Sony Corporation
+ *
+ * aurora_opt64_cf.h
+ *
+ * "AURORA: A Cryptographic Hash Algorithm Family"
+ * compression functions of the optimized ANSI C code for 64-bit processors
+ *
+ * aurora_opt64.c includes this file once for each variant, with _USE_SHIFT,
+ * _SHARE_TABLE or neither defined, and with AURORA_CF_NAME(_name) giving
+ * the names that variant's compression functions are to have.
+ *
+ *****************************************************************************/
+
+
+#if !defined(_USE_SHIFT) && !defined(_SHARE_TABLE)
+
+#define F0_0(_x) aurora_sm00[(_x)]
+#define F0_1(_x) aurora_sm01[(_x)]
+#define F0_2(_x) aurora_sm02[(_x)]
+#define F0_3(_x) aurora_sm03[(_x)]
+
+#define F1_0(_x) aurora_sm10[(_x)]
+#define F1_1(_x) aurora_sm11[(_x)]
+#define F1_2(_x) aurora_sm12[(_x)]
+#define F1_3(_x) aurora_sm13[(_x)]
+
+#define F2_0(_x) aurora_sm20[(_x)]
+#define F2_1(_x) aurora_sm21[(_x)]
+#define F2_2(_x) aurora_sm22[(_x)]
+#define F2_3(_x) aurora_sm23[(_x)]
+
+#define F3_0(_x) aurora_sm30[(_x)]
+#define F3_1(_x) aurora_sm31[(_x)]
+#define F3_2(_x) aurora_sm32[(_x)]
+#define F3_3(_x) aurora_sm33[(_x)]
+
+#define AURORA_F64(_dst, _s0, _s1, _s2, _s3, _s4, _s5, _s6, _s7, _tbx00, _tbx01, _tbx02, _tbx03, _tbx10, _tbx11, _tbx12, _tbx13) \
+{ (_dst) = _tbx00( (_s0) >> 56         ) ^\
+           _tbx01(((_s1) >> 16) & 0xffU) ^\
+           _tbx02(((_s2) >> 40) & 0xffU) ^\
+           _tbx03( (_s3)        & 0xffU) ^\
+           _tbx10(((_s4) >> 24) & 0xffU) ^\
+           _tbx11(((_s5) >> 48) & 0xffU) ^\
+           _tbx12(((_s6) >> 8)  & 0xffU) ^\
+           _tbx13(((_s7) >> 32) & 0xffU);\
+}
+
+#define AURORA_F64_CP(_dst, _s0, _s1, _s2, _s3, _s4, _s5, _s6, _s7, _tbx00, _tbx01, _tbx02, _tbx03, _tbx10, _tbx11, _tbx12, _tbx13) \
+{ (_dst) = _tbx00( (_s0) >> 56         ) ^\
+           _tbx01(((_s1) >> 16) & 0xffU) ^\
+           _tbx02(((_s2) >> 40) & 0xffU) ^\
+           _tbx03( (_s3)        & 0xffU) ^\
+           _tbx10(((_s4) >> 24) & 0xffU) ^\
+           _tbx11(((_s5) >> 48) & 0xffU) ^\
+           _tbx12(((_s6) >> 8)  & 0xffU) ^\
+           _tbx13(((_s7) >> 32) & 0xffU);\
+}
+
+#elif !defined(_SHARE_TABLE) /* _USE_SHIFT */
+
+#define F0_0(_x) aurora_sm00[(_x)]
+#define F0_1(_x) aurora_sm01[(_x)]
+#define F0_2(_x) aurora_sm02[(_x)]
+#define F0_3(_x) aurora_sm03[(_x)]
+
+#define F1_0(_x) aurora_sm10[(_x)]
+#define F1_1(_x) aurora_sm11[(_x)]
+#define F1_2(_x) aurora_sm12[(_x)]
+#define F1_3(_x) aurora_sm13[(_x)]
+
+#define F2_0(_x) aurora_sm10[(_x)]
+#define F2_1(_x) aurora_sm11[(_x)]
+#define F2_2(_x) aurora_sm12[(_x)]
+#define F2_3(_x) aurora_sm13[(_x)]
+
+#define F3_0(_x) aurora_sm00[(_x)]
+#define F3_1(_x) aurora_sm01[(_x)]
+#define F3_2(_x) aurora_sm02[(_x)]
+#define F3_3(_x) aurora_sm03[(_x)]
+
+#define AURORA_F64(_dst, _s0, _s1, _s2, _s3, _s4, _s5, _s6, _s7, _tbx00, _tbx01, _tbx02, _tbx03, _tbx10, _tbx11, _tbx12, _tbx13) \
+{ (_dst) = _tbx00( (_s0) >> 56         ) ^\
+           _tbx01(((_s1) >> 16) & 0xffU) ^\
+           _tbx02(((_s2) >> 40) & 0xffU) ^\
+           _tbx03( (_s3)        & 0xffU) ^\
+           _tbx10(((_s4) >> 24) & 0xffU) ^\
+           _tbx11(((_s5) >> 48) & 0xffU) ^\
+           _tbx12(((_s6) >> 8)  & 0xffU) ^\
+           _tbx13(((_s7) >> 32) & 0xffU);\
+}
+
+#define AURORA_F64_CP(_dst, _s0, _s1, _s2, _s3, _s4, _s5, _s6, _s7, _tbx00, _tbx01, _tbx02, _tbx03, _tbx10, _tbx11, _tbx12, _tbx13) \
+{ (_dst) = ((_tbx00( (_s0) >> 56         ) ^\
+             _tbx01(((_s1) >> 16) & 0xffU) ^\
+             _tbx02(((_s2) >> 40) & 0xffU) ^\
+             _tbx03( (_s3)        & 0xffU)) << 32) ^\
+           ((_tbx10(((_s4) >> 24) & 0xffU) ^\
+             _tbx11(((_s5) >> 48) & 0xffU) ^\
+             _tbx12(((_s6) >> 8)  & 0xffU) ^\
+             _tbx13(((_s7) >> 32) & 0xffU)) >> 32);\
+}
+
+#else /* _SHARE_TABLE */
+
+#define F0_0(_x) aurora_sm0[(_x)]
+#define F0_1(_x) aurora_sm1[(_x)]
+#define F0_2(_x) aurora_sm2[(_x)]
+#define F0_3(_x) aurora_sm3[(_x)]
+
+#define F1_0(_x) aurora_sm0[(_x)]
+#define F1_1(_x) aurora_sm1[(_x)]
+#define F1_2(_x) aurora_sm2[(_x)]
+#define F1_3(_x) aurora_sm3[(_x)]
+
+#define F2_0(_x) aurora_sm0[(_x)]
+#define F2_1(_x) aurora_sm1[(_x)]
+#define F2_2(_x) aurora_sm2[(_x)]
+#define F2_3(_x) aurora_sm3[(_x)]
+
+#define F3_0(_x) aurora_sm0[(_x)]
+#define F3_1(_x) aurora_sm1[(_x)]
+#define F3_2(_x) aurora_sm2[(_x)]
+#define F3_3(_x) aurora_sm3[(_x)]
+
+#define AURORA_F64(_dst, _s0, _s1, _s2, _s3, _s4, _s5, _s6, _s7, _tbx00, _tbx01, _tbx02, _tbx03, _tbx10, _tbx11, _tbx12, _tbx13) \
+{ (_dst) = ((_tbx00( (_s0) >> 56         ) ^\
+             _tbx01(((_s1) >> 16) & 0xffU) ^\
+             _tbx02(((_s2) >> 40) & 0xffU) ^\
+             _tbx03( (_s3)        & 0xffU)) & u64(ffffffff00000000)) ^\
+           ((_tbx10(((_s4) >> 24) & 0xffU) ^\
+             _tbx11(((_s5) >> 48) & 0xffU) ^\
+             _tbx12(((_s6) >> 8)  & 0xffU) ^\
+             _tbx13(((_s7) >> 32) & 0xffU)) & u64(00000000ffffffff));\
+}
+
+#define AURORA_F64_CP(_dst, _s0, _s1, _s2, _s3, _s4, _s5, _s6, _s7, _tbx00, _tbx01, _tbx02, _tbx03, _tbx10, _tbx11, _tbx12, _tbx13) \
+{ (_dst) = ((_tbx00( (_s0) >> 56         ) ^\
+             _tbx01(((_s1) >> 16) & 0xffU) ^\
+             _tbx02(((_s2) >> 40) & 0xffU) ^\
+             _tbx03( (_s3)        & 0xffU)) << 32) ^\
+           ((_tbx10(((_s4) >> 24) & 0xffU) ^\
+             _tbx11(((_s5) >> 48) & 0xffU) ^\
+             _tbx12(((_s6) >> 8)  & 0xffU) ^\
+             _tbx13(((_s7) >> 32) & 0xffU)) >> 32);\
+}
+
+#endif /* ?_USE_SHIFT, _SHARE_TABLE */
+
+
+#define AURORA256_2ROUNDS_OPT64(_idx) \
+{ /* MS_L */ \
+  AURORA_F64(fmsl[0], ml[2], ml[3], ml[3], ml[2], ml[2], ml[2], ml[3], ml[3], F0_0, F0_1, F0_2, F0_3, F1_0, F1_1, F1_2, F1_3); \
+  AURORA_F64(fmsl[1], ml[3], ml[2], ml[2], ml[3], ml[3], ml[3], ml[2], ml[2], F0_0, F0_1, F0_2, F0_3, F1_0, F1_1, F1_2, F1_3); \
+  /* XORing after F and XORing with CONM_L */ \
+  ml[2] = fmsl[0] ^ (ml[0] << 32) ^ (ml[1] >> 32) ^ aurora256conml[(_idx) * 2 + 0]; \
+  ml[3] = fmsl[1] ^ (ml[1] << 32) ^ (ml[0] >> 32) ^ aurora256conml[(_idx) * 2 + 1]; \
+  ml[0] = fmsl[0]; \
+  ml[1] = fmsl[1]; \
+  /* CP (R1) */ \
+  AURORA_F64_CP(fcp[0], x[2], x[3], x[3], x[2], x[2], x[2], x[3], x[3], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3); \
+  AURORA_F64_CP(fcp[1], x[3], x[2], x[2], x[3], x[3], x[3], x[2], x[2], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3); \
+  /* XORing after F and XORing with CONC */ \
+  x[2] = fcp[0] ^ (x[0] << 32) ^ (x[1] >> 32) ^ aurora256conc[(_idx) * 4 - 2] ^ (mr[2] >> 1) ^ (mr[2] << 63); \
+  x[3] = fcp[1] ^ (x[1] << 32) ^ (x[0] >> 32) ^ aurora256conc[(_idx) * 4 - 1] ^ mr[3] ^ mask; \
+  x[0] = fcp[0] ^ mr[0]; \
+  x[1] = fcp[1] ^ mr[1]; \
+  /* MS_R */ \
+  AURORA_F64(fmsr[0], mr[2], mr[3], mr[3], mr[2], mr[2], mr[2], mr[3], mr[3], F0_3, F0_0, F0_1, F0_2, F1_1, F1_2, F1_3, F1_0); \
+  AURORA_F64(fmsr[1], mr[3], mr[2], mr[2], mr[3], mr[3], mr[3], mr[2], mr[2], F0_3, F0_0, F0_1, F0_2, F1_1, F1_2, F1_3, F1_0); \
+  /* XORing after F and XORing with CONM_R */ \
+  mr[2] = fmsr[0] ^ (mr[0] << 32) ^ (mr[1] >> 32) ^ aurora256conmr[(_idx) * 2 + 0]; \
+  mr[3] = fmsr[1] ^ (mr[1] << 32) ^ (mr[0] >> 32) ^ aurora256conmr[(_idx) * 2 + 1]; \
+  mr[0] = fmsr[0]; \
+  mr[1] = fmsr[1]; \
+  /* CP (R2) */ \
+  AURORA_F64_CP(fcp[0], x[2], x[3], x[3], x[2], x[2], x[2], x[3], x[3], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3); \
+  AURORA_F64_CP(fcp[1], x[3], x[2], x[2], x[3], x[3], x[3], x[2], x[2], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3); \
+  /* XORing after F and XORing with CONC */ \
+  x[2] = fcp[0] ^ (x[0] << 32) ^ (x[1] >> 32) ^ aurora256conc[(_idx) * 4 + 0] ^ (ml[2] << 1) ^ (ml[2] >> 63); \
+  x[3] = fcp[1] ^ (x[1] << 32) ^ (x[0] >> 32) ^ aurora256conc[(_idx) * 4 + 1] ^ ml[3] ^ mask; \
+  x[0] = fcp[0] ^ ml[0]; \
+  x[1] = fcp[1] ^ ml[1]; \
+}
+
+  
+/*
+ * Aurora256CF
+ *
+ * compression function for AURORA-224/256
+ */
+static void AURORA_CF_NAME(Aurora256CF)(AURORA_CTX *hctx, const BitSequence *msg, const AURORA_UINT64 mask)
+{
+  AURORA_UINT64 ml[4];
+  AURORA_UINT64 mr[4];
+  AURORA_UINT64 x[4];
+  AURORA_UINT64 fmsl[2], fmsr[2], fcp[2];
+#ifdef _LOOPED
+  int i;
+#endif
+
+  x[0] = (hctx->h[0] & u64(ffffffff00000000)) | (hctx->h[1] >> 32);
+  x[2] = (hctx->h[0] << 32) | (hctx->h[1] & u64(00000000ffffffff));
+  x[1] = (hctx->h[2] & u64(ffffffff00000000)) | (hctx->h[3] >> 32);
+  x[3] = (hctx->h[2] << 32) | (hctx->h[3] & u64(00000000ffffffff));
+
+  READ64BIT_OPT64(ml[0], msg + 0,  msg + 8);
+  READ64BIT_OPT64(ml[1], msg + 16, msg + 24);
+  READ64BIT_OPT64(ml[2], msg + 4,  msg + 12);
+  READ64BIT_OPT64(ml[3], msg + 20, msg + 28);
+
+  READ64BIT_OPT64(mr[0], msg + 32, msg + 40);
+  READ64BIT_OPT64(mr[1], msg + 48, msg + 56);
+  READ64BIT_OPT64(mr[2], msg + 36, msg + 44);
+  READ64BIT_OPT64(mr[3], msg + 52, msg + 60);
+
+  /* whitening */
+  ml[2] ^= aurora256conml[0];
+  ml[3] ^= aurora256conml[1];
+  mr[2] ^= aurora256conmr[0];
+  mr[3] ^= aurora256conmr[1];
+
+  x[0] ^= ml[0];
+  x[1] ^= ml[1];
+  x[2] ^= (ml[2] << 1) ^ (ml[2] >> 63) ^ aurora256conc[0];
+  x[3] ^= ml[3] ^ aurora256conc[1] ^ mask;
+
+#ifndef _LOOPED /* = _LOOP_UNROLL */
+  AURORA256_2ROUNDS_OPT64(1); /* R1,  R2  */
+  AURORA256_2ROUNDS_OPT64(2); /* R3,  R4  */
+  AURORA256_2ROUNDS_OPT64(3); /* R5,  R6  */
+  AURORA256_2ROUNDS_OPT64(4); /* R7,  R8  */
+  AURORA256_2ROUNDS_OPT64(5); /* R9,  R10 */
+  AURORA256_2ROUNDS_OPT64(6); /* R11, R12 */
+  AURORA256_2ROUNDS_OPT64(7); /* R13, R14 */
+  AURORA256_2ROUNDS_OPT64(8); /* R15, R16 */
+#else /* _LOOPED */
+  for(i = 1; i <= 8; i++){
+    AURORA256_2ROUNDS_OPT64(i);
+  }
+#endif
+
+  /* final round (R17) */
+
+  /* CP */
+  AURORA_F64_CP(fcp[0], x[2], x[3], x[3], x[2], x[2], x[2], x[3], x[3], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3);
+  AURORA_F64_CP(fcp[1], x[3], x[2], x[2], x[3], x[3], x[3], x[2], x[2], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3);
+
+  /* XORing after F */
+  x[2] = fcp[0] ^ (x[0] << 32) ^ (x[1] >> 32) ^ (mr[2] >> 1) ^ (mr[2] << 63);
+  x[3] = fcp[1] ^ (x[1] << 32) ^ (x[0] >> 32) ^ mr[3];
+  x[0] = fcp[0] ^ mr[0];
+  x[1] = fcp[1] ^ mr[1];
+
+  /* XORing after F + XORing after CP */
+  hctx->h[0] ^= (x[0] & u64(ffffffff00000000)) ^ (x[2] >> 32);
+  hctx->h[1] ^= (x[0] << 32) ^ (x[2] & u64(00000000ffffffff));
+  hctx->h[2] ^= (x[1] & u64(ffffffff00000000)) ^ (x[3] >> 32);
+  hctx->h[3] ^= (x[1] << 32) ^ (x[3] & u64(00000000ffffffff));
+}
+
+
+#define AURORA512_2ROUNDS_OPT64(_idx) \
+{ /* MS_L */ \
+  AURORA_F64(fmsl[0], ml[2], ml[3], ml[3], ml[2], ml[2], ml[2], ml[3], ml[3], F0_0, F0_1, F0_2, F0_3, F1_0, F1_1, F1_2, F1_3); \
+  AURORA_F64(fmsl[1], ml[3], ml[2], ml[2], ml[3], ml[3], ml[3], ml[2], ml[2], F0_0, F0_1, F0_2, F0_3, F1_0, F1_1, F1_2, F1_3); \
+  /* XORing after F and XORing with CONM_L */ \
+  ml[2] = fmsl[0] ^ (ml[0] << 32) ^ (ml[1] >> 32) ^ aurora512conml[(_idx) * 2 + 0]; \
+  ml[3] = fmsl[1] ^ (ml[1] << 32) ^ (ml[0] >> 32) ^ aurora512conml[(_idx) * 2 + 1]; \
+  ml[0] = fmsl[0]; \
+  ml[1] = fmsl[1]; \
+  /* CP_L (R1) */ \
+  AURORA_F64_CP(fcpl[0], xl[2], xl[3], xl[3], xl[2], xl[2], xl[2], xl[3], xl[3], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3); \
+  AURORA_F64_CP(fcpl[1], xl[3], xl[2], xl[2], xl[3], xl[3], xl[3], xl[2], xl[2], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3); \
+  /* XORing after F and XORing with CONC_L */ \
+  xl[2] = fcpl[0] ^ (xl[0] << 32) ^ (xl[1] >> 32) ^ aurora512concl[(_idx) * 4 - 2] ^ (mr[2] >> 1) ^ (mr[2] << 63); \
+  xl[3] = fcpl[1] ^ (xl[1] << 32) ^ (xl[0] >> 32) ^ aurora512concl[(_idx) * 4 - 1] ^ mr[3] ^ mask; \
+  xl[0] = fcpl[0] ^ mr[0]; \
+  xl[1] = fcpl[1] ^ mr[1]; \
+  /* CP_R (R1) */ \
+  AURORA_F64_CP(fcpr[0], xr[2], xr[3], xr[3], xr[2], xr[2], xr[2], xr[3], xr[3], F2_1, F2_2, F2_3, F2_0, F3_3, F3_0, F3_1, F3_2); \
+  AURORA_F64_CP(fcpr[1], xr[3], xr[2], xr[2], xr[3], xr[3], xr[3], xr[2], xr[2], F2_1, F2_2, F2_3, F2_0, F3_3, F3_0, F3_1, F3_2); \
+  /* XORing after F and XORing with CONC_R */ \
+  xr[2] = fcpr[0] ^ (xr[0] << 32) ^ (xr[1] >> 32) ^ aurora512concr[(_idx) * 4 - 2] ^ (mr[2] >> 1) ^ (mr[2] << 63); \
+  xr[3] = fcpr[1] ^ (xr[1] << 32) ^ (xr[0] >> 32) ^ aurora512concr[(_idx) * 4 - 1] ^ mr[3] ^ mask; \
+  xr[0] = fcpr[0] ^ mr[0]; \
+  xr[1] = fcpr[1] ^ mr[1]; \
+  /* MS_R */ \
+  AURORA_F64(fmsr[0], mr[2], mr[3], mr[3], mr[2], mr[2], mr[2], mr[3], mr[3], F0_3, F0_0, F0_1, F0_2, F1_1, F1_2, F1_3, F1_0); \
+  AURORA_F64(fmsr[1], mr[3], mr[2], mr[2], mr[3], mr[3], mr[3], mr[2], mr[2], F0_3, F0_0, F0_1, F0_2, F1_1, F1_2, F1_3, F1_0); \
+  /* XORing after F and XORing with CONM_R */ \
+  mr[2] = fmsr[0] ^ (mr[0] << 32) ^ (mr[1] >> 32) ^ aurora512conmr[(_idx) * 2 + 0]; \
+  mr[3] = fmsr[1] ^ (mr[1] << 32) ^ (mr[0] >> 32) ^ aurora512conmr[(_idx) * 2 + 1]; \
+  mr[0] = fmsr[0]; \
+  mr[1] = fmsr[1]; \
+  /* CP_L (R2) */ \
+  AURORA_F64_CP(fcpl[0], xl[2], xl[3], xl[3], xl[2], xl[2], xl[2], xl[3], xl[3], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3); \
+  AURORA_F64_CP(fcpl[1], xl[3], xl[2], xl[2], xl[3], xl[3], xl[3], xl[2], xl[2], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3); \
+  /* XORing after F and XORing with CONC_L */ \
+  xl[2] = fcpl[0] ^ (xl[0] << 32) ^ (xl[1] >> 32) ^ aurora512concl[(_idx) * 4 + 0] ^ (ml[2] << 1) ^ (ml[2] >> 63); \
+  xl[3] = fcpl[1] ^ (xl[1] << 32) ^ (xl[0] >> 32) ^ aurora512concl[(_idx) * 4 + 1] ^ ml[3] ^ mask; \
+  xl[0] = fcpl[0] ^ ml[0]; \
+  xl[1] = fcpl[1] ^ ml[1]; \
+  /* CP_R (R2) */ \
+  AURORA_F64_CP(fcpr[0], xr[2], xr[3], xr[3], xr[2], xr[2], xr[2], xr[3], xr[3], F2_1, F2_2, F2_3, F2_0, F3_3, F3_0, F3_1, F3_2); \
+  AURORA_F64_CP(fcpr[1], xr[3], xr[2], xr[2], xr[3], xr[3], xr[3], xr[2], xr[2], F2_1, F2_2, F2_3, F2_0, F3_3, F3_0, F3_1, F3_2); \
+  /* XORing after F and XORing with CONC_R */ \
+  xr[2] = fcpr[0] ^ (xr[0] << 32) ^ (xr[1] >> 32) ^ aurora512concr[(_idx) * 4 + 0] ^ (ml[2] << 1) ^ (ml[2] >> 63); \
+  xr[3] = fcpr[1] ^ (xr[1] << 32) ^ (xr[0] >> 32) ^ aurora512concr[(_idx) * 4 + 1] ^ ml[3] ^ mask; \
+  xr[0] = fcpr[0] ^ ml[0]; \
+  xr[1] = fcpr[1] ^ ml[1]; \
+}
+  
+/*
+ * Aurora512CF
+ *
+ * compression function for AURORA-384/512
+ */
+static void AURORA_CF_NAME(Aurora512CF)(AURORA_CTX *hctx, const BitSequence *msg, const AURORA_UINT64 mask)
+{
+  AURORA_UINT64 ml[4], mr[4], xl[4], xr[4];
+  AURORA_UINT64 fmsl[2], fmsr[2], fcpl[2], fcpr[2];
+#ifdef _LOOPED
+  int i;
+#endif
+
+  xl[0] = (hctx->h[0] & u64(ffffffff00000000)) | (hctx->h[1] >> 32);
+  xl[2] = (hctx->h[0] << 32) | (hctx->h[1] & u64(00000000ffffffff));
+  xl[1] = (hctx->h[2] & u64(ffffffff00000000)) | (hctx->h[3] >> 32);
+  xl[3] = (hctx->h[2] << 32) | (hctx->h[3] & u64(00000000ffffffff));
+
+  xr[0] = (hctx->h[4] & u64(ffffffff00000000)) | (hctx->h[5] >> 32);
+  xr[2] = (hctx->h[4] << 32) | (hctx->h[5] & u64(00000000ffffffff));
+  xr[1] = (hctx->h[6] & u64(ffffffff00000000)) | (hctx->h[7] >> 32);
+  xr[3] = (hctx->h[6] << 32) | (hctx->h[7] & u64(00000000ffffffff));
+
+  READ64BIT_OPT64(ml[0], msg + 0,  msg + 8);
+  READ64BIT_OPT64(ml[1], msg + 16, msg + 24);
+  READ64BIT_OPT64(ml[2], msg + 4,  msg + 12);
+  READ64BIT_OPT64(ml[3], msg + 20, msg + 28);
+
+  READ64BIT_OPT64(mr[0], msg + 32, msg + 40);
+  READ64BIT_OPT64(mr[1], msg + 48, msg + 56);
+  READ64BIT_OPT64(mr[2], msg + 36, msg + 44);
+  READ64BIT_OPT64(mr[3], msg + 52, msg + 60);
+
+  /* whitening */
+  ml[2] ^= aurora512conml[0];
+  ml[3] ^= aurora512conml[1];
+  mr[2] ^= aurora512conmr[0];
+  mr[3] ^= aurora512conmr[1];
+
+  xl[0] ^= ml[0];
+  xl[1] ^= ml[1];
+  xl[2] ^= (ml[2] << 1) ^ (ml[2] >> 63) ^ aurora512concl[0];
+  xl[3] ^= ml[3] ^ aurora512concl[1] ^ mask;
+
+  xr[0] ^= ml[0];
+  xr[1] ^= ml[1];
+  xr[2] ^= (ml[2] << 1) ^ (ml[2] >> 63) ^ aurora512concr[0];
+  xr[3] ^= ml[3] ^ aurora512concr[1] ^ mask;
+
+#ifndef _LOOPED /* = _LOOP_UNROLL */
+  AURORA512_2ROUNDS_OPT64(1); /* R1,  R2  */
+  AURORA512_2ROUNDS_OPT64(2); /* R3,  R4  */
+  AURORA512_2ROUNDS_OPT64(3); /* R5,  R6  */
+  AURORA512_2ROUNDS_OPT64(4); /* R7,  R8  */
+  AURORA512_2ROUNDS_OPT64(5); /* R9,  R10 */
+  AURORA512_2ROUNDS_OPT64(6); /* R11, R12 */
+  AURORA512_2ROUNDS_OPT64(7); /* R13, R14 */
+  AURORA512_2ROUNDS_OPT64(8); /* R15, R16 */
+#else /* _LOOPED */
+  for(i = 1; i <= 8; i++){
+    AURORA512_2ROUNDS_OPT64(i);
+  }
+#endif /* _LOOPED */
+
+  /* final round (R17) */
+
+  /* CP_L */
+  AURORA_F64_CP(fcpl[0], xl[2], xl[3], xl[3], xl[2], xl[2], xl[2], xl[3], xl[3], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3);
+  AURORA_F64_CP(fcpl[1], xl[3], xl[2], xl[2], xl[3], xl[3], xl[3], xl[2], xl[2], F2_0, F2_1, F2_2, F2_3, F3_0, F3_1, F3_2, F3_3);
+
+  /* XORing after F */
+  xl[2] = fcpl[0] ^ (xl[0] << 32) ^ (xl[1] >> 32) ^ (mr[2] >> 1) ^ (mr[2] << 63);
+  xl[3] = fcpl[1] ^ (xl[1] << 32) ^ (xl[0] >> 32) ^ mr[3];
+  xl[0] = fcpl[0] ^ mr[0];
+  xl[1] = fcpl[1] ^ mr[1];
+
+  /* CP_R */
+  AURORA_F64_CP(fcpr[0], xr[2], xr[3], xr[3], xr[2], xr[2], xr[2], xr[3], xr[3], F2_1, F2_2, F2_3, F2_0, F3_3, F3_0, F3_1, F3_2);
+  AURORA_F64_CP(fcpr[1], xr[3], xr[2], xr[2], xr[3], xr[3], xr[3], xr[2], xr[2], F2_1, F2_2, F2_3, F2_0, F3_3, F3_0, F3_1, F3_2);
+
+  /* XORing after F */
+  xr[2] = fcpr[0] ^ (xr[0] << 32) ^ (xr[1] >> 32) ^ (mr[2] >> 1) ^ (mr[2] << 63);
+  xr[3] = fcpr[1] ^ (xr[1] << 32) ^ (xr[0] >> 32) ^ mr[3];
+  xr[0] = fcpr[0] ^ mr[0];
+  xr[1] = fcpr[1] ^ mr[1];
+
+  /* XORing after F + XORing after CP_L and CP_R */
+  hctx->h[0] ^= (xl[0] & u64(ffffffff00000000)) ^ (xl[2] >> 32);
+  hctx->h[1] ^= (xl[0] << 32) ^ (xl[2] & u64(00000000ffffffff));
+  hctx->h[2] ^= (xl[1] & u64(ffffffff00000000)) ^ (xl[3] >> 32);
+  hctx->h[3] ^= (xl[1] << 32) ^ (xl[3] & u64(00000000ffffffff));
+
+  hctx->h[4] ^= (xr[0] & u64(ffffffff00000000)) ^ (xr[2] >> 32);
+  hctx->h[5] ^= (xr[0] << 32) ^ (xr[2] & u64(00000000ffffffff));
+  hctx->h[6] ^= (xr[1] & u64(ffffffff00000000)) ^ (xr[3] >> 32);
+  hctx->h[7] ^= (xr[1] << 32) ^ (xr[3] & u64(00000000ffffffff));
+}
+
+
+#undef F0_0
+#undef F0_1
+#undef F0_2
+#undef F0_3
+#undef F1_0
+#undef F1_1
+#undef F1_2
+#undef F1_3
+#undef F2_0
+#undef F2_1
+#undef F2_2
+#undef F2_3
+#undef F3_0
+#undef F3_1
+#undef F3_2
+#undef F3_3
+
+#undef AURORA_F64
+#undef AURORA_F64_CP
+#undef AURORA256_2ROUNDS_OPT64
+#undef AURORA512_2ROUNDS_OPT64
+
+
+/* end of file */
@@ -1,3 +1,4 @@
+#include <stddef.h>
 
 #define NB_ROUNDS32 10
 #define NB_ROUNDS64 14
@@ -143,6 +144,31 @@ HashReturn Final( hashState * state, BitSequence * hashval );
 HashReturn Hash( int hashbitlen, const BitSequence * data, DataLength databitlen, 
 		 BitSequence * hashval );
 
+/*
+  several all-in-once calls at once, with lengths in bytes: hashval[i]
+  is the hash of the length[i] bytes at data[i]
+
+  INPUT
+  hashbitlen: length in bits of the digests
+  data: the n messages
+  length: their lengths in bytes
+  n: how many messages
+
+  OUTPUT
+  SUCCESS on success
+  FAIL if arbitrary failure
+  BAD_HASHBITLEN if invalid hashbitlen
+*/
+HashReturn HashBatch( int hashbitlen, const BitSequence * const data[],
+                      const size_t length[], BitSequence * const hashval[],
+                      size_t n );
+
+/*
+  how many messages of hashbitlen bits HashBatch hashes side by side in
+  this build: 1 if it hashes them one after another
+*/
+size_t BatchLanes( int hashbitlen );
+
 /*
   the 10 permutations of {0,...15}
 */
@@ -0,0 +1,393 @@
+#include <string.h>
+#include "SHA3api_ref.h"
+
+/*
+  Several whole messages hashed side by side, one to each lane of the
+  vector registers: word i of the state of every message shares one
+  register, so that each G function works on all of them at once, using
+  the compiler's generic vector types.  A message that is done hands its
+  lane to the next one.
+
+  BLAKE32_LANES and BLAKE64_LANES are how many messages of BLAKE-28/32
+  and of BLAKE-48/64 share a register: by default as many as the
+  instruction set holds, up to the most HashBatch is given.  With only
+  scalar registers there are no lanes, and HashBatch calls Hash() for
+  each message.
+*/
+
+#define BLAKE_MAX_BATCH 8
+
+#if defined(__GNUC__) && defined(__AVX512F__)
+#define BLAKE_VECTOR_BYTES 64
+#elif defined(__GNUC__) && defined(__AVX2__)
+#define BLAKE_VECTOR_BYTES 32
+#elif defined(__GNUC__) && defined(__SSE2__)
+#define BLAKE_VECTOR_BYTES 16
+#else
+#define BLAKE_VECTOR_BYTES 8
+#endif
+
+#ifndef BLAKE32_LANES
+#if BLAKE_VECTOR_BYTES/4 > BLAKE_MAX_BATCH
+#define BLAKE32_LANES BLAKE_MAX_BATCH
+#elif BLAKE_VECTOR_BYTES > 8
+#define BLAKE32_LANES (BLAKE_VECTOR_BYTES/4)
+#else
+#define BLAKE32_LANES 1
+#endif
+#endif
+#ifndef BLAKE64_LANES
+#if BLAKE_VECTOR_BYTES > 8
+#define BLAKE64_LANES (BLAKE_VECTOR_BYTES/8)
+#else
+#define BLAKE64_LANES 1
+#endif
+#endif
+
+#if BLAKE32_LANES > BLAKE_MAX_BATCH || BLAKE64_LANES > BLAKE_MAX_BATCH
+#error "more lanes than HashBatch is given messages"
+#endif
+
+
+#if BLAKE32_LANES > 1 || BLAKE64_LANES > 1
+
+/*
+  one lane's message: its whole blocks come straight from the message,
+  then its last bytes, padded, make one or two more blocks in tail
+*/
+typedef struct {
+  const BitSequence * msg;    /* the whole blocks still to hash */
+  size_t blocks;
+  u64 t;                      /* bits hashed with them so far */
+  BitSequence tail[256];
+  int tails;                  /* how many blocks tail has */
+  int next;                   /* and the next one to hash */
+  u64 tail_t[2];              /* the counter for each, 0 for none */
+  BitSequence * hashval;
+  int busy;
+} lane_msg;
+
+
+/*
+  set up LANE for the LENGTH bytes at DATA, in blocks of BYTES bytes;
+  the last bit of the padding is set for the full-length digests
+*/
+static void lane_start( lane_msg * lane, const BitSequence * data, size_t length,
+                        BitSequence * hashval, int bytes, int one ) {
+
+  size_t left = length % bytes;
+  int lenbytes = bytes / 8;
+  int i;
+
+  lane->msg = data;
+  lane->blocks = length / bytes;
+  lane->t = 0;
+  lane->tails = (left + 1 + lenbytes <= (size_t) bytes) ? 1 : 2;
+  lane->next = 0;
+  /*
+    as in Final32() and Final64(), only the second of two padding blocks
+    is hashed with a null counter: a message that fills its last block
+    still counts all its bits in the block of padding after it
+  */
+  lane->tail_t[0] = 8 * (u64) length;
+  lane->tail_t[1] = 0;
+
+  memset( lane->tail, 0, lane->tails * bytes );
+  memcpy( lane->tail, data + length - left, left );
+  lane->tail[left] = 0x80;
+  if (one)
+    lane->tail[lane->tails * bytes - lenbytes - 1] |= 0x01;
+  for(i=0; i<8; ++i)
+    lane->tail[lane->tails * bytes - 1 - i] = (BitSequence)((8 * (u64) length) >> (8*i));
+  if (lenbytes > 8)
+    lane->tail[lane->tails * bytes - 9] = (BitSequence)(length >> 61);
+
+  lane->hashval = hashval;
+  lane->busy = 1;
+}
+
+
+/*
+  point *BLOCK at LANE's next block and set *T to its counter; return
+  nonzero if it is the last
+*/
+static int lane_block( lane_msg * lane, const BitSequence ** block, u64 * t, int bytes ) {
+
+  if (lane->blocks) {
+    *block = lane->msg;
+    lane->msg += bytes;
+    lane->blocks--;
+    lane->t += 8 * (u64) bytes;
+    *t = lane->t;
+    return 0;
+  }
+  *block = lane->tail + lane->next * bytes;
+  *t = lane->tail_t[lane->next];
+  return ++lane->next == lane->tails;
+}
+
+#endif
+
+
+
+#if BLAKE32_LANES > 1
+
+typedef u32 lane32 __attribute__ ((vector_size (4*BLAKE32_LANES)));
+
+#define ROT32L(x,n) (((x)<<(32-n))|( (x)>>(n)))
+
+#define G32L(a,b,c,d,i) \
+  do {\
+    v[a] += (m[sigma[round][i]] ^ c32[sigma[round][i+1]]) + v[b];\
+    v[d] = ROT32L(v[d] ^ v[a],16);\
+    v[c] += v[d];\
+    v[b] = ROT32L(v[b] ^ v[c],12);\
+    v[a] += (m[sigma[round][i+1]] ^ c32[sigma[round][i]]) + v[b];\
+    v[d] = ROT32L(v[d] ^ v[a], 8);\
+    v[c] += v[d];\
+    v[b] = ROT32L(v[b] ^ v[c], 7);\
+  } while (0)
+
+/* compress32() for one block of each lane, with a null salt */
+static void compress32_lanes( lane32 h[8], const BitSequence * block[], const u64 t[] ) {
+
+  lane32 v[16];
+  lane32 m[16];
+  int i, l, round;
+
+  for(i=0; i<8; ++i)
+    v[i] = h[i];
+
+  /* a null counter is a zero one */
+  for(l=0; l<BLAKE32_LANES; ++l) {
+    for(i=0; i<16; ++i)
+      m[i][l] = U8TO32_BE(block[l] + 4*i);
+    for(i=0; i<4; ++i)
+      v[8+i][l] = c32[i];
+    v[12][l] = c32[4] ^ (u32) t[l];
+    v[13][l] = c32[5] ^ (u32) t[l];
+    v[14][l] = c32[6] ^ (u32)(t[l] >> 32);
+    v[15][l] = c32[7] ^ (u32)(t[l] >> 32);
+  }
+
+  for(round=0; round<NB_ROUNDS32; ++round) {
+
+    G32L( 0, 4, 8,12, 0);
+    G32L( 1, 5, 9,13, 2);
+    G32L( 2, 6,10,14, 4);
+    G32L( 3, 7,11,15, 6);
+
+    G32L( 3, 4, 9,14,14);
+    G32L( 2, 7, 8,13,12);
+    G32L( 0, 5,10,15, 8);
+    G32L( 1, 6,11,12,10);
+
+  }
+
+  for(i=0; i<8; ++i)
+    h[i] ^= v[i] ^ v[i+8];
+}
+
+static HashReturn Hash32_Multi( int hashbitlen, const BitSequence * const data[],
+                                const size_t length[], BitSequence * const hashval[],
+                                size_t n ) {
+
+  static const BitSequence spare[64];
+  lane_msg lane[BLAKE32_LANES];
+  lane32 h[8];
+  const BitSequence * block[BLAKE32_LANES];
+  u64 t[BLAKE32_LANES];
+  int last[BLAKE32_LANES];
+  const u32 * iv = (hashbitlen == 224) ? IV28 : IV32;
+  size_t next = 0;
+  int i, l, busy;
+
+  for(l=0; l<BLAKE32_LANES; ++l)
+    lane[l].busy = 0;
+
+  for(;;) {
+    busy = 0;
+    for(l=0; l<BLAKE32_LANES; ++l) {
+      if (!lane[l].busy && next < n) {
+        lane_start( &lane[l], data[next], length[next], hashval[next], 64, hashbitlen == 256 );
+        /* Final32() takes the counter back to 0 and on to 1 << 32 */
+        if ( (u32) lane[l].tail_t[0] == 0 )
+          lane[l].tail_t[0] += (u64) 1 << 32;
+        for(i=0; i<8; ++i)
+          h[i][l] = iv[i];
+        next++;
+      }
+      if (lane[l].busy) {
+        last[l] = lane_block( &lane[l], &block[l], &t[l], 64 );
+        busy = 1;
+      }
+      else {
+        block[l] = spare;
+        t[l] = 0;
+        last[l] = 0;
+      }
+    }
+    if (!busy)
+      break;
+
+    compress32_lanes( h, block, t );
+
+    for(l=0; l<BLAKE32_LANES; ++l)
+      if (last[l]) {
+        for(i=0; i<hashbitlen/32; ++i)
+          U32TO8_BE( lane[l].hashval + 4*i, h[i][l] );
+        lane[l].busy = 0;
+      }
+  }
+
+  return SUCCESS;
+}
+
+#endif
+
+
+
+#if BLAKE64_LANES > 1
+
+typedef u64 lane64 __attribute__ ((vector_size (8*BLAKE64_LANES)));
+
+#define ROT64L(x,n) (((x)<<(64-n))|( (x)>>(n)))
+
+#define G64L(a,b,c,d,i)\
+  do { \
+    v[a] += v[b] + (m[sigma[round][i]] ^ c64[sigma[round][i+1]]);\
+    v[d] = ROT64L(v[d] ^ v[a],32);\
+    v[c] += v[d];\
+    v[b] = ROT64L(v[b] ^ v[c],25);\
+    v[a] += v[b] + (m[sigma[round][i+1]] ^ c64[sigma[round][i]]);\
+    v[d] = ROT64L(v[d] ^ v[a],16);\
+    v[c] += v[d];\
+    v[b] = ROT64L(v[b] ^ v[c],11);\
+  } while (0)
+
+/* compress64() for one block of each lane, with a null salt */
+static void compress64_lanes( lane64 h[8], const BitSequence * block[], const u64 t[] ) {
+
+  lane64 v[16];
+  lane64 m[16];
+  int i, l, round;
+
+  for(i=0; i<8; ++i)
+    v[i] = h[i];
+
+  /* the high half of the counter is zero for anything in memory */
+  for(l=0; l<BLAKE64_LANES; ++l) {
+    for(i=0; i<16; ++i)
+      m[i][l] = U8TO64_BE(block[l] + 8*i);
+    for(i=0; i<4; ++i)
+      v[8+i][l] = c64[i];
+    v[12][l] = c64[4] ^ t[l];
+    v[13][l] = c64[5] ^ t[l];
+    v[14][l] = c64[6];
+    v[15][l] = c64[7];
+  }
+
+  for(round=0; round<NB_ROUNDS64; ++round) {
+
+    G64L( 0, 4, 8,12, 0);
+    G64L( 1, 5, 9,13, 2);
+    G64L( 2, 6,10,14, 4);
+    G64L( 3, 7,11,15, 6);
+
+    G64L( 3, 4, 9,14,14);
+    G64L( 2, 7, 8,13,12);
+    G64L( 0, 5,10,15, 8);
+    G64L( 1, 6,11,12,10);
+
+  }
+
+  for(i=0; i<8; ++i)
+    h[i] ^= v[i] ^ v[i+8];
+}
+
+static HashReturn Hash64_Multi( int hashbitlen, const BitSequence * const data[],
+                                const size_t length[], BitSequence * const hashval[],
+                                size_t n ) {
+
+  static const BitSequence spare[128];
+  lane_msg lane[BLAKE64_LANES];
+  lane64 h[8];
+  const BitSequence * block[BLAKE64_LANES];
+  u64 t[BLAKE64_LANES];
+  int last[BLAKE64_LANES];
+  const u64 * iv = (hashbitlen == 384) ? IV48 : IV64;
+  size_t next = 0;
+  int i, l, busy;
+
+  for(l=0; l<BLAKE64_LANES; ++l)
+    lane[l].busy = 0;
+
+  for(;;) {
+    busy = 0;
+    for(l=0; l<BLAKE64_LANES; ++l) {
+      if (!lane[l].busy && next < n) {
+        lane_start( &lane[l], data[next], length[next], hashval[next], 128, hashbitlen == 512 );
+        for(i=0; i<8; ++i)
+          h[i][l] = iv[i];
+        next++;
+      }
+      if (lane[l].busy) {
+        last[l] = lane_block( &lane[l], &block[l], &t[l], 128 );
+        busy = 1;
+      }
+      else {
+        block[l] = spare;
+        t[l] = 0;
+        last[l] = 0;
+      }
+    }
+    if (!busy)
+      break;
+
+    compress64_lanes( h, block, t );
+
+    for(l=0; l<BLAKE64_LANES; ++l)
+      if (last[l]) {
+        for(i=0; i<hashbitlen/64; ++i)
+          U64TO8_BE( lane[l].hashval + 8*i, h[i][l] );
+        lane[l].busy = 0;
+      }
+  }
+
+  return SUCCESS;
+}
+
+#endif
+
+
+
+size_t BatchLanes( int hashbitlen ) {
+
+  if ( (hashbitlen == 224) || (hashbitlen == 256) )
+    return BLAKE32_LANES;
+  else if ( (hashbitlen == 384) || (hashbitlen == 512) )
+    return BLAKE64_LANES;
+  return 1;
+}
+
+
+HashReturn HashBatch( int hashbitlen, const BitSequence * const data[],
+                      const size_t length[], BitSequence * const hashval[],
+                      size_t n ) {
+
+  HashReturn ret = SUCCESS;
+  size_t i;
+
+#if BLAKE32_LANES > 1
+  if ( (hashbitlen == 224) || (hashbitlen == 256) )
+    return Hash32_Multi( hashbitlen, data, length, hashval, n );
+#endif
+#if BLAKE64_LANES > 1
+  if ( (hashbitlen == 384) || (hashbitlen == 512) )
+    return Hash64_Multi( hashbitlen, data, length, hashval, n );
+#endif
+
+  for(i=0; i<n && ret == SUCCESS; ++i)
+    ret = Hash( hashbitlen, data[i], 8 * (DataLength) length[i], hashval[i] );
+  return ret;
+}
@@ -51,6 +51,23 @@ static void rrounds(myuint32 x[2][2][2][2][2])
   }
 }
 
+/* "for each b-byte block of the padded message:" */
+/* "xor the block into the first b bytes of the state" */
+/* "and then transform the state invertibly through r identical rounds" */
+/* for BLOCKS whole blocks at DATA */
+static void transform(myuint32 x[2][2][2][2][2],const BitSequence *data,
+                      DataLength blocks)
+{
+  myuint32 *w = &x[0][0][0][0][0];
+  int j;
+
+  for (;blocks > 0;--blocks) {
+    for (j = 0;j < CUBEHASH_BLOCKBYTES;++j)
+      w[j / 4] ^= ((myuint32) *data++) << (8 * (j % 4));
+    rrounds(x);
+  }
+}
+
 static void state_fromx(unsigned char state[128],myuint32 x[2][2][2][2][2])
 {
   int i;
@@ -157,9 +174,22 @@ static void updatebit(hashState *state,BitSequence nextbit)
 HashReturn Update(hashState *state, const BitSequence *data,
                   DataLength databitlen)
 {
+  myuint32 x[2][2][2][2][2];
+  DataLength blocks;
   DataLength i;
   BitSequence nextbit;
 
+  /* whole blocks from a block boundary on skip updatebit, and the state */
+  /* is converted to words and back once for all of them */
+  blocks = databitlen / (8 * CUBEHASH_BLOCKBYTES);
+  if (state->blockbits == 0 && blocks > 0) {
+    state_tox(state->state,x);
+    transform(x,data,blocks);
+    state_fromx(state->state,x);
+    data += blocks * CUBEHASH_BLOCKBYTES;
+    databitlen -= blocks * 8 * CUBEHASH_BLOCKBYTES;
+  }
+
   for (i = 0;i < databitlen;++i) {
     nextbit = (data[i / 8] & mybit[i % 8]) / mybit[i % 8];
     updatebit(state,nextbit);
@@ -9,6 +9,143 @@ typedef unsigned int myuint32; /* must be exactly 32 bits */
 #define ROTATEUPWARDS11(a) (((a) << 11) | ((a) >> 21))
 #define SWAP(a,b) { myuint32 u = a; a = b; b = u; }
 
+#if defined(__SSE2__) && !defined(CUBEHASH_NO_SIMD)
+
+/* The same rounds on vectors of state words, from the compiler flags:
+   with AVX2 x_0j and x_1j are one register each, with SSE2 x_0jk and
+   x_1jk. Each swap is then either a renaming of registers or a fixed
+   shuffle of the words in them, and the state stays in registers from
+   the first round to the last. */
+
+#ifdef __AVX2__
+#include <immintrin.h>
+typedef __m256i vuint32;
+#define VLOAD(p) _mm256_loadu_si256((const __m256i *) (p))
+#define VSTORE(p,v) _mm256_storeu_si256((__m256i *) (p),(v))
+#define VADD(a,b) _mm256_add_epi32((a),(b))
+#define VXOR(a,b) _mm256_xor_si256((a),(b))
+#define VSHUF(a,s) _mm256_shuffle_epi32((a),(s))
+#ifdef __AVX512VL__
+#define VROTATEUPWARDS(a,n) _mm256_rol_epi32((a),(n))
+#else
+#define VROTATEUPWARDS(a,n) \
+  _mm256_or_si256(_mm256_slli_epi32((a),(n)),_mm256_srli_epi32((a),32 - (n)))
+#endif
+#else
+#include <emmintrin.h>
+typedef __m128i vuint32;
+#define VLOAD(p) _mm_loadu_si128((const __m128i *) (p))
+#define VSTORE(p,v) _mm_storeu_si128((__m128i *) (p),(v))
+#define VADD(a,b) _mm_add_epi32((a),(b))
+#define VXOR(a,b) _mm_xor_si128((a),(b))
+#define VSHUF(a,s) _mm_shuffle_epi32((a),(s))
+#ifdef __AVX512VL__
+#define VROTATEUPWARDS(a,n) _mm_rol_epi32((a),(n))
+#else
+#define VROTATEUPWARDS(a,n) \
+  _mm_or_si128(_mm_slli_epi32((a),(n)),_mm_srli_epi32((a),32 - (n)))
+#endif
+#endif
+
+/* "add x_0jklm into x_1jklm", "rotate x_0jklm upwards by n bits", and
+   "xor x_1jklm into x_0jklm" followed by a swap of x_1 words, done as the
+   word shuffle s, for the words of x_0 in a and of x_1 in b */
+#define VADDROTATE(a,b,n) { b = VADD(b,a); a = VROTATEUPWARDS(a,n); }
+#define VXORSHUF(a,b,s) { a = VXOR(a,b); b = VSHUF(b,s); }
+
+#ifdef __AVX2__
+/* x_0j in a<j>, x_1j in b<j> */
+#define VSTATE vuint32 a0, a1, b0, b1, u
+#define VLOADSTATE(w) { \
+  a0 = VLOAD((w) + 0); a1 = VLOAD((w) + 8); \
+  b0 = VLOAD((w) + 16); b1 = VLOAD((w) + 24); }
+#define VSTORESTATE(w) { \
+  VSTORE((w) + 0,a0); VSTORE((w) + 8,a1); \
+  VSTORE((w) + 16,b0); VSTORE((w) + 24,b1); }
+#define VXORWORD0(v) { a0 = VXOR(a0,_mm256_setr_epi32((v),0,0,0,0,0,0,0)); }
+#define VROUND { \
+  VADDROTATE(a0,b0,7) VADDROTATE(a1,b1,7) \
+  /* "swap x_00klm with x_01klm" */ \
+  u = a0; a0 = a1; a1 = u; \
+  /* "swap x_1jk0m with x_1jk1m" */ \
+  VXORSHUF(a0,b0,_MM_SHUFFLE(1,0,3,2)) VXORSHUF(a1,b1,_MM_SHUFFLE(1,0,3,2)) \
+  VADDROTATE(a0,b0,11) VADDROTATE(a1,b1,11) \
+  /* "swap x_0j0lm with x_0j1lm" */ \
+  a0 = _mm256_permute4x64_epi64(a0,_MM_SHUFFLE(1,0,3,2)); \
+  a1 = _mm256_permute4x64_epi64(a1,_MM_SHUFFLE(1,0,3,2)); \
+  /* "swap x_1jkl0 with x_1jkl1" */ \
+  VXORSHUF(a0,b0,_MM_SHUFFLE(2,3,0,1)) VXORSHUF(a1,b1,_MM_SHUFFLE(2,3,0,1)) }
+#else
+/* x_0jk in a<jk>, x_1jk in b<jk> */
+#define VSTATE vuint32 a00, a01, a10, a11, b00, b01, b10, b11, u
+#define VLOADSTATE(w) { \
+  a00 = VLOAD((w) + 0); a01 = VLOAD((w) + 4); \
+  a10 = VLOAD((w) + 8); a11 = VLOAD((w) + 12); \
+  b00 = VLOAD((w) + 16); b01 = VLOAD((w) + 20); \
+  b10 = VLOAD((w) + 24); b11 = VLOAD((w) + 28); }
+#define VSTORESTATE(w) { \
+  VSTORE((w) + 0,a00); VSTORE((w) + 4,a01); \
+  VSTORE((w) + 8,a10); VSTORE((w) + 12,a11); \
+  VSTORE((w) + 16,b00); VSTORE((w) + 20,b01); \
+  VSTORE((w) + 24,b10); VSTORE((w) + 28,b11); }
+#define VXORWORD0(v) { a00 = VXOR(a00,_mm_cvtsi32_si128(v)); }
+#define VROUND { \
+  VADDROTATE(a00,b00,7) VADDROTATE(a01,b01,7) \
+  VADDROTATE(a10,b10,7) VADDROTATE(a11,b11,7) \
+  /* "swap x_00klm with x_01klm" */ \
+  u = a00; a00 = a10; a10 = u; \
+  u = a01; a01 = a11; a11 = u; \
+  /* "swap x_1jk0m with x_1jk1m" */ \
+  VXORSHUF(a00,b00,_MM_SHUFFLE(1,0,3,2)) VXORSHUF(a01,b01,_MM_SHUFFLE(1,0,3,2)) \
+  VXORSHUF(a10,b10,_MM_SHUFFLE(1,0,3,2)) VXORSHUF(a11,b11,_MM_SHUFFLE(1,0,3,2)) \
+  VADDROTATE(a00,b00,11) VADDROTATE(a01,b01,11) \
+  VADDROTATE(a10,b10,11) VADDROTATE(a11,b11,11) \
+  /* "swap x_0j0lm with x_0j1lm" */ \
+  u = a00; a00 = a01; a01 = u; \
+  u = a10; a10 = a11; a11 = u; \
+  /* "swap x_1jkl0 with x_1jkl1" */ \
+  VXORSHUF(a00,b00,_MM_SHUFFLE(2,3,0,1)) VXORSHUF(a01,b01,_MM_SHUFFLE(2,3,0,1)) \
+  VXORSHUF(a10,b10,_MM_SHUFFLE(2,3,0,1)) VXORSHUF(a11,b11,_MM_SHUFFLE(2,3,0,1)) }
+#endif
+
+static void rrounds(myuint32 x[2][2][2][2][2])
+{
+  myuint32 *w = &x[0][0][0][0][0];
+  int r;
+  VSTATE;
+
+  VLOADSTATE(w)
+  for (r = 0;r < CUBEHASH_ROUNDS;++r) VROUND
+  VSTORESTATE(w)
+}
+
+#if CUBEHASH_BLOCKBYTES <= 4
+#define HAVE_TRANSFORM
+
+/* like the transform below, but with the state kept in registers from
+   the first block to the last */
+static void transform(myuint32 x[2][2][2][2][2],const BitSequence *data,
+                      DataLength blocks)
+{
+  myuint32 *w = &x[0][0][0][0][0];
+  myuint32 v;
+  int r;
+  int j;
+  VSTATE;
+
+  VLOADSTATE(w)
+  for (;blocks > 0;--blocks) {
+    v = 0;
+    for (j = 0;j < CUBEHASH_BLOCKBYTES;++j) v |= ((myuint32) *data++) << (8 * j);
+    VXORWORD0(v)
+    for (r = 0;r < CUBEHASH_ROUNDS;++r) VROUND
+  }
+  VSTORESTATE(w)
+}
+#endif
+
+#else
+
 static void rrounds(myuint32 x[2][2][2][2][2])
 {
   int r;
@@ -51,6 +188,27 @@ static void rrounds(myuint32 x[2][2][2][2][2])
   }
 }
 
+#endif
+
+#ifndef HAVE_TRANSFORM
+/* "for each b-byte block of the padded message:" */
+/* "xor the block into the first b bytes of the state" */
+/* "and then transform the state invertibly through r identical rounds" */
+/* for BLOCKS whole blocks at DATA */
+static void transform(myuint32 x[2][2][2][2][2],const BitSequence *data,
+                      DataLength blocks)
+{
+  myuint32 *w = &x[0][0][0][0][0];
+  int j;
+
+  for (;blocks > 0;--blocks) {
+    for (j = 0;j < CUBEHASH_BLOCKBYTES;++j)
+      w[j / 4] ^= ((myuint32) *data++) << (8 * (j % 4));
+    rrounds(x);
+  }
+}
+#endif
+
 static void state_fromx(unsigned char state[128],myuint32 x[2][2][2][2][2])
 {
   int i;
@@ -157,9 +315,22 @@ static void updatebit(hashState *state,BitSequence nextbit)
 HashReturn Update(hashState *state, const BitSequence *data,
                   DataLength databitlen)
 {
+  myuint32 x[2][2][2][2][2];
+  DataLength blocks;
   DataLength i;
   BitSequence nextbit;
 
+  /* whole blocks from a block boundary on skip updatebit, and the state */
+  /* is converted to words and back once for all of them */
+  blocks = databitlen / (8 * CUBEHASH_BLOCKBYTES);
+  if (state->blockbits == 0 && blocks > 0) {
+    state_tox(state->state,x);
+    transform(x,data,blocks);
+    state_fromx(state->state,x);
+    data += blocks * CUBEHASH_BLOCKBYTES;
+    databitlen -= blocks * 8 * CUBEHASH_BLOCKBYTES;
+  }
+
   for (i = 0;i < databitlen;++i) {
     nextbit = (data[i / 8] & mybit[i % 8]) / mybit[i % 8];
     updatebit(state,nextbit);
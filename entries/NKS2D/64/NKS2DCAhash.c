@@ -15,784 +15,292 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "NKS2DCAhash.h"
 
-/**
- * @brief shift a bit row left 1 bit, leftmost bit shifts in again on right.
+/*
+ * The automaton is stepped bit-sliced. Each row of the bitplane is held in
+ * 64-bit words, leftmost cell in the top bit, and the words are kept by
+ * column: the first word of every row, then the second, and so on. Every
+ * cell of a word is stepped at once with bitwise logic, and LANES rows at a
+ * time in a vector of words, which the compiler puts in AVX2 registers when
+ * it targets them, and otherwise in pairs of SSE2 registers or plain words.
  */
-void rolLeft(unsigned char *dst, unsigned char *src, int size)
-{
-	unsigned char *pS, *pD, bit;
-	pS = (unsigned char *)src + size - 1;
-	pD = (unsigned char *)dst + size - 1;
-	bit = (src[0] & 0x80) >> 7;
-	for(;size > 0; size--){
-		*pD = (*pS << 1) | bit;
-		bit = (*pS & 0x80) >> 7;
-		pD--;
-		pS--;
-	}
-}
+#define LANES 4
+typedef uint64_t cells __attribute__ ((vector_size (LANES*8)));
+
+#define LOADCELLS(v,p) memcpy(&(v),(p),sizeof(cells))
+#define STORECELLS(p,v) memcpy((p),&(v),sizeof(cells))
+
+#define MSB ((uint64_t)1 << 63)
+
+/** @brief words in one row of a w cell wide bitplane */
+#define ROWWORDS(w) (((w) + 63)/64)
 
 /**
- * @brief shift a bit row right 1 bit, rightmost bit shifts in again on left.
+ * @brief words in one column of words in the scratch space.
+ *
+ * A column holds a row above and below the bitplane's, so that every row
+ * has neighbors, and LANES words more, so that every vector read stays in it.
  */
-void rolRight(unsigned char *dst, unsigned char *src, int size)
+#define COLWORDS(h) ((h) + 2 + LANES)
+
+int nextGenScratchSize(int w, int h)
 {
-	unsigned char *pS, *pD, bit;
-	pS = (unsigned char *)src;
-	pD = (unsigned char *)dst;
-	bit = (pS[size-1] & 1) << 7;
-	for(;size > 0; size--){
-		*pD = (*pS >> 1) | bit;
-		bit = (*pS & 1) << 7;
-		pD++;
-		pS++;
-	}
+	return 2*ROWWORDS(w)*COLWORDS(h)*sizeof(uint64_t);
 }
 
-/**
- * @brief shift a bit row left 1 bit, leftmost bit is 'reflection' of bit to the right.
- */
-void shiftLeftReflect(unsigned char *dst, unsigned char *src, int size)
+static uint64_t loadBE64(const unsigned char *p)
 {
-	unsigned char *pS, *pD, bit;
-	pS = (unsigned char *)src + size - 1;
-	pD = (unsigned char *)dst + size - 1;
-	bit = (*pS & 0x02) >> 1;
-	for(;size > 0; size--){
-		*pD = (*pS << 1) | bit;
-		bit = (*pS & 0x80) >> 7;
-		pD--;
-		pS--;
-	}
+	return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32)
+		| ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) | ((uint64_t)p[6] << 8) | (uint64_t)p[7];
 }
 
-/**
- * @brief shift a bit row right 1 bit, rightmost  bit is 'reflection' of bit to the left.
- */
-void shiftRightReflect(unsigned char *dst, unsigned char *src, int size)
+static void storeBE64(unsigned char *p, uint64_t x)
 {
-	unsigned char *pS, *pD, bit;
-	pS = (unsigned char *)src;
-	pD = (unsigned char *)dst;
-	bit = (*pS & 0x40) << 1;
-	for(;size > 0; size--){
-		*pD = (*pS >> 1) | bit;
-		bit = (*pS & 1) << 7;
-		pD++;
-		pS++;
+	int i;
+	for(i=0;i<8;i++){
+		p[i] = (unsigned char)(x >> (56 - 8*i));
 	}
 }
 
-#ifdef TOROID_TOPOLOGY
-#define ShiftLeft rolLeft
-#define ShiftRight rolRight
-#else
-#define ShiftLeft shiftLeftReflect
-#define ShiftRight shiftRightReflect
-#endif
-
 /**
- * @brief Generates next plane using a 'rectangular' type cellular automata rule.
+ * @brief read the bitplane into columns of words.
  *
- * Given a bitplane w by h in curBits, generates a new bitplane in nextBits, using a 
- * cellular automaton defined by rule, where rule uses the current pixel and it's
- * four neighbors in rectangular positions above, below, left, right.
- *
- * inrule defines a totalistic cellular automaton using the convention of NKS chapter 5,
- * where cells have 4 neighbors in "rectangular" positions e.g. above, below, left, right.
+ * Rows a whole number of which fit in 8 bytes, or that are a whole number of 8 bytes,
+ * are read 8 bytes at a time, and the rest byte by byte.
  */
-void nextGenRect(BitSequence *curBits, 
-				BitSequence *nextBits, BitSequence *temp,
-				int w, int h,
-				int inrule)
+static void loadPlane(uint64_t *dst, const unsigned char *src, int stride, int h, int colsz)
 {
-	unsigned char *src, *dst, *pT, *pB, *pL, *pR;
-	unsigned long *plT, *plB, *plL, *plR;
-	uint64_t *nT, *nB, *nL, *nR;
-	uint64_t *lD, *lS;
-	int ll;
-	int r;
-	int width = w;
-	int stride = w/8;
-	int plSz = stride*h;
-	int nqw = (h*stride)/8;
-	int rule = inrule;
-	src = curBits;
-	dst = nextBits;
-
-	nT = plT = pT = temp;
-	nB = plB = pB = temp + plSz;
-	nL = plL = pL = temp + 2*plSz;
-	nR = plR = pR = temp + 3*plSz;
-#ifdef TOROID_TOPOLOGY
-	memcpy(pT,src+(h-1)*stride,stride);
-#else
-	memcpy(pB,src + stride,stride);
-#endif
-	memcpy(pT,pB,stride);
-	ShiftRight(pL,src,stride);
-	ShiftLeft(pR,src,stride);
-	pT += stride;
-	pB += stride;
-	pL += stride;
-	pR += stride;
-	src += stride;
-	dst += stride;
-	for( r=1; r<h-1;r++)
-	{
-		memcpy(pT,src - stride,stride);
-		memcpy(pB,src + stride,stride);
-		ShiftRight(pL,src,stride);
-		ShiftLeft(pR,src,stride);
-		pT += stride;
-		pB += stride;
-		pL += stride;
-		pR += stride;
-		src += stride;
-		dst += stride;
-	}
-	memcpy(pT,src - stride,stride);
-#ifdef TOROID_TOPOLOGY
-	memcpy(pB,src-(h-1)*stride,stride);
-#else
-	memcpy(pB,pT,stride);
-#endif
-	ShiftRight(pL,src,stride);
-	ShiftLeft(pR,src,stride);
-
-	src = curBits;
-	dst = nextBits;
-
-	lS = (uint64_t *)src;
-	lD = (uint64_t *)dst;
-
-	for(ll = 0; ll < nqw; ll++)
-	{
-		uint64_t mask = 0x1111111111111111;
-		uint64_t bm = 0x1;
-		uint64_t nBits;
-		int i,j;
-
-		*lD = 0;
-		for(j=0;j<4;j++)
-		{
-			nBits = 0;
-			nBits += (*nT  >> j) & mask;
-			nBits += (*nB  >> j) & mask;
-			nBits += (*nL  >> j) & mask;
-			nBits += (*nR  >> j) & mask;
-			nBits <<= 1;
-			nBits += (*lS  >> j) & mask;
-
-			for(i=0;i<8;i++)
-			{
-				char *nbc = (char *) &nBits;
-				char *dc = (char *) lD;
-				int bt = (nbc[i] >> 4) & 0xf;
-				int obit = ((rule >> bt) & 1);
-				dc[i] |= (obit << (j+4));	
-
-				bt = nbc[i] & 0xf;
-				obit = ((rule >> bt) & 1);
-				dc[i] |= (obit << j);				
+	int n = stride*h;
+	int i = 0, t;
+	if(8 % stride == 0){
+		int q = 8/stride;
+		uint64_t top = ~(uint64_t)0 << (64 - 8*stride);
+		for(;i+8<=n;i+=8){
+			uint64_t x = loadBE64(src + i);
+			for(t=0;t<q;t++){
+				dst[i/stride + t] = (x << (8*stride*t)) & top;
 			}
 		}
-		++lS;
-		++lD;
-		++nT;
-		++nB;
-		++nL;
-		++nR;
+	} else if(stride % 8 == 0){
+		for(;i<n;i+=8){
+			dst[(i%stride)/8*colsz + i/stride] = loadBE64(src + i);
+		}
+	}
+	for(;i<n;i++){
+		int j = i%stride;
+		uint64_t *x = &dst[j/8*colsz + i/stride];
+		if(j%8 == 0) *x = 0;
+		*x |= (uint64_t)src[i] << (56 - 8*(j%8));
 	}
 }
 
 /**
- * @brief Generates next plane using a 'diagonal' type cellular automata rule.
- *
- * Given a bitplane w by h in curBits, generates a new bitplane in nextBits, using a 
- * cellular automaton defined by rule, where rule uses the current pixel and it's
- * four neighbors in rectangular positions above, below, left, right.
- *
- * inrule defines a totalistic cellular automaton using the convention of NKS chapter 5,
- * where cells have 4 neighbors in "diagonal" positions e.g. above-left, above-right, below-left, below-right
+ * @brief write the first n bytes of the bitplane from columns of words.
  */
-void nextGenDiag(BitSequence *curBits, 
-				BitSequence *nextBits, BitSequence *temp,
-				int w, int h,
-				int inrule)
+static void storePlane(unsigned char *dst, const uint64_t *src, int stride, int n, int colsz)
 {
-	unsigned char *src, *dst, *pT, *pB, *pL, *pR;
-	unsigned long *plT, *plB, *plL, *plR;
-	uint64_t *nT, *nB, *nL, *nR;
-	uint64_t *lD, *lS;
-	int ll;
-	int r;
-	int width = w;
-	int stride = w/8;
-	int plSz = stride*h;
-	int nqw = (h*stride)/8;
-	int rule = inrule;
-	src = curBits;
-	dst = nextBits;
-
-	nT = plT = pT = temp;
-	nB = plB = pB = temp + plSz;
-	nL = plL = pL = temp + 2*plSz;
-	nR = plR = pR = temp + 3*plSz;
-
-#ifdef TOROID_TOPOLOGY
-	rolRight(pT,src+(h-1)*stride,stride);
-	rolLeft(pR,src+(h-1)*stride,stride);
-#else
-	ShiftRight(pT,src + stride,stride);
-	ShiftLeft(pR,src + stride,stride);
-#endif
-	memcpy(pL,pT,stride);
-	memcpy(pB,pR,stride);
-
-	pT += stride;
-	pR += stride;
-	pL += stride;
-	pB += stride;
-	src += stride;
-	dst += stride;
-	for( r=1; r<h-1;r++)
-	{
-		ShiftRight(pT,src - stride,stride);
-		ShiftLeft(pR,src - stride,stride);
-		ShiftRight(pL,src + stride,stride);
-		ShiftLeft(pB,src + stride,stride);
-		pT += stride;
-		pR += stride;
-		pL += stride;
-		pB += stride;
-		src += stride;
-		dst += stride;
-	}
-	ShiftRight(pT,src - stride,stride);
-	ShiftLeft(pR,src - stride,stride);
-
-#ifdef TOROID_TOPOLOGY
-	rolRight(pL,src - (h-1)*stride,stride);
-	rolLeft(pB,src - (h-1)*stride,stride);
-#else
-	memcpy(pL,pT,stride);
-	memcpy(pB,pR,stride);
-#endif
-
-	src = curBits;
-	dst = nextBits;
-
-	lS = (uint64_t *)src;
-	lD = (uint64_t *)dst;
-
-	for(ll = 0; ll < nqw; ll++)
-	{
-		uint64_t mask = 0x1111111111111111;
-		uint64_t bm = 0x1;
-		uint64_t nBits;
-		int i,j;
-
-		*lD = 0;
-		for(j=0;j<4;j++)
-		{
-			nBits = 0;
-			nBits += (*nT  >> j) & mask;
-			nBits += (*nB  >> j) & mask;
-			nBits += (*nL  >> j) & mask;
-			nBits += (*nR  >> j) & mask;
-			nBits <<= 1;
-			nBits += (*lS  >> j) & mask;
-
-			for(i=0;i<8;i++)
-			{
-				char *nbc = (char *) &nBits;
-				char *dc = (char *) lD;
-				int bt = (nbc[i] >> 4) & 0xf;
-				int obit = ((rule >> bt) & 1);
-				dc[i] |= (obit << (j+4));	
-
-				bt = nbc[i] & 0xf;
-				obit = ((rule >> bt) & 1);
-				dc[i] |= (obit << j);				
+	int i = 0, t;
+	if(8 % stride == 0){
+		int q = 8/stride;
+		uint64_t top = ~(uint64_t)0 << (64 - 8*stride);
+		for(;i+8<=n;i+=8){
+			uint64_t x = 0;
+			for(t=0;t<q;t++){
+				x |= (src[i/stride + t] & top) >> (8*stride*t);
 			}
+			storeBE64(dst + i,x);
 		}
-		++lS;
-		++lD;
-		++nT;
-		++nB;
-		++nL;
-		++nR;
-	}
-}
-/**
- * @brief Generates next plane using a 'hexagonal' type cellular automata rule.
- *
- * Given a bitplane w by h in curBits, generates a new bitplane in nextBits, using a 
- * cellular automaton defined by rule, where rule uses the current pixel and it's
- * four neighbors in rectangular positions above, below, left, right.
- *
- * inrule defines a totalistic cellular automaton using the convention of NKS chapter 5,
- * where cells have 4 neighbors in 6 neighbor positions on a hexagonal grid.
- */
-void nextGenHex(BitSequence *curBits, 
-				BitSequence *nextBits, BitSequence *temp,
-				int w, int h,
-				int inrule)
-{
-	unsigned char *src, *dst, *pTL, *pBL, *pTR, *pBR, *pL, *pR;
-	unsigned long *plTL, *plBL, *plTR, *plBR, *plL, *plR;
-	uint64_t *nTL, *nBL, *nTR, *nBR, *nL, *nR;
-	uint64_t *lD, *lS;
-	int ll;
-	int r;
-	int width = w;
-	int stride = w/8;
-	int plSz = stride*h;
-	int nqw = (h*stride)/8;
-	int rule = inrule;
-
-	nqw = (int) ceil((h*stride)/8.0);//hack
-
-	src = curBits;
-	dst = nextBits;
-
-	nL = pL =  plL = pL = temp;
-	nR = pR =  plR = pR = temp + plSz;
-	nTL =pTL = plTL =pTL = temp + 2*plSz;
-	nTR =pTR = plTR =pTR = temp + 3*plSz;
-	nBL =pBL = plBL =pBL = temp + 4*plSz;
-	nBR =pBR = plBR =pBR = temp + 5*plSz;
-
-	for(r=0; r<h;r++){
-		int prevrow = -stride;
-		int nextrow = stride;
-		if(r == 0){
-#ifdef TOROID_TOPOLOGY
-			prevrow = h*(stride - 1);
-#else
-			prevrow = stride;
-#endif
-		}
-		if(r == h-1){
-#ifdef TOROID_TOPOLOGY
-			nextrow = -h*(stride - 1);
-#else
-			nextrow = -stride;
-#endif
-		}
-
-		memcpy(pTL,src + prevrow,stride);
-		memcpy(pBL,src + nextrow,stride);
-		if(r & 1){
-			ShiftLeft(pTR,src + prevrow,stride);
-			ShiftLeft(pBR,src + nextrow,stride);
-		}else {
-			ShiftRight(pTR,src + prevrow,stride);
-			ShiftRight(pBR,src + nextrow,stride);
+	} else if(stride % 8 == 0){
+		for(;i+8<=n;i+=8){
+			storeBE64(dst + i,src[(i%stride)/8*colsz + i/stride]);
 		}
-
-		ShiftRight(pL,src,stride);
-		ShiftLeft(pR,src,stride);
-		pTR += stride;
-		pTL += stride;
-		pBR += stride;
-		pBL += stride;
-		pL += stride;
-		pR += stride;
-		src += stride;
-		dst += stride;
 	}
-	src = curBits;
-	dst = nextBits;
-
-	lS = (uint64_t *)src;
-	lD = (uint64_t *)dst;
-
-	for(ll = 0; ll < nqw; ll++)
-	{
-		uint64_t mask = 0x1111111111111111;
-		uint64_t bm = 0x1;
-		uint64_t nBits;
-		int i,j;
-
-		*lD = 0;
-		
-		for(j=0;j<4;j++)
-		{
-			char *dc = (char *) lD;
-
-			nBits = 0;
-			nBits += (*nTL  >> j) & mask;
-			nBits += (*nBL  >> j) & mask;
-			nBits += (*nTR  >> j) & mask;
-			nBits += (*nBR  >> j) & mask;
-			nBits += (*nL  >> j) & mask;
-			nBits += (*nR  >> j) & mask;
-			nBits <<= 1;
-			nBits += (*lS  >> j) & mask;
-
-			
-			for(i=0;i<8;i++)
-			{
-				char *nbc = (char *) &nBits;
-				char *dc = (char *) lD;
-				unsigned char btH = (nbc[i] >> 4) & 0xf;
-				unsigned char btL = nbc[i] & 0xf;
-				unsigned char obitH = ((rule >> btH) & 1);
-				unsigned char obitL = ((rule >> btL) & 1);
-				dc[i] |= (obitH << (j+4)) | (obitL << j);	
-			}
-		}
-		
-		++lS;
-		++lD;
-		++nTL;
-		++nBL;
-		++nTR;
-		++nBR;
-		++nL;
-		++nR;
+	for(;i<n;i++){
+		int j = i%stride;
+		dst[i] = (unsigned char)(src[j/8*colsz + i/stride] >> (56 - 8*(j%8)));
 	}
 }
 
+#define FULLADD(s,c,a,b,d) { cells t_ = (a) ^ (b); s = t_ ^ (d); c = ((a) & (b)) | (t_ & (d)); }
+#define MUX(a,b,m) ((a) ^ (((a) ^ (b)) & (m)))
+
 /**
- * @brief Version of nextGenHex optimized for very large data.
+ * @brief Generates next bit plane using given cellular automata rule.
+ *
+ * Given a bitplane w by h in curBits, generates a new bitplane in nextBits, using a
+ * cellular automaton defined by rule, where rule uses the current pixel and its
+ * neighbors: 4 in "rectangular" positions e.g. above, below, left, right, with
+ * RECT_NEIGHBORS; 4 in "diagonal" positions, e.g. above-left, above-right,
+ * below-left, below-right, with DIAG_NEIGHBORS; all 8 of these with ALL_NEIGHBORS;
+ * or 6 on a hexagonal grid with HEX_NEIGHBORS: left, right, above and below, and
+ * above-left and below-left in even rows but above-right and below-right in odd ones.
  *
- * The cellular automata rule interpretation is optimized using a cached table.
- * This is unsuitable for short data as the table generation takes considerable cpu time.
+ * The rule defines a totalistic cellular automaton using the convention of NKS chapter 5:
+ * a cell with n neighbors set, itself set if s is 1, becomes bit 2n+s of the rule.
+ * Cells at the edges have the 'reflection' of the cells inside as their neighbors
+ * beyond the edge, or with TOROID_TOPOLOGY the cells at the opposite edge.
+ *
+ * temp must hold nextGenScratchSize(w, h) bytes. flags and tableCache, which the
+ * byte by byte rule lookup used for large data, are no longer needed.
  */
-void nextGenHexOptBig(BitSequence *curBits, 
-				BitSequence *nextBits, BitSequence *temp,
-				int w, int h,
-				int inrule, void **tableCache)
+void nextGen(BitSequence *curBits,
+		BitSequence *nextBits,
+		BitSequence *temp,
+		int w, int h, int rule, int flags, void **tableCache)
 {
-	unsigned char *src, *dst, *pTL, *pBL, *pTR, *pBR, *pL, *pR;
-	unsigned long *plTL, *plBL, *plTR, *plBR, *plL, *plR;
-	uint64_t *nTL, *nBL, *nTR, *nBR, *nL, *nR;
-	uint64_t *lD, *lS;
-	int ll,k;
-	int r;
-	int width = w;
+	int nw = ROWWORDS(w);
+	int colsz = COLWORDS(h);
 	int stride = w/8;
 	int plSz = stride*h;
-	int nqw = (int) ceil((h*stride)/8.0);
-
-	int rule = inrule;
-
-	unsigned short *ruletab;
-
-	if(*tableCache == NULL){
-		*tableCache = calloc(65536,sizeof(short));
-
-		ruletab = (short *) *tableCache;
-		for(k=0;k<65536;k++){
-			unsigned char btH = (k >> 4) & 0xf;
-			unsigned char btL = k & 0xf;
-			unsigned char obitH = ((rule >> btH) & 1);
-			unsigned char obitL = ((rule >> btL) & 1);
-			ruletab[k] = (obitH << 4) | obitL;
-			btH = (k >> 12) & 0xf;
-			btL = (k >> 8) & 0xf;
-			obitH = ((rule >> btH) & 1);
-			obitL = ((rule >> btL) & 1);
-			ruletab[k] |= ((obitH << 4) | obitL) << 8;
-		}
-	}
-	ruletab = (short *) *tableCache;
-
-	src = curBits;
-	dst = nextBits;
-
-	nL = pL =  plL = pL = temp;
-	nR = pR =  plR = pR = temp + plSz;
-	nTL =pTL = plTL =pTL = temp + 2*plSz;
-	nTR =pTR = plTR =pTR = temp + 3*plSz;
-	nBL =pBL = plBL =pBL = temp + 4*plSz;
-	nBR =pBR = plBR =pBR = temp + 5*plSz;
+	int e = 64*nw - w;
+	/* the lanes holding odd rows, as each vector starts at an even row */
+	const cells odd = { 0, ~(uint64_t)0, 0, ~(uint64_t)0 };
+	uint64_t *pS, *pD;
+	uint64_t lo[9], sel[9];
+	int n, nout, r, k, c;
 
-	for(r=0; r<h;r++){
-		int prevrow = -stride;
-		int nextrow = stride;
-		if(r == 0){
-#ifdef TOROID_TOPOLOGY
-			prevrow = h*(stride - 1);
-#else
-			prevrow = stride;
-#endif
-		}
-		if(r == h-1){
+	if((rule & ALL_NEIGHBORS) == ALL_NEIGHBORS)
+		n = 8;
+	else if(rule & (RECT_NEIGHBORS | DIAG_NEIGHBORS))
+		n = 4;
+	else if(rule & HEX_NEIGHBORS)
+		n = 6;
+	else
+		return;
+
+	/* The byte by byte version stepped the plane 8 bytes at a time, and
+	   left a last partial 8 bytes as they were, except in hexagonal
+	   rules. Digests depend on that. */
+	nout = (n == 6) ? plSz : plSz & ~7;
+
+	/* row r of column k is at pS[k*colsz + r], from row -1 to row h */
+	pS = (uint64_t *)temp + 1;
+	pD = pS + nw*colsz;
+	loadPlane(pS,curBits,stride,h,colsz);
+	for(k=0;k<nw;k++){
+		uint64_t *pX = pS + k*colsz;
 #ifdef TOROID_TOPOLOGY
-			nextrow = -h*(stride - 1);
+		pX[-1] = pX[h-1];
+		pX[h] = pX[0];
 #else
-			nextrow = -stride;
+		pX[-1] = pX[1];
+		pX[h] = pX[h-2];
 #endif
-		}
-		memcpy(pTL,src + prevrow,stride);
-		memcpy(pBL,src + nextrow,stride);
-		if(r & 1){
-			ShiftLeft(pTR,src + prevrow,stride);
-			ShiftLeft(pBR,src + nextrow,stride);
-		}else {
-			ShiftRight(pTR,src + prevrow,stride);
-			ShiftRight(pBR,src + nextrow,stride);
-		}
-
-		ShiftRight(pL,src,stride);
-		ShiftLeft(pR,src,stride);
-		pTR += stride;
-		pTL += stride;
-		pBR += stride;
-		pBL += stride;
-		pL += stride;
-		pR += stride;
-		src += stride;
-		dst += stride;
 	}
-	src = curBits;
-	dst = nextBits;
-
-	lS = (uint64_t *)src;
-	lD = (uint64_t *)dst;
 
-	for(ll = 0; ll < nqw; ll++)
-	{
-		uint64_t mask = 0x1111111111111111;
-		uint64_t bm = 0x1;
-		uint64_t nBits;
-		int i,j;
-
-		*lD = 0;
-		
-		for(j=0;j<4;j++)
-		{
-			unsigned short *nbs;
-			unsigned short *ds = (unsigned short *) lD;
-
-			nBits = 0;
-			nBits += (*nTL  >> j) & mask;
-			nBits += (*nBL  >> j) & mask;
-			nBits += (*nTR  >> j) & mask;
-			nBits += (*nBR  >> j) & mask;
-			nBits += (*nL  >> j) & mask;
-			nBits += (*nR  >> j) & mask;
-			nBits <<= 1;
-			nBits += (*lS  >> j) & mask;
-
-			nbs = (unsigned short *) &nBits;
-			for(i=0;i<4;i++)
-			{
-				*ds++ |= ruletab[*nbs++] << j;	
-			}
-		}
-		
-		++lS;
-		++lD;
-		++nTL;
-		++nBL;
-		++nTR;
-		++nBR;
-		++nL;
-		++nR;
+	for(c=0;c<=8;c++){
+		lo[c] = -(uint64_t)((rule >> (2*c)) & 1);
+		sel[c] = lo[c] ^ -(uint64_t)((rule >> (2*c+1)) & 1);
 	}
 
-	return;
-}
-
-/**
- * @brief Generates next plane using an eight neighbor type cellular automata rule.
- *
- * Given a bitplane w by h in curBits, generates a new bitplane in nextBits, using a 
- * cellular automaton defined by rule, where rule uses the current pixel and it's
- * four neighbors in rectangular positions above, below, left, right.
- *
- * inrule defines a totalistic cellular automaton using the convention of NKS chapter 5,
- * where cells have neighbors in 8 adjacent positions, e.g. 4 rectangular plus 4 diagonal positions.
- */
-void nextGenAll(BitSequence *curBits, 
-				BitSequence *nextBits, BitSequence *temp,
-				int w, int h,
-				int inrule)
-{
-	unsigned char *src, *dst, *pT, *pB, *pL, *pR, *pDT, *pDB, *pDL, *pDR;
-	unsigned long *plT, *plB, *plL, *plR, *plDT, *plDB, *plDL, *plDR;
-	uint64_t *nT, *nB, *nL, *nR,*nDT, *nDB, *nDL, *nDR;
-	uint64_t *lD, *lS;
-	int ll;
-	int r;
-	int width = w;
-	int stride = w/8;
-	int plSz = stride*h;
-	int nqw = (h*stride)/8;
-	int rule = inrule;
-
-	src = curBits;
-	dst = nextBits;
-
-	pT = temp;
-	pB = temp + plSz;
-	pL = temp + 2*plSz;
-	pR = temp + 3*plSz;
-	pDT = temp + 4*plSz;
-	pDB = temp + 5*plSz;
-	pDL = temp + 6*plSz;
-	pDR = temp + 7*plSz;
-
-	nT   = plT = pT = temp;
-	nB	 = plB = pB = temp + plSz;
-	nL	 = plL = pL = temp + 2*plSz;
-	nR	 = plR = pR = temp + 3*plSz;
-	nDT	 = plDT = pDT = temp + 4*plSz;
-	nDB	 = plDB = pDB = temp + 5*plSz;
-	nDL	 = plDL = pDL = temp + 6*plSz;
-	nDR	 = plDR = pDR = temp + 7*plSz;
-
-	for(r=0; r<h;r++){
-		if(r == 0){
+	for(k=0;k<nw;k++){
+		/* A row shifted a cell right, so that each cell holds its left
+		   neighbor, is (x >> 1) | ((xP << a) & MSB), and shifted left,
+		   (x << 1) | ((xQ >> b) & m), where xP and xQ are words of the
+		   same row in the columns pP and pQ. */
+		const uint64_t *pX = pS + k*colsz, *pP, *pQ;
+		int a, b;
+		uint64_t m;
+
+		if(k > 0){
+			pP = pX - colsz;
+			a = 63;
+		} else {
 #ifdef TOROID_TOPOLOGY
-			memcpy(pT,src+(h-1)*stride,stride);
-			rolRight(pDT,src+(h-1)*stride,stride);
-			rolLeft(pDR,src+(h-1)*stride,stride);
+			pP = pX + (nw-1)*colsz;
+			a = 63 - e;
 #else
-			memcpy(pT,src+stride,stride);
-			ShiftRight(pDT,src+stride,stride);
-			ShiftLeft(pDR,src+stride,stride);
+			pP = pX;
+			a = 1;
 #endif
-		} else {
-			memcpy(pT,src - stride,stride);
-			ShiftRight(pDT,src - stride,stride);
-			ShiftLeft(pDR,src - stride,stride);
 		}
-		if(r == h-1){
+		if(k < nw-1){
+			pQ = pX + colsz;
+			b = 63;
+			m = 1;
+		} else {
 #ifdef TOROID_TOPOLOGY
-			memcpy(pB,src - (h-1)*stride,stride);
-			rolRight(pDL,src - (h-1)*stride,stride);
-			rolLeft(pDB,src - (h-1)*stride,stride);
+			pQ = pS;
+			b = 63 - e;
 #else
-			memcpy(pB,src - stride,stride);
-			ShiftRight(pDL,src - stride,stride);
-			ShiftLeft(pDB,src - stride,stride);
+			pQ = pX;
+			b = 1;
 #endif
-		} else {
-			memcpy(pB,src + stride,stride);
-			ShiftRight(pDL,src + stride,stride);
-			ShiftLeft(pDB,src + stride,stride);
+			m = (uint64_t)1 << e;
 		}
-		ShiftRight(pL,src,stride);
-		ShiftLeft(pR,src,stride);
-
-		pT  += stride;
-		pB  += stride;
-		pL  += stride;
-		pR  += stride;
-		pDT += stride;
-		pDB += stride;
-		pDL += stride;
-		pDR += stride;
-
-		src += stride;
-		dst += stride;
-	}
-
-	src = curBits;
-	dst = nextBits;
-
-	pT = temp;
-	pB = temp + plSz;
-	pL = temp + 2*plSz;
-	pR = temp + 3*plSz;
-	pDT = temp + 4*plSz;
-	pDB = temp + 5*plSz;
-	pDL = temp + 6*plSz;
-	pDR = temp + 7*plSz;
-
-	lS = (uint64_t *)src;
-	lD = (uint64_t *)dst;
-
-	for(ll = 0; ll < nqw; ll++)
-	{
-		uint64_t mask = 0x1111111111111111;
-		uint64_t bm = 0x1;
-		uint64_t nBits;
-		int j,k;
 
-		*lD = 0;
-		for(j=0;j<4;j++)
-		{
-				unsigned char *nbc = (unsigned char *) &nBits;
-				unsigned char *nbs = (unsigned char *) lS;
-				unsigned char *bd = (unsigned char *) lD;
-				nBits = 0;
-				nBits += (*nT  >> j) & mask;
-				nBits += (*nB  >> j) & mask;
-				nBits += (*nL  >> j) & mask;
-				nBits += (*nR  >> j) & mask;
-				nBits += (*nDT  >> j) & mask;
-				nBits += (*nDB  >> j) & mask;
-				nBits += (*nDL  >> j) & mask;
-				nBits += (*nDR  >> j) & mask;
-
-				for(k=0;k<8;k++)
-				{
-					unsigned char nbb;
-					int obit;
-					nbb = (nbc[k] >> 4) & 0xf;
-					nbb <<= 1;
-					nbb += (nbs[k] >> (4 + j)) & 1;
-
-					obit = ((rule >> nbb) & 1);
-					bd[k] |= (obit << (4 + j));
-
-					nbb = nbc[k] & 0xf;
-					nbb <<= 1;
-					nbb += (nbs[k]  >> j) & 1;
+		for(r=0;r<h;r+=LANES){
+			cells x[8], s, u, d, sL, sR, uL, uR, dL, dR, v[9], out;
+			cells c0, c1, c2, c3, k0, k1, k2, k3, s1, s2, s3, t, t2;
+
+			LOADCELLS(s,pX + r);
+			LOADCELLS(u,pX + r - 1);
+			LOADCELLS(d,pX + r + 1);
+			LOADCELLS(t,pP + r);
+			sL = (s >> 1) | ((t << a) & MSB);
+			LOADCELLS(t,pP + r - 1);
+			uL = (u >> 1) | ((t << a) & MSB);
+			LOADCELLS(t,pP + r + 1);
+			dL = (d >> 1) | ((t << a) & MSB);
+			LOADCELLS(t,pQ + r);
+			sR = (s << 1) | ((t >> b) & m);
+			LOADCELLS(t,pQ + r - 1);
+			uR = (u << 1) | ((t >> b) & m);
+			LOADCELLS(t,pQ + r + 1);
+			dR = (d << 1) | ((t >> b) & m);
+
+			if(n == 8){
+				x[0] = u; x[1] = d; x[2] = sL; x[3] = sR;
+				x[4] = uL; x[5] = uR; x[6] = dL; x[7] = dR;
+			} else if(n == 6){
+				x[0] = u; x[1] = d; x[2] = MUX(uL,uR,odd); x[3] = MUX(dL,dR,odd);
+				x[4] = sL; x[5] = sR;
+			} else if(rule & RECT_NEIGHBORS){
+				x[0] = u; x[1] = d; x[2] = sL; x[3] = sR;
+			} else {
+				x[0] = uL; x[1] = uR; x[2] = dL; x[3] = dR;
+			}
 
-					obit = ((rule >> nbb) & 1);
-					bd[k] |= (obit << j);
+			/* bit-sliced count of the neighbors set */
+			FULLADD(s1,k1,x[0],x[1],x[2]);
+			if(n == 4){
+				c0 = s1 ^ x[3];
+				k0 = s1 & x[3];
+				c1 = k1 ^ k0;
+				c2 = k1 & k0;
+				c3 = (cells){ 0 };
+			} else {
+				FULLADD(s2,k2,x[3],x[4],x[5]);
+				if(n == 6){
+					c0 = s1 ^ s2;
+					k0 = s1 & s2;
+					FULLADD(c1,c2,k1,k2,k0);
+					c3 = (cells){ 0 };
+				} else {
+					FULLADD(s3,k3,s1,s2,x[6]);
+					c0 = s3 ^ x[7];
+					k0 = s3 & x[7];
+					FULLADD(t,t2,k1,k2,k3);
+					c1 = t ^ k0;
+					k0 = t & k0;
+					c2 = t2 ^ k0;
+					c3 = t2 & k0;
 				}
-		}
-		++lS;
-		++lD;
-		++nT;   
-		++nB;	 
-		++nL;
-		++nR;	 
-		++nDT;	 
-		++nDB;	 
-		++nDL;	 
-		++nDR;
-	}
-}
+			}
 
-/**
- * @brief Generates next bit plane using given cellular automata rule.
- */
-void nextGen(BitSequence *curBits, 
-		BitSequence *nextBits, 
-		BitSequence *temp, 
-		int w, int h, int rule, int flags, void **tableCache)
-{
-	if((rule & ALL_NEIGHBORS) == ALL_NEIGHBORS)
-	{ 
-		nextGenAll(curBits,nextBits,temp,w,h,rule);
-	} 
-	else if(rule & RECT_NEIGHBORS)
-	{
-		nextGenRect(curBits,nextBits,temp,w,h,rule);
-	}
-	else if(rule & DIAG_NEIGHBORS)
-	{
-		nextGenDiag(curBits,nextBits,temp,w,h,rule);
-	}
-	else if(rule & HEX_NEIGHBORS)
-	{
-		if(flags & LARGEDATA){
-			nextGenHexOptBig(curBits,nextBits,temp,w,h,rule,tableCache);
-		} else {
-			nextGenHex(curBits,nextBits,temp,w,h,rule);
+			/* rule bit 2n+s for each count n, then select by the count */
+			for(c=0;c<=8;c++){
+				v[c] = lo[c] ^ (sel[c] & s);
+			}
+			out = MUX(MUX(MUX(v[0],v[1],c0),MUX(v[2],v[3],c0),c1),
+					MUX(MUX(v[4],v[5],c0),MUX(v[6],v[7],c0),c1),c2);
+			out = MUX(out,v[8],c3);
+			STORECELLS(pD + k*colsz + r,out);
 		}
 	}
+
+	storePlane(nextBits,pD,stride,nout,colsz);
 	return;
 }
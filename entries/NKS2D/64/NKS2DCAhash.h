@@ -15,5 +15,12 @@
 #define HEX_NEIGHBORS  0x400000
 #define LARGEDATA	   0x800000
 
+int nextGenScratchSize(int w, int h);
 void nextGen(BitSequence *curBits, BitSequence *nextBits, BitSequence *temp,
 			  int w, int h, int rule, int flags, void **tableCache);
+
+// Update hashes runs of at least this many blocks with the streams on
+// threads of their own, if there is more than one of each
+#define NKS2D_THREADS_MIN_BLOCKS 1024
+
+HashReturn UpdateThreaded(HashState *pHashState, const BitSequence *data, DataLength len);
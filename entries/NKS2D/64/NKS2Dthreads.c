@@ -0,0 +1,179 @@
+//---------------NKS 2D Cellular Automata Hash-----------------------
+// NKS2Dthreads.c
+//
+// Hashes long runs of data with the streams on POSIX threads.
+//
+// Update hands each block of data to the streams in turn, but which
+// block goes to which stream depends only on the data's length and
+// the streams' overlaps, never on their cell planes, and the streams
+// only meet in Final.  So each thread can step through the same
+// blocks as Update's loop and evolve just the streams given to it;
+// the calling thread waits for them all before the next run.
+//-------------------------------------------------------------------
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "SHA3api_ref.h"
+#include "NKS2DCAhash.h"
+
+/** @brief the most threads, one per stream */
+#define NKS2D_MAX_THREADS 8
+
+/**
+ * @brief One thread's share of a run of data.
+ *
+ * The thread evolves the streams whose number leaves thread when divided by
+ * nThreads.
+ */
+typedef struct _StreamJob {
+	HashState *pHashState;
+	const BitSequence *data;
+	DataLength len;
+	int thread;
+	int nThreads;
+	BitSequence *scratch;
+	DataLength tempSz;
+	DataLength consumed;
+	int curStream;
+} StreamJob;
+
+/**
+ * @brief Returns how many threads the streams are spread over: one per stream, but no
+ * more than there are processors.
+ */
+static int numThreads(int nStreams)
+{
+	long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if(nCpus > nStreams) nCpus = nStreams;
+	if(nCpus > NKS2D_MAX_THREADS) nCpus = NKS2D_MAX_THREADS;
+	return nCpus < 1 ? 1 : (int)nCpus;
+}
+
+/**
+ * @brief Steps through the blocks Update's loop hashes, evolving the job's streams with them.
+ *
+ * A block ends where the data taken so far does; one ending before a whole block of data
+ * has been taken starts in the data left in tempData by the last Update, which is
+ * followed there by the start of this run. Leaves tempSz, the bytes of data taken
+ * and curStream as Update's loop would.
+ */
+static void *runJob(void *arg)
+{
+	StreamJob *job = (StreamJob *) arg;
+	HashState *pHashState = job->pHashState;
+	int blockSz = pHashState->cellPlaneSz;
+	DataLength tempSz = pHashState->tempSz;
+	DataLength len = job->len;
+	DataLength consumed = 0;
+	DataLength nD;
+	int cur = pHashState->curStream;
+
+	do {
+		nD = blockSz - tempSz;
+		nD = nD < len ? nD : len;
+		tempSz += nD;
+		consumed += nD;
+		if(tempSz < blockSz){
+			break;
+		}
+		len -= nD;
+
+		if(cur % job->nThreads == job->thread){
+			HashStreamState *pstate = &pHashState->hashState[cur];
+			const BitSequence *block;
+			int i,k;
+			if(consumed < blockSz){
+				block = pHashState->tempData + (pHashState->tempSz + consumed - blockSz);
+			} else {
+				block = job->data + (consumed - blockSz);
+			}
+			for(i=0;i<pstate->nGenerationsPerBlock;i++){
+				for(k=0;k<blockSz;k++){
+					pstate->cellPlane[pstate->parity][k] ^= block[k];
+				}
+				nextGen( pstate->cellPlane[pstate->parity],
+						 pstate->cellPlane[pstate->parity ^ 1],
+						 job->scratch,
+						 pHashState->width, pHashState->height,
+						 pstate->generationRule,
+						 pHashState->optflags, &(pstate->tableCache));
+				pstate->parity ^= 1;
+			}
+		}
+
+		tempSz = pHashState->hashState[cur].dataOverlap;
+		cur = (cur + 1) % pHashState->nStreams;
+	} while (len > 0);
+
+	job->tempSz = tempSz;
+	job->consumed = consumed;
+	job->curStream = cur;
+	return NULL;
+}
+
+/**
+ * @brief Does the work of Update for len bytes of data, with the streams on several threads.
+ *
+ * Returns FAIL, without touching the state, if the streams cannot be spread over more
+ * than one thread; the caller must then hash the data itself.
+ */
+HashReturn
+UpdateThreaded(HashState *pHashState, const BitSequence *data, DataLength len)
+{
+	StreamJob jobs[NKS2D_MAX_THREADS];
+	pthread_t threads[NKS2D_MAX_THREADS];
+	int started[NKS2D_MAX_THREADS];
+	int blockSz = pHashState->cellPlaneSz;
+	int nThreads = numThreads(pHashState->nStreams);
+	int t;
+	DataLength from;
+
+	if(nThreads < 2){
+		return FAIL;
+	}
+	for(t=0;t<nThreads;t++){
+		jobs[t].scratch = (BitSequence *) malloc(nextGenScratchSize(pHashState->width,pHashState->height));
+		if(jobs[t].scratch == NULL){
+			while(t-- > 0){
+				free(jobs[t].scratch);
+			}
+			return FAIL;
+		}
+	}
+
+	// tempData has room for a block after the data left in it
+	memcpy(pHashState->tempData + pHashState->tempSz,data,(size_t)(len < blockSz ? len : blockSz));
+
+	for(t=0;t<nThreads;t++){
+		jobs[t].pHashState = pHashState;
+		jobs[t].data = data;
+		jobs[t].len = len;
+		jobs[t].thread = t;
+		jobs[t].nThreads = nThreads;
+		started[t] = (t > 0 && pthread_create(&threads[t],NULL,runJob,&jobs[t]) == 0);
+	}
+	for(t=0;t<nThreads;t++){
+		if(!started[t]){
+			runJob(&jobs[t]);
+		}
+	}
+	for(t=0;t<nThreads;t++){
+		if(started[t]){
+			pthread_join(threads[t],NULL);
+		}
+		free(jobs[t].scratch);
+	}
+
+	// leave in tempData what Update's loop would
+	from = jobs[0].consumed - jobs[0].tempSz;
+	if(from >= 0){
+		memcpy(pHashState->tempData,data + from,(size_t)jobs[0].tempSz);
+	} else {
+		memmove(pHashState->tempData,pHashState->tempData + pHashState->tempSz + from,(size_t)jobs[0].tempSz);
+	}
+	pHashState->tempSz = jobs[0].tempSz;
+	pHashState->curStream = jobs[0].curStream;
+	return SUCCESS;
+}
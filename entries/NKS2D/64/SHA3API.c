@@ -28,7 +28,7 @@ InitEx(HashState *pHashState, int hashbitlen, int nStreams, int nGenerations, in
 	pHashState->nStreams = nStreams;
 	pHashState->curStream = 0;
 	cellPlaneSz = (w/8)*h;
-	pHashState->scratchPlanes =	(BitSequence *) calloc(8*cellPlaneSz, 1);
+	pHashState->scratchPlanes =	(BitSequence *) calloc(nextGenScratchSize(w,h), 1);
 	pHashState->cellPlaneSz = cellPlaneSz;
 	maxdim = h > w ? h : w;
 	blockSz = pHashState->cellPlaneSz;
@@ -144,6 +144,10 @@ Update(HashState *pHashState, const BitSequence *data, DataLength databitlen)
 	pHashState->databitlen += databitlen;
 	pData = data;
 	
+	if(len/blockSz >= NKS2D_THREADS_MIN_BLOCKS && pHashState->nStreams > 1 &&
+		UpdateThreaded(pHashState, data, len) == SUCCESS){
+		return SUCCESS;
+	}
 	
 	do {
 		int i;
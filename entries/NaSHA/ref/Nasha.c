@@ -257,17 +257,31 @@ void Nasha256_compile(hashState256 *state)
 /* and call the hash_compile function as required.          */
 
 HashReturn Nasha256_Update(hashState256 *state, const BitSequence *data, DataLength databitlen)
-{    DataLength len=databitlen;
+{    DataLength len=databitlen/8;
+     uint_32t i = ((uint_32t)(state->count[0]>>3) & Nasha256_MASK), n;
      const unsigned char *sp = data;
-     if ((state->count[0] += len)< len)
+     if ((state->count[0] += databitlen)< databitlen)
         ++(state->count[1]);
-     while (len>=Nasha256_BLOCK_SIZE*8){
-           memcpy(((unsigned char *)state->M), sp, Nasha256_BLOCK_SIZE);
-           sp+=Nasha256_BLOCK_SIZE; len-=Nasha256_BLOCK_SIZE*8;
-           bsw_64(state->M, 8);
-           Nasha256_compile(state);
+     /* a block is gathered in the buffer over as many calls as it   */
+     /* takes, and compiled as soon as it is full; the bytes not yet */
+     /* filled keep those of the block before, so the digest is the */
+     /* same however the message is split between calls              */
+     bsw_64(state->M, 8);
+     while (len){
+           n = Nasha256_BLOCK_SIZE - i;
+           if (n > len) n = (uint_32t)len;
+           memcpy((unsigned char *)state->M + i, sp, n);
+           sp+=n; len-=n; i+=n;
+           if (i == Nasha256_BLOCK_SIZE){
+               bsw_64(state->M, 8);
+               Nasha256_compile(state);
+               bsw_64(state->M, 8);
+               i = 0;
+           }
      }
-     memcpy((unsigned char *)state->M, sp, len/8+1);  
+     /* then the part byte the last call may end with, or else a     */
+     /* zero, where the byte after the data used to be copied in   */
+     ((unsigned char *)state->M)[i] = databitlen & 7 ? *sp : 0;
      /* put bytes in the buffer in an order in which references to   */
     /* 32-bit words will put bytes with lower addresses into the    */
     /* top of 32 bit words on BOTH big and little endian machines   */
@@ -328,6 +342,7 @@ const uint_64t i224H2[4] =
 HashReturn Nasha224_Init(hashState *state)
 {
 	state->uu->hs256->count[0] = state->uu->hs256->count[1] = 0;
+    memset(state->uu->hs256->M, 0, 64);
     memcpy(state->uu->hs256->H, i224H1, 32);
 	memcpy(state->uu->hs256->hash, i224H2, 32);
     state->hashbitlen = 224; return SUCCESS;
@@ -363,6 +378,7 @@ const uint_64t i256H2[4] =
 HashReturn Nasha256_Init(hashState *state)
 {
 	state->uu->hs256->count[0] = state->uu->hs256->count[1] = 0;
+    memset(state->uu->hs256->M, 0, 64);
     memcpy(state->uu->hs256->H, i256H1, 32);
 	memcpy(state->uu->hs256->hash, i256H2, 32);
     state->hashbitlen = 256; return SUCCESS;
@@ -453,17 +469,31 @@ void Nasha512_compile(hashState512 *state)
 }
 
 HashReturn Nasha512_Update(hashState512 *state, const BitSequence *data, DataLength databitlen)
-{    DataLength len=databitlen;
+{    DataLength len=databitlen/8;
+     uint_32t i = ((uint_32t)(state->count[0]>>3) & Nasha512_MASK), n;
      const unsigned char *sp = data;
-     if ((state->count[0] += len)< len)
+     if ((state->count[0] += databitlen)< databitlen)
         ++(state->count[1]);
-     while (len>(Nasha512_BLOCK_SIZE*8)){
-           memcpy((unsigned char *)state->M, sp, Nasha512_BLOCK_SIZE);
-           sp+=Nasha512_BLOCK_SIZE; len-=Nasha512_BLOCK_SIZE*8;
-           bsw_64(state->M, 16);
-           Nasha512_compile(state);
+     /* a block is gathered in the buffer over as many calls as it   */
+     /* takes, and compiled as soon as it is full; the bytes not yet */
+     /* filled keep those of the block before, so the digest is the */
+     /* same however the message is split between calls              */
+     bsw_64(state->M, 16);
+     while (len){
+           n = Nasha512_BLOCK_SIZE - i;
+           if (n > len) n = (uint_32t)len;
+           memcpy((unsigned char *)state->M + i, sp, n);
+           sp+=n; len-=n; i+=n;
+           if (i == Nasha512_BLOCK_SIZE){
+               bsw_64(state->M, 16);
+               Nasha512_compile(state);
+               bsw_64(state->M, 16);
+               i = 0;
+           }
      }
-    memcpy((unsigned char *)state->M, sp, len/8+1);
+     /* then the part byte the last call may end with, or else a     */
+     /* zero, where the byte after the data used to be copied in   */
+     ((unsigned char *)state->M)[i] = databitlen & 7 ? *sp : 0;
 
 	/* put bytes in the buffer in an order in which references to   */
     /* 32-bit words will put bytes with lower addresses into the    */
@@ -534,6 +564,7 @@ const uint_64t i384H2[8] =
 HashReturn Nasha384_Init(hashState *state)
 {
 	state->uu->hs512->count[0] = state->uu->hs512->count[1] = 0;
+    memset(state->uu->hs512->M, 0, 128);
     memcpy(state->uu->hs512->H, i384H1, 64);
 	memcpy(state->uu->hs512->hash, i384H2, 64);
     state->hashbitlen = 384; return SUCCESS;
@@ -574,6 +605,7 @@ const uint_64t i512H2[8] =
 HashReturn Nasha512_Init(hashState *state)
 {
 	state->uu->hs512->count[0] = state->uu->hs512->count[1] = 0;
+    memset(state->uu->hs512->M, 0, 128);
     memcpy(state->uu->hs512->H, i512H1, 64);
 	memcpy(state->uu->hs512->hash, i512H2, 64);
     state->hashbitlen = 512; return SUCCESS;
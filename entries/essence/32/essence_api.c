@@ -5,7 +5,7 @@
  * DESCRIPTION:  This file implements the NIST API for ESSENCE.
  *
  */
-#include "SHA3api_ref.h"
+#include "essence.h"
 #include <stdio.h>
 
 
@@ -1074,29 +1074,37 @@ HashReturn Update_256(hashState *state,
 	  essence_md_block_size_in_256bit_blocks = ESSENCE_MD_BLOCK_SIZE_IN_BYTES;
 	  essence_md_block_size_in_256bit_blocks >>= 5;
 	  MDBIV_init = (uint32_t *)(state->MDBIV_init);
-	  chain_vars = (uint32_t *)(state->chain_vars);
-	  for(i=0;i<num_complete_md_blocks;i++)
+	  /*
+	   * A run of several blocks is split between worker
+	   * threads if there is more than one processor.
+	   */
+	  if ((num_complete_md_blocks < ESSENCE_THREADS_MIN_MD_BLOCKS) ||
+	      (Update_MD_Blocks_Threaded_256(state,data,num_complete_md_blocks) != SUCCESS))
 	    {
-	      /*
-	       * Initialize the chaining variables with the MDBIV
-	       */
-	      chain_vars[0] = (uint32_t)(orig_md_block_num + i);
-	      chain_vars[1] = (uint32_t)((orig_md_block_num + i) >> 32);
-	      for(j=2;j<8;j++)
+	      chain_vars = (uint32_t *)(state->chain_vars);
+	      for(i=0;i<num_complete_md_blocks;i++)
 		{
-		  chain_vars[j] = MDBIV_init[j];
+		  /*
+		   * Initialize the chaining variables with the MDBIV
+		   */
+		  chain_vars[0] = (uint32_t)(orig_md_block_num + i);
+		  chain_vars[1] = (uint32_t)((orig_md_block_num + i) >> 32);
+		  for(j=2;j<8;j++)
+		    {
+		      chain_vars[j] = MDBIV_init[j];
+		    }
+		  /*
+		   * Now hash.
+		   */
+		  ESSENCE_COMPRESS_256(chain_vars,
+				       (byte *)(data+i*(ESSENCE_MD_BLOCK_SIZE_IN_BYTES)),
+				       essence_md_block_size_in_256bit_blocks,
+				       num_steps);
+		  /*
+		   * Now Merge
+		   */
+		  Merge_Tree_256(state,chain_vars);
 		}
-	      /*
-	       * Now hash.
-	       */
-	      ESSENCE_COMPRESS_256(chain_vars,
-				   (byte *)(data+i*(ESSENCE_MD_BLOCK_SIZE_IN_BYTES)),
-				   essence_md_block_size_in_256bit_blocks,
-				   num_steps);
-	      /*
-	       * Now Merge
-	       */
-	      Merge_Tree_256(state,chain_vars);
 	    }
 	  databitlen -= (uint64_t)(num_complete_md_blocks * 
 				   ESSENCE_MD_BLOCK_SIZE_IN_BYTES * 8);
@@ -1395,28 +1403,36 @@ HashReturn Update_512(hashState *state,
 	  essence_md_block_size_in_512bit_blocks = ESSENCE_MD_BLOCK_SIZE_IN_BYTES;
 	  essence_md_block_size_in_512bit_blocks >>= 6;
 	  MDBIV_init = (uint64_t *)(state->MDBIV_init);
-	  chain_vars = (uint64_t *)(state->chain_vars);
-	  for(i=0;i<num_complete_md_blocks;i++)
+	  /*
+	   * A run of several blocks is split between worker
+	   * threads if there is more than one processor.
+	   */
+	  if ((num_complete_md_blocks < ESSENCE_THREADS_MIN_MD_BLOCKS) ||
+	      (Update_MD_Blocks_Threaded_512(state,data,num_complete_md_blocks) != SUCCESS))
 	    {
-	      /*
-	       * Initialize the chaining variables with the MDBIV
-	       */
-	      chain_vars[0] = orig_md_block_num + i;
-	      for(j=1;j<8;j++)
+	      chain_vars = (uint64_t *)(state->chain_vars);
+	      for(i=0;i<num_complete_md_blocks;i++)
 		{
-		  chain_vars[j] = MDBIV_init[j];
+		  /*
+		   * Initialize the chaining variables with the MDBIV
+		   */
+		  chain_vars[0] = orig_md_block_num + i;
+		  for(j=1;j<8;j++)
+		    {
+		      chain_vars[j] = MDBIV_init[j];
+		    }
+		  /*
+		   * Now hash.
+		   */
+		  ESSENCE_COMPRESS_512(chain_vars,
+				       (byte *)(data+i*(ESSENCE_MD_BLOCK_SIZE_IN_BYTES)),
+				       essence_md_block_size_in_512bit_blocks,
+				       num_steps);
+		  /*
+		   * Now Merge
+		   */
+		  Merge_Tree_512(state,chain_vars);
 		}
-	      /*
-	       * Now hash.
-	       */
-	      ESSENCE_COMPRESS_512(chain_vars,
-				   (byte *)(data+i*(ESSENCE_MD_BLOCK_SIZE_IN_BYTES)),
-				   essence_md_block_size_in_512bit_blocks,
-				   num_steps);
-	      /*
-	       * Now Merge
-	       */
-	      Merge_Tree_512(state,chain_vars);
 	    }
 
 	  databitlen -= (uint64_t)(num_complete_md_blocks * 
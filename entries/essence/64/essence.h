@@ -397,4 +397,55 @@ void essence_compress_256_const_time(uint32_t *,
 				     uint64_t,
 				     uint64_t);
 
+
+/*
+ * The fewest complete MD blocks that Update hands to the worker
+ * threads in essence_threads.c.  A run of fewer blocks is hashed
+ * serially.
+ */
+#define ESSENCE_THREADS_MIN_MD_BLOCKS 2
+
+
+/*
+ * void Merge_Tree_256(hashState *state, uint32_t *chain_vars)
+ * void Merge_Tree_512(hashState *state, uint64_t *chain_vars)
+ *
+ * Merge the hash of the next MD block into the hash tree.  They are
+ * in the file "essence_api.c"
+ */
+void Merge_Tree_256(hashState *,
+		    uint32_t *);
+void Merge_Tree_512(hashState *,
+		    uint64_t *);
+
+
+/*
+ * HashReturn Update_MD_Blocks_Threaded_256(hashState *state,
+ *                                          const BitSequence *data,
+ *                                          int num_md_blocks)
+ * HashReturn Update_MD_Blocks_Threaded_512(hashState *state,
+ *                                          const BitSequence *data,
+ *                                          int num_md_blocks)
+ *
+ * Hash num_md_blocks complete MD blocks on worker threads and merge
+ * them into the hash tree.  They return FAIL, leaving the blocks to
+ * the caller, if they cannot use more than one thread.  They are in
+ * the file "essence_threads.c"
+ */
+HashReturn Update_MD_Blocks_Threaded_256(hashState *,
+					 const BitSequence *,
+					 int);
+HashReturn Update_MD_Blocks_Threaded_512(hashState *,
+					 const BitSequence *,
+					 int);
+
+
+/*
+ * long Online_CPUs()
+ *
+ * Returns the number of processors online, or a value below 1 if it
+ * cannot be found.  It is in the file "essence_cpus.c"
+ */
+long Online_CPUs(void);
+
 #endif /* _ESSENCE_H_ */
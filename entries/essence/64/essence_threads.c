@@ -0,0 +1,344 @@
+/* FILE: essence_threads.c
+ *
+ * DESCRIPTION: This file hashes runs of complete Merkle-Damgaard
+ * blocks on POSIX threads.  Every MD block starts from its own MDBIV,
+ * so the blocks of a run do not depend on one another and can be
+ * split between one thread per processor.  Their chaining variables
+ * are then merged into the hash tree on the calling thread, in block
+ * order, just as the serial code in essence_api.c does, so the hash
+ * value is unchanged.
+ *
+ */
+#include "essence.h"
+#include <pthread.h>
+
+
+/*
+ * The most threads a run of MD blocks is split between, and the most
+ * blocks hashed before their results are merged.  Longer runs are
+ * taken this many blocks at a time, so that the chaining variables
+ * fit on the stack.
+ */
+#define ESSENCE_MAX_THREADS 64
+#define ESSENCE_MAX_MD_BLOCKS_PER_RUN 256
+
+
+/*
+ * One thread's share of a run of MD blocks.
+ *
+ * chain_vars -- 8 words of chaining variables for every block of the
+ *               run, 32-bit words for ESSENCE-256 and 64-bit words for
+ *               ESSENCE-512.
+ *
+ * data -- the first block of the run.
+ *
+ * MDBIV_init -- the MDBIV from the hash state.
+ *
+ * orig_md_block_num -- the block number of the first block of the run.
+ *
+ * first, last -- the blocks of the run this thread hashes are first
+ *                through last - 1.
+ */
+typedef struct{
+  void *chain_vars;
+  const BitSequence *data;
+  const void *MDBIV_init;
+  uint64_t orig_md_block_num;
+  int first;
+  int last;
+} md_block_job;
+
+
+
+
+/* *******************************************************************
+ *
+ * int Num_Threads(int num_md_blocks)
+ *
+ * Returns how many threads a run of num_md_blocks MD blocks should
+ * be split between: one per processor, but no more than there are
+ * blocks.
+ *
+ * ******************************************************************/
+static int Num_Threads(int num_md_blocks)
+{
+  long num_cpus;
+
+  num_cpus = Online_CPUs();
+  if (num_cpus > ESSENCE_MAX_THREADS)
+    {
+      num_cpus = ESSENCE_MAX_THREADS;
+    }
+  if (num_cpus > num_md_blocks)
+    {
+      num_cpus = num_md_blocks;
+    }
+  return((num_cpus < 1) ? 1 : (int)num_cpus);
+}
+
+
+
+
+/* *******************************************************************
+ *
+ * void Run_Jobs(md_block_job *job,
+ *               int num_threads,
+ *               int num_md_blocks,
+ *               void *(*hash_md_blocks)(void *))
+ *
+ * Splits the num_md_blocks blocks of the run described by job evenly
+ * between num_threads calls of hash_md_blocks and waits for them all.
+ * The first share is hashed by the calling thread, as is any share
+ * whose thread cannot be created.
+ *
+ * ******************************************************************/
+static void Run_Jobs(md_block_job *job,
+		     int num_threads,
+		     int num_md_blocks,
+		     void *(*hash_md_blocks)(void *))
+{
+  md_block_job jobs[ESSENCE_MAX_THREADS];
+  pthread_t threads[ESSENCE_MAX_THREADS];
+  int started[ESSENCE_MAX_THREADS];
+  int t;
+
+  for(t=0;t<num_threads;t++)
+    {
+      jobs[t] = *job;
+      jobs[t].first = (num_md_blocks * t) / num_threads;
+      jobs[t].last = (num_md_blocks * (t+1)) / num_threads;
+      started[t] = (t > 0 &&
+		    pthread_create(&threads[t],NULL,
+				   hash_md_blocks,&jobs[t]) == 0);
+    }
+  for(t=0;t<num_threads;t++)
+    {
+      if (!started[t])
+	{
+	  hash_md_blocks(&jobs[t]);
+	}
+    }
+  for(t=0;t<num_threads;t++)
+    {
+      if (started[t])
+	{
+	  pthread_join(threads[t],NULL);
+	}
+    }
+}
+
+
+
+
+/* *******************************************************************
+ *
+ * void *Hash_MD_Blocks_256(void *job)
+ *
+ * Hashes one thread's share of a run of MD blocks with the 256-bit
+ * compression function.
+ *
+ * ******************************************************************/
+static void *Hash_MD_Blocks_256(void *arg)
+{
+  md_block_job *job;
+  uint32_t *chain_vars;
+  const uint32_t *MDBIV_init;
+  uint64_t num_steps;
+  uint64_t md_block_num;
+  uint64_t essence_md_block_size_in_256bit_blocks;
+  int i,j;
+
+  job = (md_block_job *)arg;
+  MDBIV_init = (const uint32_t *)(job->MDBIV_init);
+  num_steps = (uint64_t)(ESSENCE_COMPRESS_NUM_STEPS);
+  essence_md_block_size_in_256bit_blocks = ESSENCE_MD_BLOCK_SIZE_IN_BYTES;
+  essence_md_block_size_in_256bit_blocks >>= 5;
+
+  for(i=job->first;i<job->last;i++)
+    {
+      /*
+       * Initialize the chaining variables with the MDBIV
+       */
+      chain_vars = ((uint32_t *)(job->chain_vars)) + i*8;
+      md_block_num = job->orig_md_block_num + (uint64_t)i;
+      chain_vars[0] = (uint32_t)md_block_num;
+      chain_vars[1] = (uint32_t)(md_block_num >> 32);
+      for(j=2;j<8;j++)
+	{
+	  chain_vars[j] = MDBIV_init[j];
+	}
+      /*
+       * Now hash.
+       */
+      ESSENCE_COMPRESS_256(chain_vars,
+			   (byte *)(job->data+i*(ESSENCE_MD_BLOCK_SIZE_IN_BYTES)),
+			   essence_md_block_size_in_256bit_blocks,
+			   num_steps);
+    }
+  return(NULL);
+}
+
+
+
+
+/* *******************************************************************
+ *
+ * void *Hash_MD_Blocks_512(void *job)
+ *
+ * Hashes one thread's share of a run of MD blocks with the 512-bit
+ * compression function.
+ *
+ * ******************************************************************/
+static void *Hash_MD_Blocks_512(void *arg)
+{
+  md_block_job *job;
+  uint64_t *chain_vars;
+  const uint64_t *MDBIV_init;
+  uint64_t num_steps;
+  uint64_t essence_md_block_size_in_512bit_blocks;
+  int i,j;
+
+  job = (md_block_job *)arg;
+  MDBIV_init = (const uint64_t *)(job->MDBIV_init);
+  num_steps = (uint64_t)(ESSENCE_COMPRESS_NUM_STEPS);
+  essence_md_block_size_in_512bit_blocks = ESSENCE_MD_BLOCK_SIZE_IN_BYTES;
+  essence_md_block_size_in_512bit_blocks >>= 6;
+
+  for(i=job->first;i<job->last;i++)
+    {
+      /*
+       * Initialize the chaining variables with the MDBIV
+       */
+      chain_vars = ((uint64_t *)(job->chain_vars)) + i*8;
+      chain_vars[0] = job->orig_md_block_num + (uint64_t)i;
+      for(j=1;j<8;j++)
+	{
+	  chain_vars[j] = MDBIV_init[j];
+	}
+      /*
+       * Now hash.
+       */
+      ESSENCE_COMPRESS_512(chain_vars,
+			   (byte *)(job->data+i*(ESSENCE_MD_BLOCK_SIZE_IN_BYTES)),
+			   essence_md_block_size_in_512bit_blocks,
+			   num_steps);
+    }
+  return(NULL);
+}
+
+
+
+
+/* *******************************************************************
+ *
+ * HashReturn Update_MD_Blocks_Threaded_256(hashState *state,
+ *                                          const BitSequence *data,
+ *                                          int num_md_blocks)
+ *
+ * state -- a structure that holds the hashState information
+ *
+ * data -- num_md_blocks complete MD blocks, the first of which is
+ *         block number state->last_md_block_number + 1
+ *
+ * Hashes the blocks with the 256-bit compression function on several
+ * threads and merges them into the hash tree in order.  Returns FAIL,
+ * without touching the state, if there is only one processor; the
+ * caller must then hash the blocks itself.
+ *
+ * ******************************************************************/
+HashReturn Update_MD_Blocks_Threaded_256(hashState *state,
+					 const BitSequence *data,
+					 int num_md_blocks)
+{
+  md_block_job job;
+  uint32_t chain_vars[8*ESSENCE_MAX_MD_BLOCKS_PER_RUN];
+  int i, num_threads, run;
+
+  if (Num_Threads(num_md_blocks) < 2)
+    {
+      return(FAIL);
+    }
+
+  while (num_md_blocks > 0)
+    {
+      run = num_md_blocks;
+      if (run > ESSENCE_MAX_MD_BLOCKS_PER_RUN)
+	{
+	  run = ESSENCE_MAX_MD_BLOCKS_PER_RUN;
+	}
+      num_threads = Num_Threads(run);
+
+      job.chain_vars = chain_vars;
+      job.data = data;
+      job.MDBIV_init = state->MDBIV_init;
+      job.orig_md_block_num = state->last_md_block_number + 1;
+      Run_Jobs(&job,num_threads,run,Hash_MD_Blocks_256);
+
+      /*
+       * The merges must be done in serial since they
+       * are order dependent.
+       */
+      for(i=0;i<run;i++)
+	{
+	  Merge_Tree_256(state,chain_vars+i*8);
+	}
+      data += run*(ESSENCE_MD_BLOCK_SIZE_IN_BYTES);
+      num_md_blocks -= run;
+    }
+  return(SUCCESS);
+}
+
+
+
+
+/* *******************************************************************
+ *
+ * HashReturn Update_MD_Blocks_Threaded_512(hashState *state,
+ *                                          const BitSequence *data,
+ *                                          int num_md_blocks)
+ *
+ * The same as Update_MD_Blocks_Threaded_256, but with the 512-bit
+ * compression function.
+ *
+ * ******************************************************************/
+HashReturn Update_MD_Blocks_Threaded_512(hashState *state,
+					 const BitSequence *data,
+					 int num_md_blocks)
+{
+  md_block_job job;
+  uint64_t chain_vars[8*ESSENCE_MAX_MD_BLOCKS_PER_RUN];
+  int i, num_threads, run;
+
+  if (Num_Threads(num_md_blocks) < 2)
+    {
+      return(FAIL);
+    }
+
+  while (num_md_blocks > 0)
+    {
+      run = num_md_blocks;
+      if (run > ESSENCE_MAX_MD_BLOCKS_PER_RUN)
+	{
+	  run = ESSENCE_MAX_MD_BLOCKS_PER_RUN;
+	}
+      num_threads = Num_Threads(run);
+
+      job.chain_vars = chain_vars;
+      job.data = data;
+      job.MDBIV_init = state->MDBIV_init;
+      job.orig_md_block_num = state->last_md_block_number + 1;
+      Run_Jobs(&job,num_threads,run,Hash_MD_Blocks_512);
+
+      /*
+       * The merges must be done in serial since they
+       * are order dependent.
+       */
+      for(i=0;i<run;i++)
+	{
+	  Merge_Tree_512(state,chain_vars+i*8);
+	}
+      data += run*(ESSENCE_MD_BLOCK_SIZE_IN_BYTES);
+      num_md_blocks -= run;
+    }
+  return(SUCCESS);
+}
@@ -0,0 +1,28 @@
+/* FILE: essence_cpus.c
+ *
+ * DESCRIPTION: This file asks the system how many processors are
+ * online, for essence_threads.c.  It is kept apart from the files
+ * that include "SHA3api_ref.h" because <unistd.h> may bring in a
+ * <stdint.h> whose types clash with the ones declared there.
+ *
+ */
+#include <unistd.h>
+
+
+long Online_CPUs(void);
+
+
+
+
+/* *******************************************************************
+ *
+ * long Online_CPUs()
+ *
+ * Returns the number of processors online, or a value below 1 if it
+ * cannot be found.
+ *
+ * ******************************************************************/
+long Online_CPUs(void)
+{
+  return(sysconf(_SC_NPROCESSORS_ONLN));
+}
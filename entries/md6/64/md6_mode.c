@@ -632,7 +632,243 @@ int md6_process( md6_state *st,
 
   return md6_process(st,next_level,final);
 }
-/* Update -- incorporate data string into hash computation.
+/* Parallel tree processing.
+*/
+
+/*
+The nodes of the tree that lie below the SEQ level L+1 are independent
+of one another except for the data they carry: a node's compression
+depends only on its b-word block and on its position (ell, i) in the
+tree.  So when md6_update is given many full leaf blocks at once, all of
+them are compressed in parallel, then every level-2 node they fill, and
+so on up the tree, each level a batch of independent compressions split
+over several threads.  The chaining values, the state left behind, and
+the hash are exactly those of the sequential code.
+
+Compile with MD6_SEQUENTIAL defined to leave this out.
+*/
+
+#ifndef MD6_SEQUENTIAL
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Fewer full leaves than this are left to the sequential code.         */
+#define md6_par_min_leaves 64
+/* At most this many leaves (512 bytes each) are handled per batch.     */
+#define md6_par_max_leaves 4096
+/* Each thread is given at least this many compressions.               */
+#define md6_par_min_nodes  16
+#define md6_par_max_threads 64
+
+typedef struct {
+  md6_state *st;
+  int ell;             /* level of the nodes being compressed          */
+  const unsigned char *data;  /* ell==1: message bytes, b*w/8 per node */
+  const md6_word *in;  /* ell>1: children's chaining values, b words   */
+  md6_word *out;       /* c-word results                               */
+  uint64_t first;      /* index within level of node 0 of this batch  */
+  int lo, hi;          /* nodes [lo,hi) of the batch for this thread  */
+  int err;
+} md6_par_job;
+
+static void *md6_par_compress( void *arg )
+/* Compress the nodes job->lo ... job->hi-1 of a batch; all are full, none
+** is the last compression.
+*/
+{ md6_par_job *job = (md6_par_job *) arg;
+  md6_state *st = job->st;
+  md6_word B[b];
+  int j;
+
+  for (j = job->lo; j < job->hi && !job->err; j++)
+    { if (job->ell == 1)
+	{ memcpy(B, job->data + (size_t) j*(b*w/8), b*(w/8));
+	  md6_reverse_little_endian(B,b);
+	}
+      else
+	memcpy(B, job->in + (size_t) j*b, b*sizeof(md6_word));
+      job->err = md6_standard_compress( job->out + (size_t) j*c, Q, st->K,
+					job->ell, job->first + j,
+					st->r, st->L, 0, 0, st->keylen, st->d,
+					B );
+    }
+  return NULL;
+}
+
+static int md6_par_threads( void )
+/* Number of threads to use: one per online processor. */
+{ static int nthreads = 0;
+  long ncpu;
+
+  if (nthreads == 0)
+    { ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+      nthreads = ncpu < 1 ? 1 : ncpu > md6_par_max_threads ?
+	md6_par_max_threads : (int) ncpu;
+    }
+  return nthreads;
+}
+
+static int md6_par_level( md6_state *st,
+			  int ell,
+			  const unsigned char *data,
+			  const md6_word *in,
+			  md6_word *out,
+			  int count )
+/* Compress count full nodes at level ell, taking their blocks from data
+** (level 1) or in (higher levels) and putting their chaining values,
+** c words each, into out.  Their indices within the level follow
+** st->i_for_level[ell], which is advanced past them.
+*/
+{ md6_par_job jobs[md6_par_max_threads];
+  pthread_t threads[md6_par_max_threads];
+  int started[md6_par_max_threads];
+  int nthreads, t, err;
+
+  nthreads = min(md6_par_threads(), count / md6_par_min_nodes);
+  if (nthreads < 1) nthreads = 1;
+
+  for (t = 0; t < nthreads; t++)
+    { jobs[t].st = st;
+      jobs[t].ell = ell;
+      jobs[t].data = data;
+      jobs[t].in = in;
+      jobs[t].out = out;
+      jobs[t].first = st->i_for_level[ell];
+      jobs[t].lo = (int) ((int64_t) count * t / nthreads);
+      jobs[t].hi = (int) ((int64_t) count * (t+1) / nthreads);
+      jobs[t].err = MD6_SUCCESS;
+      /* job 0 runs here, as does any job whose thread can't be made */
+      started[t] = t > 0 &&
+	pthread_create(&threads[t], NULL, md6_par_compress, &jobs[t]) == 0;
+    }
+  for (t = 0; t < nthreads; t++)
+    if (!started[t])
+      md6_par_compress(&jobs[t]);
+
+  err = MD6_SUCCESS;
+  for (t = 0; t < nthreads; t++)
+    { if (started[t])
+	pthread_join(threads[t], NULL);
+      if (jobs[t].err && !err)
+	err = jobs[t].err;
+    }
+  if (err) return err;
+
+  st->i_for_level[ell] += count;
+  st->compression_calls += count;
+  return MD6_SUCCESS;
+}
+
+static int md6_par_push( md6_state *st,
+			 int ell,
+			 md6_word *C,
+			 int count,
+			 md6_word *out,
+			 int *outcount )
+/* Feed count chaining values C (c words each) to level ell, as
+** md6_process would one at a time.  A partly filled B[ell] is completed
+** and compressed first, then the rest are compressed four to a node in
+** parallel and what is left over stays in B[ell].  The results, in
+** order, go to out for the next level; their number is put in
+** *outcount.
+*/
+{ int slots, take, nodes, err;
+
+  *outcount = 0;
+  if (st->bits[ell] > 0)
+    { slots = (b*w - st->bits[ell]) / (c*w);
+      take = min(slots, count);
+      memcpy((char *)st->B[ell] + st->bits[ell]/8, C, take*c*(w/8));
+      st->bits[ell] += take*c*w;
+      C += take*c;
+      count -= take;
+      if (st->bits[ell] == b*w)
+	{ if ((err = md6_compress_block(out, st, ell, 0)))
+	    return err;
+	  out += c;
+	  (*outcount)++;
+	}
+    }
+
+  nodes = count / (b/c);
+  if (nodes > 0)
+    { if ((err = md6_par_level(st, ell, NULL, C, out, nodes)))
+	return err;
+      *outcount += nodes;
+      C += (size_t) nodes*b;
+      count -= nodes*(b/c);
+    }
+
+  if (count > 0)
+    { memcpy((char *)st->B[ell], C, count*c*(w/8));
+      st->bits[ell] = count*c*w;
+    }
+  return MD6_SUCCESS;
+}
+
+static int md6_par_update( md6_state *st,
+			   const unsigned char *data,
+			   uint64_t leaves )
+/* Process leaves full leaf blocks of data, with B[1] empty, compressing
+** every node they complete.  Returns 0 on success, or an error code; it
+** returns MD6_FAIL without touching the state if it can't allocate
+** memory, in which case the caller falls back on the sequential code.
+*/
+{ md6_word *buf[2];
+  int batch, count, next, ell, top, err;
+
+  buf[0] = malloc( (size_t) md6_par_max_leaves * c * sizeof(md6_word) );
+  buf[1] = malloc( (size_t) (md6_par_max_leaves/(b/c) + 1)
+		   * c * sizeof(md6_word) );
+  if (buf[0] == NULL || buf[1] == NULL)
+    { free(buf[0]);
+      free(buf[1]);
+      return MD6_FAIL;
+    }
+
+  err = MD6_SUCCESS;
+  while (leaves > 0 && !err)
+    { batch = (int) min(leaves, (uint64_t) md6_par_max_leaves);
+      err = md6_par_level(st, 1, data, NULL, buf[0], batch);
+      data += (size_t) batch*(b*w/8);
+      leaves -= batch;
+
+      /* push the results up the tree, one batch per level */
+      count = batch;
+      top = 2;
+      for (ell = 2; count > 0 && !err; ell++)
+	{ if (ell > st->L || ell >= md6_max_stack_height-1)
+	    { /* the SEQ level: leave it to md6_process */
+	      for (next = 0; next < count && !err; next++)
+		{ md6_word *C = buf[(ell-2) & 1] + (size_t) next*c;
+		  if (ell == st->L + 1
+		      && st->i_for_level[ell]==0
+		      && st->bits[ell]==0 )
+		    st->bits[ell] = c*w;
+		  memcpy((char *)st->B[ell] + st->bits[ell]/8, C, c*(w/8));
+		  st->bits[ell] += c*w;
+		  if (ell > st->top) st->top = ell;
+		  err = md6_process(st, ell, 0);
+		}
+	      break;
+	    }
+	  top = ell;
+	  err = md6_par_push(st, ell, buf[(ell-2) & 1], count,
+			     buf[(ell-1) & 1], &count);
+	}
+      if (top > st->top) st->top = top;
+    }
+
+  free(buf[0]);
+  free(buf[1]);
+  return err;
+}
+
+#endif /* !MD6_SEQUENTIAL */
+
+/* Update -- incorporate data string into hash computation.
 */
 
 int md6_update( md6_state *st, 
@@ -657,7 +893,22 @@ int md6_update( md6_state *st,
   
   j = 0; /* j = number of bits processed so far with this update */
   while (j<databitlen)
-    { /* handle input string in portions (portion_size in bits)
+    { 
+#ifndef MD6_SEQUENTIAL
+      /* hand runs of full leaf blocks to the parallel code, keeping at
+      ** least one bit back, as the last block is only compressed once
+      ** more input arrives */
+      if (st->bits[1] == 0 && j % 8 == 0 && st->L >= 1)
+	{ uint64_t leaves = (databitlen-j-1) / (b*w);
+	  if (leaves >= md6_par_min_leaves &&
+	      (err = md6_par_update(st, &(data[j/8]), leaves)) != MD6_FAIL)
+	    { if (err) return err;
+	      j += leaves*b*w;
+	      st->bits_processed += leaves*b*w;
+	    }
+	}
+#endif
+      /* handle input string in portions (portion_size in bits)
       ** portion_size may be zero (level 1 data block might be full, 
       ** having size b*w bits) */
       portion_size = min(databitlen-j,
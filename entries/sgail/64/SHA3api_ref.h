@@ -202,6 +202,25 @@ extern const u64 mds_8x8s_0[ MDS__8BIT_X_64BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_
 extern const u64 mds_16x8s_lhs_0[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_128BIT_TABLE_SBOX__SIZE ];
 extern const u64 mds_16x8s_rhs_0[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_128BIT_TABLE_SBOX__SIZE ];
 
+/*
+ * The mds tables above come to 80KB, more than a level 1 data cache holds. With SGAIL_MDS_TABLES set to 0,
+ * the MDS transforms use 6KB of sboxes side by side and multiply by the cauchy matrices instead, with the
+ * GFNI instructions if the compiler targets them. That is the default when it does.
+ */
+#ifndef SGAIL_MDS_TABLES
+#ifdef __GFNI__
+#define SGAIL_MDS_TABLES					0
+#else
+#define SGAIL_MDS_TABLES					1
+#endif
+#endif
+
+/* The sboxes side by side, and the columns of the cauchy matrices, for the MDS transforms without tables */
+extern const u64 sbox_set_8x8s_0[ SBOX__SIZE ];
+extern const u64 sbox_set_16x8s_0[ SBOX__SIZE ][ 2 ];
+extern const u64 cauchy_8x8s_0[ MDS__8BIT_X_64BIT_TABLE_INDEX__SIZE ];
+extern const u64 cauchy_16x8s_0[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE ][ 2 ];
+
 
 
 
@@ -26,6 +26,10 @@
 
 #include "SHA3api_ref.h"
 
+#if !SGAIL_MDS_TABLES && defined( __GFNI__ )
+#include <immintrin.h>
+#endif
+
 
 
 
@@ -408,6 +412,8 @@ void do__display_minibox( u8 minibox[ MINIBOX__SIZE ]  ) {
  * MDS Matrix Code
  */
 
+#if SGAIL_MDS_TABLES
+
 /* Fast sbox & MDS Code using lookup tables defined above */
 void do__single_mds_8x8s( u8 input_vector[ MDS__8BIT_X_64BIT_TABLE_INDEX__SIZE ], u64 output_vector[ 1 ], const u64 mds_8x8s[ MDS__8BIT_X_64BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_64BIT_TABLE_SBOX__SIZE ] ) {
 
@@ -472,6 +478,106 @@ void do__single_mds_16x8s( u8 input_vector[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE
 
 }
 
+#else
+
+/*
+ * Each table entry is an MDS column times 8 (or 16) sboxes of the input byte, one sbox per output byte,
+ * with the 64-bit result xor'ed with itself rotated. The sboxes are looked up side by side in a compact
+ * table, then multiplied by the column of the cauchy matrix a byte at a time, which is linear, as is the
+ * rotate, so this can be left until the columns are summed. The tables passed in are not used.
+ */
+
+#ifdef __GFNI__
+
+/* Sum of the 8 columns, each multiplied by the compact sboxes of its input byte, using the GFNI multiply */
+#define MDS_8X8S_SUM( index_0, index_1, index_2, index_3, index_4, index_5, index_6, index_7, sum ) { \
+	__m128i mds_sum_; \
+	mds_sum_ = _mm_gf2p8mul_epi8( _mm_set_epi64x( sbox_set_8x8s_0[ index_1 ], sbox_set_8x8s_0[ index_0 ] ), _mm_loadu_si128( (const __m128i *)&cauchy_8x8s_0[ 0 ] ) ); \
+	mds_sum_ = _mm_xor_si128( mds_sum_, _mm_gf2p8mul_epi8( _mm_set_epi64x( sbox_set_8x8s_0[ index_3 ], sbox_set_8x8s_0[ index_2 ] ), _mm_loadu_si128( (const __m128i *)&cauchy_8x8s_0[ 2 ] ) ) ); \
+	mds_sum_ = _mm_xor_si128( mds_sum_, _mm_gf2p8mul_epi8( _mm_set_epi64x( sbox_set_8x8s_0[ index_5 ], sbox_set_8x8s_0[ index_4 ] ), _mm_loadu_si128( (const __m128i *)&cauchy_8x8s_0[ 4 ] ) ) ); \
+	mds_sum_ = _mm_xor_si128( mds_sum_, _mm_gf2p8mul_epi8( _mm_set_epi64x( sbox_set_8x8s_0[ index_7 ], sbox_set_8x8s_0[ index_6 ] ), _mm_loadu_si128( (const __m128i *)&cauchy_8x8s_0[ 6 ] ) ) ); \
+	sum = (u64)_mm_cvtsi128_si64( mds_sum_ ) ^ (u64)_mm_cvtsi128_si64( _mm_unpackhi_epi64( mds_sum_, mds_sum_ ) ); \
+}
+
+#else
+
+/* Multiply each byte of x by the byte of y in the same place, in GF(2^8) with the AES polynomial 0x11b */
+static u64 do__gf_multiply_8x8( u64 x, u64 y ) {
+
+	u64 product;
+	u32 loop_counter;
+
+	product = 0;
+	for ( loop_counter = 0; loop_counter < WORD_BITS_8; loop_counter++ ) {
+
+		product ^= y & ( ( ( x >> loop_counter ) & 0x0101010101010101LLU ) * 0xff );
+		y = ( ( y & 0x7f7f7f7f7f7f7f7fLLU ) << 1 ) ^ ( ( ( y >> 7 ) & 0x0101010101010101LLU ) * 0x1b );
+
+	}
+
+	return( product );
+
+}
+
+#define MDS_8X8S_SUM( index_0, index_1, index_2, index_3, index_4, index_5, index_6, index_7, sum ) { \
+	sum = do__gf_multiply_8x8( sbox_set_8x8s_0[ index_0 ], cauchy_8x8s_0[ 0 ] ); \
+	sum ^= do__gf_multiply_8x8( sbox_set_8x8s_0[ index_1 ], cauchy_8x8s_0[ 1 ] ); \
+	sum ^= do__gf_multiply_8x8( sbox_set_8x8s_0[ index_2 ], cauchy_8x8s_0[ 2 ] ); \
+	sum ^= do__gf_multiply_8x8( sbox_set_8x8s_0[ index_3 ], cauchy_8x8s_0[ 3 ] ); \
+	sum ^= do__gf_multiply_8x8( sbox_set_8x8s_0[ index_4 ], cauchy_8x8s_0[ 4 ] ); \
+	sum ^= do__gf_multiply_8x8( sbox_set_8x8s_0[ index_5 ], cauchy_8x8s_0[ 5 ] ); \
+	sum ^= do__gf_multiply_8x8( sbox_set_8x8s_0[ index_6 ], cauchy_8x8s_0[ 6 ] ); \
+	sum ^= do__gf_multiply_8x8( sbox_set_8x8s_0[ index_7 ], cauchy_8x8s_0[ 7 ] ); \
+}
+
+#endif
+
+
+void do__single_mds_8x8s( u8 input_vector[ MDS__8BIT_X_64BIT_TABLE_INDEX__SIZE ], u64 output_vector[ 1 ], const u64 mds_8x8s[ MDS__8BIT_X_64BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_64BIT_TABLE_SBOX__SIZE ] ) {
+
+	u64 mds_result;
+
+	MDS_8X8S_SUM( input_vector[ 0 ], input_vector[ 1 ], input_vector[ 2 ], input_vector[ 3 ], input_vector[ 4 ], input_vector[ 5 ], input_vector[ 6 ], input_vector[ 7 ], mds_result );
+	output_vector[ 0 ] = mds_result ^ ROTL_W( mds_result, MDS__64BIT__ROTATE, WORD_BITS_64, WORD_MODULUS_64 );
+
+}
+
+
+void do__single_mds_16x8s( u8 input_vector[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE ], u64 output_vector[ 2 ], const u64 mds_16x8s_lhs[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_128BIT_TABLE_SBOX__SIZE ], const u64 mds_16x8s_rhs[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_128BIT_TABLE_SBOX__SIZE ] ) {
+
+	u64 mds_result_lhs;
+	u64 mds_result_rhs;
+	u32 loop_counter;
+
+#ifdef __GFNI__
+	__m128i mds_sum;
+
+	mds_sum = _mm_setzero_si128( );
+	for ( loop_counter = 0; loop_counter < MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE; loop_counter++ ) {
+
+		mds_sum = _mm_xor_si128( mds_sum, _mm_gf2p8mul_epi8( _mm_loadu_si128( (const __m128i *)sbox_set_16x8s_0[ input_vector[ loop_counter ] ] ), _mm_loadu_si128( (const __m128i *)cauchy_16x8s_0[ loop_counter ] ) ) );
+
+	}
+	mds_result_lhs = (u64)_mm_cvtsi128_si64( mds_sum );
+	mds_result_rhs = (u64)_mm_cvtsi128_si64( _mm_unpackhi_epi64( mds_sum, mds_sum ) );
+#else
+	mds_result_lhs = 0;
+	mds_result_rhs = 0;
+	for ( loop_counter = 0; loop_counter < MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE; loop_counter++ ) {
+
+		mds_result_lhs ^= do__gf_multiply_8x8( sbox_set_16x8s_0[ input_vector[ loop_counter ] ][ 0 ], cauchy_16x8s_0[ loop_counter ][ 0 ] );
+		mds_result_rhs ^= do__gf_multiply_8x8( sbox_set_16x8s_0[ input_vector[ loop_counter ] ][ 1 ], cauchy_16x8s_0[ loop_counter ][ 1 ] );
+
+	}
+#endif
+
+	output_vector[ 0 ] = mds_result_lhs ^ ROTL_W( mds_result_lhs, MDS__128BIT__ROTATE_LHS, WORD_BITS_64, WORD_MODULUS_64 );
+	output_vector[ 1 ] = mds_result_rhs ^ ROTL_W( mds_result_rhs, MDS__128BIT__ROTATE_RHS, WORD_BITS_64, WORD_MODULUS_64 );
+
+}
+
+#endif
+
 
 /* Do the sbox and mds on all rows of the state matrix, accepts a key which is xor'ed in first */
 void do__full_mds_state_update( u64 state_array[ SGAIL__NUM_64_BIT_WORDS ], u64 out_state_array[ SGAIL__NUM_64_BIT_WORDS ], u64 key_array[ SGAIL__NUM_64_BIT_WORDS ], const u64 mds_8x8s[ MDS__8BIT_X_64BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_64BIT_TABLE_SBOX__SIZE ], const u64 mds_16x8s_lhs[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_128BIT_TABLE_SBOX__SIZE ], const u64 mds_16x8s_rhs[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_128BIT_TABLE_SBOX__SIZE ] ) {
@@ -897,6 +1003,7 @@ void do__xlate_state_mds_8x8s( u8 in_state_array[ SGAIL__STATE__SIZE ], u64 out_
 		index_6 = in_state_array[ xlate_array[ local_loop_counter + 6 ] ];
 		index_7 = in_state_array[ xlate_array[ local_loop_counter + 7 ] ]; 
 
+#if SGAIL_MDS_TABLES
 		mds_result = mds_8x8s[ 0 ][ index_0 ];
 		mds_result ^= mds_8x8s[ 1 ][ index_1 ];
 		mds_result ^= mds_8x8s[ 2 ][ index_2 ];
@@ -905,6 +1012,10 @@ void do__xlate_state_mds_8x8s( u8 in_state_array[ SGAIL__STATE__SIZE ], u64 out_
 		mds_result ^= mds_8x8s[ 5 ][ index_5 ];
 		mds_result ^= mds_8x8s[ 6 ][ index_6 ];
 		mds_result ^= mds_8x8s[ 7 ][ index_7 ];
+#else
+		MDS_8X8S_SUM( index_0, index_1, index_2, index_3, index_4, index_5, index_6, index_7, mds_result );
+		mds_result ^= ROTL_W( mds_result, MDS__64BIT__ROTATE, WORD_BITS_64, WORD_MODULUS_64 );
+#endif
 
 		out_state_array[ loop_counter ] = mds_result;
 
@@ -10902,3 +10902,368 @@ const u64 mds_16x8s_rhs_0[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE ][ MDS__8BIT_X_1
 	}
 };
 
+
+
+/*
+ * Compact MDS Data, used in place of the tables above when SGAIL_MDS_TABLES is 0
+ */
+
+/* Sboxes 0 - 7 side by side: byte 7 - j of entry x is sbox j of x, as in the 8x8 MDS table */
+const u64 sbox_set_8x8s_0[ SBOX__SIZE ] = {
+	0x72b207a887875e51LLU, 0xb7c4ebeed55c37b7LLU, 0x1dfe62b8b1a94574LLU, 0x5921bea7ae8543c1LLU,
+	0xbc5ac162afdcce12LLU, 0xd6b353bd7157a42aLLU, 0x653d5dc989feac23LLU, 0x7f501e487efdf33fLLU,
+	0x3cf5f3b2d29a50b5LLU, 0x3db7b453749f0e87LLU, 0x0b9069ddff2ea90bLLU, 0x4d68cd540caeec92LLU,
+	0xd8c254ac697f72caLLU, 0x960fd327dc177955LLU, 0x78bdf0251cb878ceLLU, 0x363873ff1aabdf0cLLU,
+	0xca566d65c0733d5cLLU, 0x77de967db90cf1bbLLU, 0x8c5329fe10e6ae60LLU, 0xe1be86589e6a0224LLU,
+	0x238c126df8f803e2LLU, 0xdb2521d359448c04LLU, 0x4a0c5ec8234b7ae5LLU, 0x89174b80d00bb772LLU,
+	0x66970a92e9a8b057LLU, 0x4386cc575452ef61LLU, 0x9a293ff585f1b279LLU, 0x8446d1a607b27f52LLU,
+	0xc1a6772134078593LLU, 0xab4c9b0891bac4ffLLU, 0x6365ce26403f296cLLU, 0x6cfb5979dfbb6684LLU,
+	0xf75d235258a500edLLU, 0x0c1556046a2c633cLLU, 0xf24af490a0e28128LLU, 0xc4cf1cb97769a702LLU,
+	0x31c038117d4f65a2LLU, 0x74669aa0fdb05b98LLU, 0x64aaa37164188d25LLU, 0x3fc987bcd6783307LLU,
+	0x9e609f1a7300d0c9LLU, 0x58dcdbfdccdf715eLLU, 0x176b6be26e584d1eLLU, 0xd43ba41728ccd1acLLU,
+	0x82b0b1bb8d6ba513LLU, 0xfdc7957b0d63d3aeLLU, 0xb1229dccd8c6875fLLU, 0x1cac0bd5043d91d3LLU,
+	0x45ec459575269e38LLU, 0xbbd9550700a7c048LLU, 0xe3246a82c9c3862fLLU, 0xf6313ec24cc89a80LLU,
+	0x5543251b55532edbLLU, 0x98e90ee9f62158e0LLU, 0xa79bd86fa2bd8e97LLU, 0xf172321d9d90045dLLU,
+	0x7af485ed84f0c7dcLLU, 0xb27197050fe4eae1LLU, 0x902849b4b41af031LLU, 0xb336dd2bf50f7c8bLLU,
+	0x34f03a10ddd55310LLU, 0x7b9670c5808dc39eLLU, 0x2c5e15de52fb2678LLU, 0xc96fcae0c19bf265LLU,
+	0xb520c0d92e86614aLLU, 0x4814ab9f9f7590dfLLU, 0x92a2f19b81c23a58LLU, 0x8067b0fbd41f22d0LLU,
+	0xb485c200024105fcLLU, 0xdd7f8fd6eb3afd45LLU, 0x81c389b724e319deLLU, 0x6d34a7e8fada0c14LLU,
+	0x0ed5aaf2def5f5b4LLU, 0xeeeb52f741ebedf8LLU, 0xa54eb99179d32da3LLU, 0x5693a62aba55384dLLU,
+	0x46494d9657e75209LLU, 0x753c19063df383d5LLU, 0x85195bd163a0cbd1LLU, 0xf908cb77cfb34846LLU,
+	0xb98d2434d1618f75LLU, 0x9c944401a1314234LLU, 0x39822b3113b1748dLLU, 0xcf4d8450aa94da6eLLU,
+	0xac7cae37b516aba5LLU, 0xc0d360c03e39c86dLLU, 0x93ede13844060fc4LLU, 0x8355b3291197fb16LLU,
+	0x082336b1f10913b6LLU, 0xedc5143093406dd2LLU, 0x38f83928267da02bLLU, 0x7e30c8836732e48cLLU,
+	0xfab9f5ec32cd7b03LLU, 0x16d7a051194c57beLLU, 0xa4d180ad5f91b918LLU, 0xb8bc18c6e8cb1f4fLLU,
+	0x1f482e3c3188499bLLU, 0xc669b2c7e48f8842LLU, 0xaa44feaa4e1cd6a8LLU, 0xe879a2f8e238eb71LLU,
+	0x6bdd0540504de0f5LLU, 0xd06dbae46d2a1c4cLLU, 0x2dc8630b515b69b3LLU, 0xaecac53ae7afde06LLU,
+	0xa864d494acb495b8LLU, 0x7d035a4382430970LLU, 0xbd42d9ae6183b6e3LLU, 0x7904fd5db3306c20LLU,
+	0x8e737e036045ffc6LLU, 0x8ff206fa95ace67cLLU, 0x49d4c915ee152febLLU, 0xc2b8939eb0342c8fLLU,
+	0x5e9179ce1f68b10aLLU, 0x697d269af324d4e9LLU, 0xa1128a4a48ec9862LLU, 0x0d622fe64a95bccdLLU,
+	0xce1a50d8fc0e9756LLU, 0x53fcf275e18b2182LLU, 0x006acfa10966681bLLU, 0xfb1f83998e6c80bdLLU,
+	0x761002898c13c2f1LLU, 0x187e0d8b9adeca1cLLU, 0xf833b74518493ed8LLU, 0xe0bb813598c7e2daLLU,
+	0x1a844f7e35e13099LLU, 0x027aad46175fd5e8LLU, 0x209d33d446d7c58aLLU, 0x6247df97e5c007cbLLU,
+	0xe2c608e3ad9ed2ccLLU, 0x420e17db06986e0eLLU, 0xdf7be82ebfeee50fLLU, 0xea09fb66e065323aLLU,
+	0x3a6ce52db63336efLLU, 0x87e16114a4ef20c2LLU, 0x2b8ee73f6c0473f4LLU, 0x61c1ec88f0d15f7bLLU,
+	0xc361bfef8bf7fa17LLU, 0x06e2f623fb2fc13eLLU, 0xd35c7c33961b6b11LLU, 0x0ad81068ab2384a9LLU,
+	0x67cb1ac46f8a189dLLU, 0x44fdffd06247c619LLU, 0x01ff1d707829ee32LLU, 0x3be4e093531193c7LLU,
+	0x5ff91f1e3ac1b85aLLU, 0xafb1f7369076109fLLU, 0xdc8a2022d3d4393bLLU, 0xad80ef4fedf9e301LLU,
+	0xd1637db036d65637LLU, 0xd78735679be88bc3LLU, 0x73a0af2c49145130LLU, 0x14cc1b42a642d747LLU,
+	0x157011f4760d4c95LLU, 0xeb2ad7d77f364040LLU, 0x40d66f6aa3e93bb2LLU, 0xefb5e35f16289466LLU,
+	0x3327a85912ad60f2LLU, 0xc7989849e37af99aLLU, 0x4b2d0c417af6142eLLU, 0x4ea92d186b7e76d4LLU,
+	0x9f78bc24e6a231feLLU, 0xa251c6325b8c1da6LLU, 0xcd2ee6a35dedbeafLLU, 0x4ce86edc568e0ad6LLU,
+	0x7007fa1c1d54aafbLLU, 0x680b0363727055aaLLU, 0x0fa116a54277af41LLU, 0x1337acf3c462f4f3LLU,
+	0xf07413a2ce644690LLU, 0xa39576ebbc674ae4LLU, 0xe5593c39c6f23527LLU, 0xec2b826e2b48fceaLLU,
+	0x9183d047f2f4cc69LLU, 0x307504ab2a1d1a4eLLU, 0xc5063dda5c7bfeddLLU, 0x09db9c3ec2b675f7LLU,
+	0x3e160f8dc346b381LLU, 0xfe54a1870301154bLLU, 0x37ef407aec7908fdLLU, 0xbf0ac3f61e898a59LLU,
+	0x0332665e6580f896LLU, 0xb6bf92a414e027eeLLU, 0x99f6ed0e5eb7161aLLU, 0x29ba34df5ae52ba7LLU,
+	0x86df75bf4b276476LLU, 0xc8da319c3c20cdcfLLU, 0x124168f1cbb92a94LLU, 0xa658998f9292c968LLU,
+	0x711b94ca4f7c9d7aLLU, 0xe440a5cd33c41708LLU, 0x41eec71f9705e8ecLLU, 0x21e7daa9702b96e7LLU,
+	0x47ea658c291282f0LLU, 0x952f8e092dff5c86LLU, 0xb0f75f6c21d9f773LLU, 0x26054669b735546bLLU,
+	0x501cde440eddbf15LLU, 0x35a8300c38191239LLU, 0x94397f86b8b5dcb1LLU, 0x6a26d6becdea3c6fLLU,
+	0x57fa2ae10b9d6a91LLU, 0x8bd07485865e5d88LLU, 0x2ae04c6466d87d0dLLU, 0xd5778dea37a11149LLU,
+	0xd21d9ec34dbe442cLLU, 0x8aa7677422080b85LLU, 0x278f7256d9c50105LLU, 0x2f9e37fc45229989LLU,
+	0xfc3e47604784ddf6LLU, 0x5a894a3b7cbc246aLLU, 0x8800513d7b4e47bcLLU, 0xf5e6a95ada25a144LLU,
+	0xe62c90762c60bbbaLLU, 0x1ba564782fa4cf35LLU, 0x4ff1b6cbdb1e258eLLU, 0xcc1e4e84f96f2364LLU,
+	0xf36e8c72fe724bfaLLU, 0xa00227d2efdb4154LLU, 0x079f4219a9c91e77LLU, 0xd9ab8b7fa53b9c26LLU,
+	0x5c88d20a8acadb67LLU, 0x54f32caf159c9fc0LLU, 0xe9aefc81685d6fb0LLU, 0xbe9a018a27fca2adLLU,
+	0x10b67b5b206ee97dLLU, 0x32a43b2f2502e729LLU, 0xcb01e44b832d627eLLU, 0x52ad574c9c033fc5LLU,
+	0x978178baf70a0d3dLLU, 0x6f4f888e94ce3422LLU, 0x9b5fdc5c3b6d7eb9LLU, 0x519c4398b2bfb436LLU,
+	0x22182873085967a0LLU, 0xffcde9e50aa377d7LLU, 0x5ba3480f0593d87fLLU, 0x2ecef802c837a31dLLU,
+	0xde92bd12c5aaa843LLU, 0x8d7671f0bd4a59bfLLU, 0xba4bf913a7d0b51fLLU, 0x9d3f225588569b50LLU,
+	0x19e5d5f930515ac8LLU, 0xe713ea6b99999283LLU, 0x6e99e27cd73cbde6LLU, 0xa98b6cb38f10baf9LLU,
+	0x28b4ee163f5aada4LLU, 0x040db820be747033LLU, 0x5d3500c1bb50282dLLU, 0xf452b5e743968921LLU,
+	0xda3a5cb6a8d21b00LLU, 0x25e37a0d1b3e06a1LLU, 0x1ed2589deafa4fabLLU, 0x2445c44df4cfd99cLLU,
+	0x0557bbb5caa64ed9LLU, 0x115b91613971f653LLU, 0x7caf09cfc781a65bLLU, 0x6011414e0182e163LLU
+};
+
+/* Sboxes 8 - 23 side by side, the first 8 for the left 64-bit word and the rest for the right */
+const u64 sbox_set_16x8s_0[ SBOX__SIZE ][ 2 ] = {
+	{ 0xa87c56d5b983b0e4LLU, 0xe218fff730a8ec7dLLU },
+	{ 0xded2b9e993ed2295LLU, 0x298e1ed2832f64d3LLU },
+	{ 0x72b1cb068a891be3LLU, 0x80895c7d0a60103aLLU },
+	{ 0xa1b86e3c74742c30LLU, 0x0667cc089cdc716fLLU },
+	{ 0x2b481eed72161103LLU, 0xd3665086a3942769LLU },
+	{ 0xe96c8719a4b2901bLLU, 0xa14a4f6eb5f8f6a3LLU },
+	{ 0x8a229702edb55042LLU, 0xb182ed954fcfdc3cLLU },
+	{ 0x3e983258c036dbf3LLU, 0x7e05eee0b93abc34LLU },
+	{ 0xc46b27d43ee4ddb5LLU, 0x66ed7a143c6f8f23LLU },
+	{ 0xd2f861ab544ad30eLLU, 0x5948c480e71f1cf9LLU },
+	{ 0x3c01d2665ada1a05LLU, 0xd8a59e0d5bc88d7eLLU },
+	{ 0x5d81b885171cb41eLLU, 0x6dd263df37802f01LLU },
+	{ 0xeb0f996712a89f9aLLU, 0xd7e718299802bbc1LLU },
+	{ 0x3996f4c950029c91LLU, 0x083a354df858a76aLLU },
+	{ 0xb8b3a0159a7537abLLU, 0x81c1a418475ddbf3LLU },
+	{ 0x172e3731de981963LLU, 0x6ec38287493639c2LLU },
+	{ 0x0bba4c127c67412dLLU, 0x1370f4abd406feeaLLU },
+	{ 0xafc5e37ec1eb52ceLLU, 0xb2cea2dbe8b1de38LLU },
+	{ 0x9876239188398cfeLLU, 0x560c360acfdbcc47LLU },
+	{ 0x58f6b0e86b69100aLLU, 0xe7b42c37ece362ebLLU },
+	{ 0xc878bca85d3d16c7LLU, 0x60f8083567f48cc8LLU },
+	{ 0xc1025b22e7849187LLU, 0x919d9af2f29a9bd4LLU },
+	{ 0x8715ea8edb92e943LLU, 0x2f1e0dcbda93567fLLU },
+	{ 0x36a76b21e16d8547LLU, 0x0014f18cfe21f175LLU },
+	{ 0xfca10eeafbbd1f54LLU, 0x828de74fe209c989LLU },
+	{ 0x32b7ca88b3f6eff1LLU, 0xf8dadc0024c23156LLU },
+	{ 0x316562b2d0ecee3aLLU, 0x6b752f09ebca6342LLU },
+	{ 0xf2f19f9e7fbf484aLLU, 0x8c5d86d80b01e671LLU },
+	{ 0x6b8e835e2548df8eLLU, 0xf38c674e1e5bddbcLLU },
+	{ 0x455e7fdfb773e359LLU, 0xec28d5783eaab396LLU },
+	{ 0xd3c36039d7583fadLLU, 0xdfb128d4b06e2a3eLLU },
+	{ 0x40cd3009a99db8e0LLU, 0x3ad79d9d8d5f4b00LLU },
+	{ 0x864b109a4a5bc983LLU, 0x71440541de2ce43fLLU },
+	{ 0xd5b02855415d7b0fLLU, 0x3ccf32e2ae99a1f1LLU },
+	{ 0x527d90427b2e38eaLLU, 0xea8f4751d73d240dLLU },
+	{ 0x96c07656ca9b5fe2LLU, 0xbd92498ed269d808LLU },
+	{ 0xba8244c0b4c82da0LLU, 0x5df3295f0550b754LLU },
+	{ 0x427b88c247e6bee8LLU, 0x307b17ac1a54f44bLLU },
+	{ 0xf1a349a6a52f9a09LLU, 0xd2a6f2e3625c6c48LLU },
+	{ 0x1e4a295f39768d3eLLU, 0x238b548f5205b226LLU },
+	{ 0x1de8966fd187fccbLLU, 0x3dfb5f7145351b8fLLU },
+	{ 0xd94fd8dd31236115LLU, 0x9d5ac55dad5342b1LLU },
+	{ 0x7e07008cbdc696fdLLU, 0xe4856d881b345d6eLLU },
+	{ 0xbd40d6f1c820eb72LLU, 0x89d34d8bd54d46bfLLU },
+	{ 0x506f200b5c37c5a4LLU, 0x2a4d51530f4f1399LLU },
+	{ 0x2c9bc595faf3e582LLU, 0x2c99fdb30de24f8bLLU },
+	{ 0x4c8fad00383ad5deLLU, 0x99fd7031150e9755LLU },
+	{ 0x62aac2f211e839a6LLU, 0x2281aa24b818ced2LLU },
+	{ 0x20c9034332af92bbLLU, 0x4ecb8b6f5d8bd3e7LLU },
+	{ 0xf30b3c1d1b9cb18bLLU, 0xbaebf89839af52e9LLU },
+	{ 0x0195c629b02a7e79LLU, 0xe906f52c4889387cLLU },
+	{ 0x73fa71988f599ebcLLU, 0x97b7fb84ffd7c772LLU },
+	{ 0x3b038b3365cd0340LLU, 0x043d6b2fc945f39fLLU },
+	{ 0x9014550d6ed7a717LLU, 0x4411a650f1375386LLU },
+	{ 0x9c7ff637045ae6d6LLU, 0x551d79a2f9e787b7LLU },
+	{ 0x19a8f8ad151e95d9LLU, 0x10659bc388e90611LLU },
+	{ 0x05c6fc99d38fa52aLLU, 0x9423b5267f8ee1aaLLU },
+	{ 0x667448b3c2f18f4eLLU, 0x8ae610f112a6b007LLU },
+	{ 0x76daf7aa0328eaf7LLU, 0xed6fb6ae74b89880LLU },
+	{ 0x0956de3e0b6b8832LLU, 0xfcf024119442d7beLLU },
+	{ 0x2d3568da63d5c114LLU, 0x25fa25f94cde0a57LLU },
+	{ 0x1a3c9d97da11d0caLLU, 0x2ea09516116a7b05LLU },
+	{ 0x81feb6a0f562e0c9LLU, 0x05a8c7b9cb07eb33LLU },
+	{ 0x13e37e51d60c06edLLU, 0xc4ff27bde6c6d2d6LLU },
+	{ 0xcd24136d454ced86LLU, 0xbbaea044edd4a444LLU },
+	{ 0x042cac93574997b0LLU, 0x5e4307f580c50e4aLLU },
+	{ 0x9fe4ecef43154b71LLU, 0xb9dd6e337c5eaa35LLU },
+	{ 0xe7ce1ad6bc12532eLLU, 0x332fe9459dfac252LLU },
+	{ 0xe8f341b471a604b9LLU, 0xdac9a81e75ce3d39LLU },
+	{ 0x592a6a57ab779d45LLU, 0xa9d0f354a896c8ddLLU },
+	{ 0x3f5c94d3fdb3c331LLU, 0x700133c918873c94LLU },
+	{ 0x3490d4ca82ff0f48LLU, 0x63a2f922d914bde0LLU },
+	{ 0xbb18d7ebcfba26dbLLU, 0x3704b89cea6b32d9LLU },
+	{ 0x21b60d929e9f36d1LLU, 0xb3420e97138c3ac9LLU },
+	{ 0x353e3ab6f6406c08LLU, 0xc1126c92870800bbLLU },
+	{ 0x1b63367524277822LLU, 0xd64f66dd70522883LLU },
+	{ 0x0f3d3d5b96332f28LLU, 0xca1f44027e28b6a2LLU },
+	{ 0x5ee0ed2373b05e3dLLU, 0x62ad06c1e197b4a5LLU },
+	{ 0x1f6480fa00195b50LLU, 0x697c48af71243e4fLLU },
+	{ 0x7ba6040e950549e6LLU, 0x74558f81079fe515LLU },
+	{ 0x2908be7b8b0b0ec6LLU, 0x2d605727babf17c7LLU },
+	{ 0x99ddaff03586875dLLU, 0x1a912279544eff18LLU },
+	{ 0x60cc110481f54364LLU, 0x6cb67fe57790c5ceLLU },
+	{ 0xec1ddd50e26665aeLLU, 0x3e0893205604370eLLU },
+	{ 0xee6a0210a33b20aaLLU, 0xe171bfaa08739a1eLLU },
+	{ 0x0ed8f97d1eaa3ee5LLU, 0x8e3092da2872ad87LLU },
+	{ 0xcb8078fd7a1b1d7dLLU, 0x5b61ebeab29daf9bLLU },
+	{ 0x78ff7c7767a51c5eLLU, 0xf7f165f40e332eefLLU },
+	{ 0x03e205e013f2de53LLU, 0xc2d5ab7fd385abb2LLU },
+	{ 0x88ca73bc2154ca4dLLU, 0x732c316a6efd25b6LLU },
+	{ 0x43857b3d8ca3fbc5LLU, 0x95789f68e9d33591LLU },
+	{ 0x15882f3b69f4d1afLLU, 0xa49b4a28f3396504LLU },
+	{ 0xf461ba72e8ef82b4LLU, 0x65eee86bce68a350LLU },
+	{ 0x24ebff44568a159eLLU, 0xaf74b2cd76df2d73LLU },
+	{ 0xb4064670066ef63cLLU, 0x0788c39063316153LLU },
+	{ 0xe238657a1a7c77c0LLU, 0x1b29f73479264e02LLU },
+	{ 0xb3fd1f657d8d40b3LLU, 0x15b226f685790727LLU },
+	{ 0xa2517a4c61a1c758LLU, 0x43be1ce79ac7cfbdLLU },
+	{ 0x85b5b2b1c704f7f6LLU, 0x1e9446f040a3c1b9LLU },
+	{ 0xc947d3e21d3575daLLU, 0x48c5627cbea09f61LLU },
+	{ 0x57865063aecfbf07LLU, 0xb098a79fb3b983dfLLU },
+	{ 0x802fcf35ceea931fLLU, 0x0d6dc6efb66dba5eLLU },
+	{ 0x6dbd9a732e6a6724LLU, 0x36ec5893b484575dLLU },
+	{ 0x22e5ccffc31dd9e1LLU, 0x20dbe3d125b0b532LLU },
+	{ 0x53377d176ffb7170LLU, 0x4de12d633da2e96cLLU },
+	{ 0xf87389cc280d5667LLU, 0x4f41410550a53ba8LLU },
+	{ 0xfe5040afec0151cdLLU, 0x7db9393996239ee3LLU },
+	{ 0x0d270c78f27046d5LLU, 0xc9a46f3b66179217LLU },
+	{ 0xb2059eb8b24135b2LLU, 0x5fc414c0e04ca574LLU },
+	{ 0xbf452528331ac64bLLU, 0xacd90f19c13ecaabLLU },
+	{ 0x91391911af71e8a1LLU, 0x1468bd5502ac96b3LLU },
+	{ 0xfd41dc5dd8fcd6f2LLU, 0x9b32d7d9867822f4LLU },
+	{ 0xdd7ecd84c68cc4f8LLU, 0x7c908e4958193f45LLU },
+	{ 0xe16dd0864d2dcef4LLU, 0x350d3d104bb66fadLLU },
+	{ 0x54e938f4df90af73LLU, 0x87de915ec51b0dc0LLU },
+	{ 0x61288a8db6e2b93bLLU, 0xfb0f979401cb91fdLLU },
+	{ 0x4a31eb2ba645092cLLU, 0x09f9e591108ae879LLU },
+	{ 0x3dee3f1f771f0d01LLU, 0x1cba7eee32da8a8dLLU },
+	{ 0x00c1c4a70982255bLLU, 0xffd6e689e41266deLLU },
+	{ 0x16428d61665fab49LLU, 0xb66bfe96a60b26b8LLU },
+	{ 0x67777446eff07a0dLLU, 0xd42ea9bc65bcd46dLLU },
+	{ 0xc39c6f4b07d228b6LLU, 0xfd8a6abfa03893e2LLU },
+	{ 0x7c894f2d48be1e75LLU, 0x86871bfa8ad21564LLU },
+	{ 0xd04991240f149bdfLLU, 0x12aac146fdd169daLLU },
+	{ 0xb9834ebfa7a78016LLU, 0x2be821c80c474925LLU },
+	{ 0x5c67c1742b9aa1efLLU, 0x6ac64eb4368fee0bLLU },
+	{ 0xef1cfbac79d333c4LLU, 0x020960b6bdf0dfa1LLU },
+	{ 0x06cf3b71627bf213LLU, 0x77590248ca7cefd0LLU },
+	{ 0x270dda1e3a57a294LLU, 0x4136cec6897b785aLLU },
+	{ 0xf5c8e9ba4cf91406LLU, 0x0c46acd3af7f1414LLU },
+	{ 0xb511a70f833e42dcLLU, 0xdd7dc0994e985f58LLU },
+	{ 0x1084aace3dd430bfLLU, 0x5197cd6d59f7e2a0LLU },
+	{ 0xf05ac340c4ddd8f0LLU, 0x3f337313b17da91cLLU },
+	{ 0xa41b166aa2997265LLU, 0xc5d838dea7d5fd19LLU },
+	{ 0x1cf49ba336b8e2cfLLU, 0xf2380b2e9222f94cLLU },
+	{ 0x5b36095c3c50f066LLU, 0xa719ec12c31df0c6LLU },
+	{ 0xc6dc548a92defa25LLU, 0x72f29823dcbdb813LLU },
+	{ 0xc7c7939d5b326619LLU, 0x5a83cbe131e5c3fcLLU },
+	{ 0x30ed674d27ca3212LLU, 0xbf27e4662a880130LLU },
+	{ 0x25a4df0a295ecc88LLU, 0xeb7f45a37ba96afeLLU },
+	{ 0x373b57e5fe7ead4cLLU, 0x50fc2a1fcd5779c4LLU },
+	{ 0xb755e168bb6f1757LLU, 0x1d7e534aac9bb19cLLU },
+	{ 0xfa236d366dd6b51aLLU, 0xe3e23ead5aec4dcdLLU },
+	{ 0x2f1a5c6ed5ae2174LLU, 0xe0fec915f6515084LLU },
+	{ 0x11db696078853446LLU, 0xfa7a9cf39564452bLLU },
+	{ 0xa90414c49755f4beLLU, 0xf52bcfbb822708d7LLU },
+	{ 0xff294369f33c5490LLU, 0xb88059ca9b8673a6LLU },
+	{ 0xeaa28fdb3fd9a46aLLU, 0xf0b59401c761b9a4LLU },
+	{ 0x4bbbf33060243a39LLU, 0x931023fe7da75870LLU },
+	{ 0xf92686522293ba9fLLU, 0x451cc26434c47a2dLLU },
+	{ 0x07a9d9471f816d78LLU, 0x0a6eadce23eb40baLLU },
+	{ 0x1272b5dc647f8e92LLU, 0xf10b2b7edd11941aLLU },
+	{ 0x2edf5dcdaac1e141LLU, 0xa013eab519c91e95LLU },
+	{ 0xac6839d87596aa76LLU, 0x24cd7470bf3c77acLLU },
+	{ 0x74c275c1c906e7a5LLU, 0xc30ae14c84295af5LLU },
+	{ 0x8b66c8a116fd0769LLU, 0xd96c342522e19d9dLLU },
+	{ 0x23f906b7dcdcc029LLU, 0x193f30764ad6da59LLU },
+	{ 0x71d32a9699c77c6dLLU, 0x7f848cfc26b21910LLU },
+	{ 0xc587c7136a342493LLU, 0x7a2a4b4bd6e611e1LLU },
+	{ 0xa3abc0fe51075c44LLU, 0x3247a540e592c6d5LLU },
+	{ 0x0a160b7f9cb6fe85LLU, 0x8802d21b17e05e2aLLU },
+	{ 0x704ee0d19d47029dLLU, 0x533bf665f5402968LLU },
+	{ 0x935b18e359ccd71dLLU, 0xb5bfbaa0e325479aLLU },
+	{ 0xb0995e79e3dbfdd3LLU, 0xd122daa1d871d122LLU },
+	{ 0x84deeef386d1d2a2LLU, 0xa621d0e48f498637LLU },
+	{ 0x445da3d7eed8bc23LLU, 0x76e5db47c4d08241LLU },
+	{ 0x7aadfdcf0c52638cLLU, 0x790e5269fa00c028LLU },
+	{ 0xda4459b594e0006eLLU, 0x037771a93863ac0fLLU },
+	{ 0xb15fbd16e9880181LLU, 0x2169437b61444c06LLU },
+	{ 0x5f21aec8cd0a0c68LLU, 0xdc3efa8af4ff7531LLU },
+	{ 0xd47101de204d2921LLU, 0xa537d6e8a92e215cLLU },
+	{ 0x978a852ef830941cLLU, 0x0100d175bc9ccda7LLU },
+	{ 0x387553ee8e8062d0LLU, 0x165cd9049330445bLLU },
+	{ 0xe060f232f4b7c2faLLU, 0xe5515e591f9e0b51LLU },
+	{ 0x26f7821cd94bff20LLU, 0xab4c89c297768e46LLU },
+	{ 0x9562212a76463bf9LLU, 0x75b8b0d55755038eLLU },
+	{ 0x9db466411813646cLLU, 0x574b1a30687a186bLLU },
+	{ 0x6f4ce2036c795796LLU, 0x289e034290ee4198LLU },
+	{ 0xe333a53498e14f3fLLU, 0xf62642a569956736LLU },
+	{ 0x08e12d809bac6f11LLU, 0xd0730a3a6d0a741bLLU },
+	{ 0xa093bb1ab58baeddLLU, 0x3bcab98d1ce45524LLU },
+	{ 0x5af512e14bee6b38LLU, 0xb7458ad65cdd3621LLU },
+	{ 0x7dd0cef8fc258104LLU, 0xd57920a63bd87d2cLLU },
+	{ 0xe66e92013010bd37LLU, 0x68bd56bef703338aLLU },
+	{ 0x55542b4ead09b277LLU, 0xeeb0019e721c0c92LLU },
+	{ 0x33afe7f9b8724560LLU, 0x4939bc38a27ea681LLU },
+	{ 0x48d68189cc2276a7LLU, 0x17a93c6cc613fc29LLU },
+	{ 0xc000159b0a602bc8LLU, 0x67b3e021d06670edLLU },
+	{ 0xcc581d4a85c5a96fLLU, 0xf952ca3d4db3a24dLLU },
+	{ 0xe413c9ecb1f88362LLU, 0x1fa35b0c8cefbe12LLU },
+	{ 0xf70aefc3916127b7LLU, 0x8bc27b7478bbe03bLLU },
+	{ 0x7934458f024431fbLLU, 0xe631785b2c3ffa40LLU },
+	{ 0xd620f57cf151a36bLLU, 0x92ccb17aa5a1cbf0LLU },
+	{ 0x4fefb138ff0e4ad4LLU, 0x8de4163eb70d85b0LLU },
+	{ 0x8ea098642395595aLLU, 0x83bb901d7a2b764eLLU },
+	{ 0xa7d53449844ecdd8LLU, 0x582481b05332995fLLU },
+	{ 0x4e9d8cc61c218680LLU, 0x8f5009d7fb169097LLU },
+	{ 0x8ca5ab2c10df60baLLU, 0x7bd10cfd1d5643afLLU },
+	{ 0x77ec4a0c4f178b26LLU, 0x2720130fd1f3f7cfLLU },
+	{ 0xed0c2e59e61812a3LLU, 0xa8f47d735e0fd9eeLLU },
+	{ 0xf65735bb0d3189e9LLU, 0x4095888544cd6ecbLLU },
+	{ 0xab198ebd5297a8fcLLU, 0x9c63a35afcf9a0f2LLU },
+	{ 0x8297e4fc87a0f39cLLU, 0x1196e2d0c02d1d20LLU },
+	{ 0xaad9f10808c0e44fLLU, 0x9ae93a9b35f18bf7LLU },
+	{ 0x2ae7a81470a22a56LLU, 0xf49cbbf83afe2cffLLU },
+	{ 0x46d451f701ce552bLLU, 0xcf86b3ebbb75ed9eLLU },
+	{ 0x6e3ffe0768e7688aLLU, 0x9eea5d3f8120f5f6LLU },
+	{ 0x944d4be78938f9c1LLU, 0x381a69a860b7817bLLU },
+	{ 0x3a706c25e40ff889LLU, 0xa3dcefc4160c0fe6LLU },
+	{ 0x6c460fa53442b7c2LLU, 0xad0368ec6ff60449LLU },
+	{ 0x513284d93b8e6e7cLLU, 0x18afbe729e4bd603LLU },
+	{ 0x922b77535fa4cf51LLU, 0x0bf587ff91c1c4c5LLU },
+	{ 0xdc9aa6824e030599LLU, 0xc8e0b7520648bf62LLU },
+	{ 0x9a2d42f54265acd7LLU, 0xccdf19c500a489b4LLU },
+	{ 0xce693e5405bba0c3LLU, 0x3993de60c846e3caLLU },
+	{ 0x0cea0718ebb1c8ccLLU, 0x549a2e1a03f551b5LLU },
+	{ 0xdfd7bff6f0bc5a18LLU, 0xfe4980b214c0d5f8LLU },
+	{ 0xa58d64be0ed0230cLLU, 0x9856f0b8db778477LLU },
+	{ 0x83ac4d2facc43dd2LLU, 0xcdefdfcf415a2066LLU },
+	{ 0xa6917245ba2944b8LLU, 0x969f7257044154e5LLU },
+	{ 0xd79ffa5a447a697eLLU, 0x61d46477511e80aeLLU },
+	{ 0x56109cfb2a919952LLU, 0x9f3540072bed7efaLLU },
+	{ 0x651e954f5e08da36LLU, 0x4c1bc856a159722fLLU },
+	{ 0xfbbed16bcb4f7fa9LLU, 0xc7c099c72dfb4ac3LLU },
+	{ 0xd109e69cd2c9f18fLLU, 0x26f73b6133706b67LLU },
+	{ 0xae7a799449a9797fLLU, 0x4b645a32efbe3476LLU },
+	{ 0x8d30e8a9553f0a98LLU, 0x0e17dd3643b5f878LLU },
+	{ 0x640e70d2dd26bbacLLU, 0xa2a71fcc21b41665LLU },
+	{ 0x9e8c2220a02c13e7LLU, 0xb434af2d6467d016LLU },
+	{ 0x289452b0beab0bffLLU, 0x42c8851c9f8daedbLLU },
+	{ 0x4112e548589eb39bLLU, 0x47537cba8ee8238cLLU },
+	{ 0x63d158879f7dec34LLU, 0x851577ed5fd9e73dLLU },
+	{ 0x75925f2653b93c97LLU, 0x525ed42accf288e4LLU },
+	{ 0xbcfc17cbf7cb18b1LLU, 0xbe3caee98b91fbd8LLU },
+	{ 0xdb3a0862bf6c4ef5LLU, 0x0f6aa103551559fbLLU },
+	{ 0x4d253181a8e3b655LLU, 0x4a5855fb6b82090cLLU },
+	{ 0x68b263902ce58aa8LLU, 0xdbc71283ab74122eLLU },
+	{ 0xcfcb5a3fd46874ebLLU, 0xdebc8d5846ab1fecLLU },
+	{ 0xb6fb1cc790436a10LLU, 0x7854d867f0107ca9LLU },
+	{ 0x9bbfa2aec5facbecLLU, 0x5ca1040e6c1a5b88LLU },
+	{ 0x69f22676142b5d35LLU, 0x64e337a720c330e8LLU },
+	{ 0x7f53a43a7e64d47bLLU, 0xce071582aa656d85LLU },
+	{ 0x89f0db6c80634d5cLLU, 0xc04e7562a4812b0aLLU },
+	{ 0x6ac4a11be553737aLLU, 0x90624c067343f2dcLLU },
+	{ 0x4979b78326945827LLU, 0xcb403f0b99cc9582LLU },
+	{ 0xbeae0aa440b47002LLU, 0x34f600b16afc9cd1LLU },
+	{ 0x8f1f24e6f900088dLLU, 0x84ab61dc27837f7aLLU },
+	{ 0x1817b39fe0c27d84LLU, 0xe82dd3432e3b0563LLU },
+	{ 0xcab92c8b46e9a6bdLLU, 0xef251d3c426c681fLLU },
+	{ 0xd843a9b92d5c84eeLLU, 0xbc72832bee4a4893LLU },
+	{ 0xc2bcd5d02fc3f500LLU, 0x6f5f76172fad0209LLU },
+	{ 0xad8bf0278dad4c61LLU, 0xaa1611e629ae5cccLLU },
+	{ 0x475947e4eaf7dc33LLU, 0xc65784b7c2eaa890LLU },
+	{ 0xe55233c51978475fLLU, 0x3176b4a43fba6043LLU },
+	{ 0x029e1ba237562e0bLLU, 0x465b965cdf62ea60LLU },
+	{ 0x14e6b405a1fe982fLLU, 0xaeacfc9a092a1a1dLLU }
+};
+
+/* Column i of the minor cauchy matrix, laid out as above: byte 7 - j is 1 / ( f[ j ] + g[ i ] ) */
+const u64 cauchy_8x8s_0[ MDS__8BIT_X_64BIT_TABLE_INDEX__SIZE ] = {
+	0x6b9df8d5e26304cdLLU,
+	0xd74e081eebcf4127LLU,
+	0x38235b03a041cf07LLU,
+	0x9c7da01a5b4650c4LLU,
+	0x7d9cdd4134031e8bLLU,
+	0xcd1c41dd465b086bLLU,
+	0x1ccd1aa00334e39dLLU,
+	0x411acd7d8c38d7f8LLU
+};
+
+/* Column i of the major cauchy matrix, likewise split into left and right words */
+const u64 cauchy_16x8s_0[ MDS__8BIT_X_128BIT_TABLE_INDEX__SIZE ][ 2 ] = {
+	{ 0x018d4fe53f5a4559LLU, 0x5c3370b9c82f0d41LLU },
+	{ 0xb2ff5f74d177c23aLLU, 0x099743de719d1cb1LLU },
+	{ 0x7719f36c55b2b0f6LLU, 0x335c2defd81c9da3LLU },
+	{ 0xbf4c1718091043f4LLU, 0xd120c2941cd87126LLU },
+	{ 0x7985b682f4ca1d09LLU, 0x3a40e81c94efdea4LLU },
+	{ 0x5696a49b9a8f71a5LLU, 0xead71ce8c22d43b6LLU },
+	{ 0x326a9fdc95e02ee7LLU, 0x2f1cd740205c9793LLU },
+	{ 0x62ce48fb71f79adeLLU, 0x1c2fea3ad13309edLLU },
+	{ 0x0ba3a9e694eb5b1cLLU, 0xdee7a509f4f63a19LLU },
+	{ 0xe61b0f0bea5d1c5bLLU, 0x9a2e711d43b0c22cLLU },
+	{ 0x9d6bc563da1c5debLLU, 0xf7e08fca10b277f1LLU },
+	{ 0xadc6b3081cdaea94LLU, 0x71959af40955d158LLU },
+	{ 0x5b34dd1c08630be6LLU, 0xfbdc9b82186c74c7LLU },
+	{ 0x8c681cddb3c50fa9LLU, 0x489fa4b617f35fe8LLU },
+	{ 0xcd1c6834c66b1ba3LLU, 0xce6a96854c19fff6LLU },
+	{ 0x411a0323cff8ac28LLU, 0xd26dbeb787bbee01LLU }
+};
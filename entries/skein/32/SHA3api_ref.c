@@ -20,6 +20,7 @@
 /* select the context size and init the context */
 HashReturn Init(hashState *state, int hashbitlen)
     {
+    state->tree = NULL;
     if (hashbitlen <= SKEIN_256_NIST_MAX_HASHBITS)
         {
         Skein_Assert(hashbitlen > 0,BAD_HASHLEN);
@@ -42,6 +43,9 @@ HashReturn Init(hashState *state, int hashbitlen)
 /* process data to be hashed */
 HashReturn Update(hashState *state, const BitSequence *data, DataLength databitlen)
     {
+    if (state->tree)
+        return TreeUpdate(state,data,databitlen);
+
     /* only the final Update() call is allowed do partial bytes, else assert an error */
     Skein_Assert((state->u.h.T[1] & SKEIN_T1_FLAG_BIT_PAD) == 0 || databitlen == 0, FAIL);
 
@@ -87,6 +91,9 @@ HashReturn Update(hashState *state, const BitSequence *data, DataLength databitl
 /* finalize hash computation and output the result (hashbitlen bits) */
 HashReturn Final(hashState *state, BitSequence *hashval)
     {
+    if (state->tree)
+        return TreeFinal(state,hashval);
+
     Skein_Assert(state->statebits % 256 == 0 && (state->statebits-256) < 1024,FAIL);
     switch ((state->statebits >> 8) & 3)
         {
@@ -20,6 +20,7 @@
 /* select the context size and init the context */
 HashReturn Init(hashState *state, int hashbitlen)
     {
+    state->tree = NULL;
     if (hashbitlen <= SKEIN_256_NIST_MAX_HASHBITS)
         {
         Skein_Assert(hashbitlen > 0,BAD_HASHLEN);
@@ -42,6 +43,9 @@ HashReturn Init(hashState *state, int hashbitlen)
 /* process data to be hashed */
 HashReturn Update(hashState *state, const BitSequence *data, DataLength databitlen)
     {
+    if (state->tree)
+        return TreeUpdate(state,data,databitlen);
+
     /* only the final Update() call is allowed do partial bytes, else assert an error */
     Skein_Assert((state->u.h.T[1] & SKEIN_T1_FLAG_BIT_PAD) == 0 || databitlen == 0, FAIL);
 
@@ -87,6 +91,9 @@ HashReturn Update(hashState *state, const BitSequence *data, DataLength databitl
 /* finalize hash computation and output the result (hashbitlen bits) */
 HashReturn Final(hashState *state, BitSequence *hashval)
     {
+    if (state->tree)
+        return TreeFinal(state,hashval);
+
     Skein_Assert(state->statebits % 256 == 0 && (state->statebits-256) < 1024,FAIL);
     switch ((state->statebits >> 8) & 3)
         {
@@ -111,3 +118,30 @@ HashReturn Hash(int hashbitlen, const BitSequence *data, /* all-in-one call */
         }
     return r;
     }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* all-in-one hash function for several messages at once */
+HashReturn HashBatch(int hashbitlen, const BitSequence *const data[],
+                     const size_t dataByteCnt[], BitSequence *const hashval[], size_t n)
+    {
+    HashReturn r = SUCCESS;
+    size_t     i;
+
+    Skein_Assert(hashbitlen > 0,BAD_HASHLEN);
+    /* Skein-512 messages go through the SIMD lanes together */
+    if (hashbitlen > SKEIN_256_NIST_MAX_HASHBITS && hashbitlen <= SKEIN_512_NIST_MAX_HASHBITS)
+        return Skein_512_Hash_Multi((size_t) hashbitlen,data,dataByteCnt,hashval,n);
+
+    for (i=0;i<n && r == SUCCESS;i++)
+        r = Hash(hashbitlen,data[i],8*(DataLength) dataByteCnt[i],hashval[i]);
+    return r;
+    }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* how many messages HashBatch hashes side by side                */
+size_t BatchLanes(int hashbitlen)
+    {
+    if (hashbitlen > SKEIN_256_NIST_MAX_HASHBITS && hashbitlen <= SKEIN_512_NIST_MAX_HASHBITS)
+        return Skein_512_Lanes();
+    return 1;
+    }
@@ -134,6 +134,18 @@ int  Skein_512_Output   (Skein_512_Ctxt_t *ctx, u08b_t * hashVal);
 int  Skein1024_Output   (Skein1024_Ctxt_t *ctx, u08b_t * hashVal);
 #endif
 
+/*
+**   Skein APIs for hashing several messages at once (skein_multi.c):
+**      Process_Block_Multi: one block for each of n contexts, processed
+**                           in SIMD lanes where the compiler has them
+**      Hash_Multi:          n whole messages, in as many lanes as there
+**                           are, each result identical to Init/Update/Final
+*/
+#define SKEIN_512_MAX_LANES (8)
+void Skein_512_Process_Block_Multi(Skein_512_Ctxt_t *ctx[],const u08b_t *blkPtr[],const size_t byteCntAdd[],size_t n);
+int  Skein_512_Hash_Multi(size_t hashBitLen,const u08b_t *const msg[],const size_t msgByteCnt[],u08b_t *const hashVal[],size_t n);
+size_t Skein_512_Lanes(void);               /* how many messages share a register */
+
 /*****************************************************************
 ** "Internal" Skein definitions
 **    -- not needed for sequential hashing API, but will be 
@@ -0,0 +1,277 @@
+/***********************************************************************
+**
+** Multi-buffer Skein-512: several independent messages hashed in
+** lockstep, one message per SIMD lane.
+**
+** Skein_512_Process_Block() keeps one 64-bit word of one message in
+** each general register.  Here word i of SKEIN_512_LANES messages
+** shares one vector register instead, so every add, rotate and xor of
+** Threefish-512 works on all of them at once, using the compiler's
+** generic vector types.
+**
+** Compile-time switches:
+**
+**  SKEIN_512_LANES -- how many messages share a register: 8 if the
+**                     file is compiled for AVX-512F (which rotates in
+**                     one instruction), 4 for AVX2.  [default: as
+**                     many as the instruction set allows, but 1 for
+**                     plain SSE2, where 2 lanes of shifts and ors ran
+**                     slower than the scalar code's rotates]
+**
+** Skein_512_Hash_Multi() keeps every lane busy: as soon as one message
+** has been output, the next one takes over its lane.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <string.h>
+#include "skein.h"
+
+/* the scalar block function, from skein_block.c */
+void Skein_512_Process_Block(Skein_512_Ctxt_t *ctx,const u08b_t *blkPtr,size_t blkCnt,size_t byteCntAdd);
+
+#ifndef SKEIN_512_LANES
+#if   defined(__GNUC__) && defined(__AVX512F__)
+#define SKEIN_512_LANES (8)
+#elif defined(__GNUC__) && defined(__AVX2__)
+#define SKEIN_512_LANES (4)
+#else
+#define SKEIN_512_LANES (1)                     /* 2 for SSE2, but see above */
+#endif
+#endif
+
+#if SKEIN_512_LANES > SKEIN_512_MAX_LANES
+#error "SKEIN_512_MAX_LANES is too small"
+#endif
+
+#if SKEIN_512_LANES > 1
+typedef u64b_t lane_t __attribute__ ((vector_size (8*SKEIN_512_LANES)));
+
+#define RotL_Lanes(x,N) (((x) << (N)) | ((x) >> (64-(N))))
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* one block for each of exactly SKEIN_512_LANES contexts */
+static void Skein_512_Process_Lanes(Skein_512_Ctxt_t *ctx[],const u08b_t *blkPtr[],const size_t byteCntAdd[])
+    {
+    enum
+        {
+        WCNT = SKEIN_512_STATE_WORDS
+        };
+    lane_t  X[WCNT];                            /* the state words, one lane per message */
+    lane_t  w[WCNT];                            /* the input blocks, likewise            */
+    lane_t  ks[WCNT+1];                         /* key schedule: chaining vars + parity  */
+    lane_t  ts[3];                              /* tweak words                           */
+    u64b_t  blk[WCNT];
+    uint_t  i,l;
+
+    for (l=0;l<SKEIN_512_LANES;l++)             /* transpose into the lanes */
+        {
+        Skein_Get64_LSB_First(blk,blkPtr[l],WCNT);
+        for (i=0;i<WCNT;i++)
+            {
+            w [i][l] = blk[i];
+            ks[i][l] = ctx[l]->X[i];
+            }
+        ts[0][l] = ctx[l]->h.T[0] + byteCntAdd[l];
+        ts[1][l] = ctx[l]->h.T[1];
+        }
+    ks[8] = ks[0] ^ ks[1] ^ ks[2] ^ ks[3] ^
+            ks[4] ^ ks[5] ^ ks[6] ^ ks[7] ^ SKEIN_KS_PARITY;
+    ts[2] = ts[0] ^ ts[1];
+
+    X[0] = w[0] + ks[0];                        /* do the first full key injection */
+    X[1] = w[1] + ks[1];
+    X[2] = w[2] + ks[2];
+    X[3] = w[3] + ks[3];
+    X[4] = w[4] + ks[4];
+    X[5] = w[5] + ks[5] + ts[0];
+    X[6] = w[6] + ks[6] + ts[1];
+    X[7] = w[7] + ks[7];
+
+    /* the same rounds as Skein_512_Process_Block(), fully unrolled */
+#define Round512L(p0,p1,p2,p3,p4,p5,p6,p7,ROT)                              \
+    X[p0] += X[p1]; X[p1] = RotL_Lanes(X[p1],ROT##_0); X[p1] ^= X[p0];      \
+    X[p2] += X[p3]; X[p3] = RotL_Lanes(X[p3],ROT##_1); X[p3] ^= X[p2];      \
+    X[p4] += X[p5]; X[p5] = RotL_Lanes(X[p5],ROT##_2); X[p5] ^= X[p4];      \
+    X[p6] += X[p7]; X[p7] = RotL_Lanes(X[p7],ROT##_3); X[p7] ^= X[p6];
+
+#define I512L(R)                                                            \
+    X[0] += ks[((R)+1) % 9];   /* inject the key schedule value */          \
+    X[1] += ks[((R)+2) % 9];                                                \
+    X[2] += ks[((R)+3) % 9];                                                \
+    X[3] += ks[((R)+4) % 9];                                                \
+    X[4] += ks[((R)+5) % 9];                                                \
+    X[5] += ks[((R)+6) % 9] + ts[((R)+1) % 3];                              \
+    X[6] += ks[((R)+7) % 9] + ts[((R)+2) % 3];                              \
+    X[7] += ks[((R)+8) % 9] + (u64b_t) ((R)+1);
+
+#define R512L_8_rounds(R)  /* do 8 full rounds */   \
+    Round512L(0,1,2,3,4,5,6,7,R_512_0);             \
+    Round512L(2,1,4,7,6,5,0,3,R_512_1);             \
+    Round512L(4,1,6,3,0,5,2,7,R_512_2);             \
+    Round512L(6,1,0,7,2,5,4,3,R_512_3);             \
+    I512L(2*(R));                                   \
+    Round512L(0,1,2,3,4,5,6,7,R_512_4);             \
+    Round512L(2,1,4,7,6,5,0,3,R_512_5);             \
+    Round512L(4,1,6,3,0,5,2,7,R_512_6);             \
+    Round512L(6,1,0,7,2,5,4,3,R_512_7);             \
+    I512L(2*(R)+1);
+
+#if SKEIN_512_ROUNDS_TOTAL != 72
+#error "Skein_512_Process_Lanes is unrolled for 72 rounds only"
+#endif
+    R512L_8_rounds( 0);
+    R512L_8_rounds( 1);
+    R512L_8_rounds( 2);
+    R512L_8_rounds( 3);
+    R512L_8_rounds( 4);
+    R512L_8_rounds( 5);
+    R512L_8_rounds( 6);
+    R512L_8_rounds( 7);
+    R512L_8_rounds( 8);
+
+    for (i=0;i<WCNT;i++)                        /* do the final "feedforward" xor */
+        X[i] ^= w[i];
+
+    for (l=0;l<SKEIN_512_LANES;l++)             /* transpose back into the contexts */
+        {
+        for (i=0;i<WCNT;i++)
+            ctx[l]->X[i] = X[i][l];
+        ctx[l]->h.T[0] = ts[0][l];
+        ctx[l]->h.T[1] = ts[1][l] & ~SKEIN_T1_FLAG_FIRST;
+        }
+    }
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* how many messages the functions below process at once */
+size_t Skein_512_Lanes(void)
+    {
+    return SKEIN_512_LANES;
+    }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* process one block for each of n contexts, all in lockstep */
+void Skein_512_Process_Block_Multi(Skein_512_Ctxt_t *ctx[],const u08b_t *blkPtr[],const size_t byteCntAdd[],size_t n)
+    {
+#if SKEIN_512_LANES > 1
+    Skein_512_Ctxt_t  spare;                    /* fills the lanes n leaves empty */
+    Skein_512_Ctxt_t *c[SKEIN_512_LANES];
+    const u08b_t     *b[SKEIN_512_LANES];
+    size_t            a[SKEIN_512_LANES];
+    size_t            l,cnt;
+
+    memset(&spare,0,sizeof(spare));
+    while (n > 1)                               /* a lone block is cheaper in scalar code */
+        {
+        cnt = (n < SKEIN_512_LANES) ? n : SKEIN_512_LANES;
+        for (l=0;l<SKEIN_512_LANES;l++)
+            {
+            c[l] = (l < cnt) ? ctx[l]        : &spare;
+            b[l] = (l < cnt) ? blkPtr[l]     : spare.b;
+            a[l] = (l < cnt) ? byteCntAdd[l] : 0;
+            }
+        Skein_512_Process_Lanes(c,b,a);
+        ctx        += cnt;
+        blkPtr     += cnt;
+        byteCntAdd += cnt;
+        n          -= cnt;
+        }
+#endif
+    for (;n;n--)
+        Skein_512_Process_Block(*ctx++,*blkPtr++,1,*byteCntAdd++);
+    }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash n whole messages, each exactly as Init/Update/Final would */
+int Skein_512_Hash_Multi(size_t hashBitLen,const u08b_t *const msg[],const size_t msgByteCnt[],u08b_t *const hashVal[],size_t n)
+    {
+    enum
+        {
+        LANE_FREE = 0,                          /* no message in the lane            */
+        LANE_MSG,                               /* message blocks still to process   */
+        LANE_FINAL,                             /* final block done, output next     */
+        LANE_OUT                                /* output block done                 */
+        };
+    struct
+        {
+        Skein_512_Ctxt_t ctx;
+        const u08b_t    *msg;                   /* rest of the message               */
+        size_t           left;                  /* bytes of it                       */
+        u08b_t          *hashVal;
+        int              stage;
+        } lane[SKEIN_512_LANES];
+    Skein_512_Ctxt_t  iv;                       /* the context after Init()          */
+    Skein_512_Ctxt_t *c[SKEIN_512_LANES];
+    const u08b_t     *b[SKEIN_512_LANES];
+    size_t            a[SKEIN_512_LANES];
+    size_t            l,cnt,next = 0;
+
+    /* one output block is all counter mode needs up to 512 bits */
+    Skein_Assert(hashBitLen > 0 && hashBitLen <= SKEIN_512_STATE_BITS,SKEIN_BAD_HASHLEN);
+    Skein_512_Init(&iv,hashBitLen);
+    for (l=0;l<SKEIN_512_LANES;l++)
+        lane[l].stage = LANE_FREE;
+
+    for (;;)
+        {
+        cnt = 0;
+        for (l=0;l<SKEIN_512_LANES;l++)
+            {
+            if (lane[l].stage == LANE_FREE)     /* refill the lane */
+                {
+                if (next == n)
+                    continue;
+                lane[l].ctx     = iv;
+                lane[l].msg     = msg[next];
+                lane[l].left    = msgByteCnt[next];
+                lane[l].hashVal = hashVal[next];
+                lane[l].stage   = LANE_MSG;
+                next++;
+                }
+            c[cnt] = &lane[l].ctx;
+            switch (lane[l].stage)
+                {
+                case LANE_MSG:
+                    if (lane[l].left > SKEIN_512_BLOCK_BYTES)
+                        {                       /* as Update(): straight from the message */
+                        b[cnt] = lane[l].msg;
+                        a[cnt] = SKEIN_512_BLOCK_BYTES;
+                        lane[l].msg  += SKEIN_512_BLOCK_BYTES;
+                        lane[l].left -= SKEIN_512_BLOCK_BYTES;
+                        }
+                    else
+                        {                       /* as Final(): the zero-padded last block */
+                        memcpy(lane[l].ctx.b,lane[l].msg,lane[l].left);
+                        memset(&lane[l].ctx.b[lane[l].left],0,SKEIN_512_BLOCK_BYTES - lane[l].left);
+                        lane[l].ctx.h.T[1] |= SKEIN_T1_FLAG_FINAL;
+                        b[cnt] = lane[l].ctx.b;
+                        a[cnt] = lane[l].left;
+                        lane[l].stage = LANE_FINAL;
+                        }
+                    break;
+                case LANE_FINAL:                /* counter mode, counter 0 */
+                    memset(lane[l].ctx.b,0,sizeof(lane[l].ctx.b));
+                    Skein_Start_New_Type(&lane[l].ctx,OUT_FINAL);
+                    b[cnt] = lane[l].ctx.b;
+                    a[cnt] = sizeof(u64b_t);
+                    lane[l].stage = LANE_OUT;
+                    break;
+                }
+            cnt++;
+            }
+        if (cnt == 0)
+            break;
+
+        Skein_512_Process_Block_Multi(c,b,a,cnt);
+
+        for (l=0;l<SKEIN_512_LANES;l++)
+            if (lane[l].stage == LANE_OUT)
+                {
+                Skein_Put64_LSB_First(lane[l].hashVal,lane[l].ctx.X,(hashBitLen+7) >> 3);
+                lane[l].stage = LANE_FREE;
+                }
+        }
+    return SKEIN_SUCCESS;
+    }
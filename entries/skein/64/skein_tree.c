@@ -0,0 +1,352 @@
+/***********************************************************************
+**
+** Skein tree hashing behind the AHS API.
+**
+** TreeInit() takes the place of Init(); Update() and Final() hand a
+** state set up by it to the functions here.  The message is cut into
+** leaves of (block size << leaf) bytes, each leaf is hashed by UBI from
+** the configured chaining value, and their results are hashed in nodes
+** of (block size << node) bytes, level by level, until one block is
+** left or level maxLevel hashes everything that remains.
+**
+** Leaves do not depend on one another, so they are buffered into
+** batches and each batch is split over one thread per processor.  The
+** nodes above them are hashed on the calling thread as results arrive.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "skein.h"
+#include "SHA3api_ref.h"
+
+#define SKEIN_TREE_MAX_LEAF    (16)  /* keeps leaf buffers reasonable  */
+#define SKEIN_TREE_MAX_NODE    (32)
+#define SKEIN_TREE_MAX_LEVEL   (SKEIN_T1_TREE_LVL_MASK >> SKEIN_T1_POS_TREE_LVL)
+#define SKEIN_TREE_MAX_THREADS (32)
+#define SKEIN_TREE_BATCH_BYTES (64*1024) /* leaf data per thread, at least */
+
+struct skein_tree
+    {
+    hashState cfg;                  /* state just after the config block */
+    size_t    blockBytes;           /* state size, in bytes              */
+    size_t    leafBytes;
+    size_t    nodeBytes;
+    int       maxLevel;
+    int       threads;
+    int       bitPad;               /* message ends in a partial byte    */
+    size_t    batchLeaves;          /* leaves buffered before hashing    */
+    size_t    bufCnt;               /* bytes in buf[]                    */
+    u08b_t   *buf;                  /* batchLeaves * leafBytes           */
+    u08b_t   *out;                  /* batchLeaves results               */
+    /* for each level, the node being hashed, how much of it is filled,
+    ** how many results the level has produced, and the latest one */
+    hashState node  [SKEIN_TREE_MAX_LEVEL+1];
+    size_t    fill  [SKEIN_TREE_MAX_LEVEL+1];
+    u64b_t    cnt   [SKEIN_TREE_MAX_LEVEL+1];
+    u08b_t    last  [SKEIN_TREE_MAX_LEVEL+1][SKEIN1024_BLOCK_BYTES];
+    };
+
+typedef struct
+    {
+    const struct skein_tree *tree;
+    const u08b_t *msg;              /* first leaf of the batch           */
+    u64b_t  first;                  /* its index in the message          */
+    size_t  lo,hi;                  /* leaves [lo,hi) for this thread    */
+    size_t  nLeaves;
+    size_t  lastBytes;              /* size of leaf nLeaves-1            */
+    int     lastBitPad;
+    } Skein_Tree_Job_t;
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* start a node at the given level, whose message starts at byte pos */
+static void Skein_Tree_Start(const struct skein_tree *tree,hashState *ctx,u64b_t pos,int level)
+    {
+    *ctx = tree->cfg;
+    ctx->u.h.T[0] = pos;
+    Skein_Set_Tree_Level(ctx->u.h,level);
+    }
+
+static void Skein_Tree_Update(hashState *ctx,const u08b_t *msg,size_t msgByteCnt)
+    {
+    switch ((ctx->statebits >> 8) & 3)
+        {
+        case 2:  Skein_512_Update(&ctx->u.ctx_512,msg,msgByteCnt); break;
+        case 1:  Skein_256_Update(&ctx->u.ctx_256,msg,msgByteCnt); break;
+        default: Skein1024_Update(&ctx->u.ctx1024,msg,msgByteCnt); break;
+        }
+    }
+
+static void Skein_Tree_Final_Pad(hashState *ctx,u08b_t *result)
+    {
+    switch ((ctx->statebits >> 8) & 3)
+        {
+        case 2:  Skein_512_Final_Pad(&ctx->u.ctx_512,result); break;
+        case 1:  Skein_256_Final_Pad(&ctx->u.ctx_256,result); break;
+        default: Skein1024_Final_Pad(&ctx->u.ctx1024,result); break;
+        }
+    }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash this thread's share of a batch of leaves */
+static void *Skein_Tree_Leaves(void *arg)
+    {
+    const Skein_Tree_Job_t   *job  = (const Skein_Tree_Job_t *) arg;
+    const struct skein_tree  *tree = job->tree;
+    hashState ctx;
+    size_t    i,n;
+
+    for (i=job->lo;i<job->hi;i++)
+        {
+        n = (i == job->nLeaves-1) ? job->lastBytes : tree->leafBytes;
+        Skein_Tree_Start(tree,&ctx,(job->first+i)*tree->leafBytes,1);
+        Skein_Tree_Update(&ctx,job->msg+i*tree->leafBytes,n);
+        if (i == job->nLeaves-1 && job->lastBitPad)
+            Skein_Set_Bit_Pad_Flag(ctx.u.h);
+        Skein_Tree_Final_Pad(&ctx,tree->out+i*tree->blockBytes);
+        }
+    return NULL;
+    }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* feed one result of a node at the given level to the level above */
+static void Skein_Tree_Push(struct skein_tree *tree,int level,const u08b_t *result)
+    {
+    u08b_t blk[SKEIN1024_BLOCK_BYTES];
+    int    up = level+1;
+
+    tree->cnt[level]++;
+    memcpy(tree->last[level],result,tree->blockBytes);
+
+    if (tree->fill[up] == 0)                /* first child of a new node */
+        Skein_Tree_Start(tree,&tree->node[up],
+                         (up == tree->maxLevel) ? 0 : tree->cnt[up]*tree->nodeBytes,up);
+    Skein_Tree_Update(&tree->node[up],result,tree->blockBytes);
+    tree->fill[up] += tree->blockBytes;
+
+    /* the top level takes everything; below it, full nodes are done */
+    if (up < tree->maxLevel && tree->fill[up] == tree->nodeBytes)
+        {
+        Skein_Tree_Final_Pad(&tree->node[up],blk);
+        tree->fill[up] = 0;
+        Skein_Tree_Push(tree,up,blk);
+        }
+    }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash nLeaves leaves at msg, the last of them lastBytes long */
+static void Skein_Tree_Batch(struct skein_tree *tree,const u08b_t *msg,size_t nLeaves,
+                             size_t lastBytes,int lastBitPad)
+    {
+    Skein_Tree_Job_t jobs   [SKEIN_TREE_MAX_THREADS];
+    pthread_t        threads[SKEIN_TREE_MAX_THREADS];
+    int              started[SKEIN_TREE_MAX_THREADS];
+    size_t           i;
+    int              t,nThreads;
+
+    nThreads = tree->threads;
+    if ((size_t) nThreads > nLeaves)
+        nThreads = (int) nLeaves;
+
+    for (t=0;t<nThreads;t++)
+        {
+        jobs[t].tree       = tree;
+        jobs[t].msg        = msg;
+        jobs[t].first      = tree->cnt[1];
+        jobs[t].lo         = nLeaves *  t    / nThreads;
+        jobs[t].hi         = nLeaves * (t+1) / nThreads;
+        jobs[t].nLeaves    = nLeaves;
+        jobs[t].lastBytes  = lastBytes;
+        jobs[t].lastBitPad = lastBitPad;
+        /* job 0 runs here, as does any job whose thread can't be made */
+        started[t] = t > 0 &&
+            pthread_create(&threads[t],NULL,Skein_Tree_Leaves,&jobs[t]) == 0;
+        }
+    for (t=0;t<nThreads;t++)
+        if (!started[t])
+            Skein_Tree_Leaves(&jobs[t]);
+    for (t=0;t<nThreads;t++)
+        if (started[t])
+            pthread_join(threads[t],NULL);
+
+    for (i=0;i<nLeaves;i++)
+        Skein_Tree_Push(tree,1,tree->out+i*tree->blockBytes);
+    }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* select the context size and init the context for tree hashing */
+HashReturn TreeInit(hashState *state, int hashbitlen, int leaf, int node, int maxLevel)
+    {
+    struct skein_tree *tree;
+    HashReturn r;
+    long       nCpu;
+
+    Skein_Assert(hashbitlen > 0,BAD_HASHLEN);
+    if (leaf < 1 || leaf > SKEIN_TREE_MAX_LEAF ||
+        node < 1 || node > SKEIN_TREE_MAX_NODE ||
+        maxLevel < 2 || maxLevel > (int) SKEIN_TREE_MAX_LEVEL)
+        return FAIL;
+
+    tree = (struct skein_tree *) calloc(1,sizeof(*tree));
+    if (tree == NULL)
+        return FAIL;
+
+    if (hashbitlen <= SKEIN_256_NIST_MAX_HASHBITS)
+        {
+        tree->cfg.statebits = 64*SKEIN_256_STATE_WORDS;
+        r = Skein_256_InitExt(&tree->cfg.u.ctx_256,(size_t) hashbitlen,
+                              SKEIN_CFG_TREE_INFO(leaf,node,maxLevel),NULL,0);
+        }
+    else if (hashbitlen <= SKEIN_512_NIST_MAX_HASHBITS)
+        {
+        tree->cfg.statebits = 64*SKEIN_512_STATE_WORDS;
+        r = Skein_512_InitExt(&tree->cfg.u.ctx_512,(size_t) hashbitlen,
+                              SKEIN_CFG_TREE_INFO(leaf,node,maxLevel),NULL,0);
+        }
+    else
+        {
+        tree->cfg.statebits = 64*SKEIN1024_STATE_WORDS;
+        r = Skein1024_InitExt(&tree->cfg.u.ctx1024,(size_t) hashbitlen,
+                              SKEIN_CFG_TREE_INFO(leaf,node,maxLevel),NULL,0);
+        }
+
+    nCpu = sysconf(_SC_NPROCESSORS_ONLN);
+    tree->threads     = (nCpu < 1) ? 1 : (nCpu > SKEIN_TREE_MAX_THREADS) ?
+                        SKEIN_TREE_MAX_THREADS : (int) nCpu;
+    tree->blockBytes  = tree->cfg.statebits / 8;
+    tree->leafBytes   = tree->blockBytes << leaf;
+    tree->nodeBytes   = tree->blockBytes << node;
+    tree->maxLevel    = maxLevel;
+    tree->batchLeaves = tree->threads *
+        ((tree->leafBytes < SKEIN_TREE_BATCH_BYTES) ? SKEIN_TREE_BATCH_BYTES / tree->leafBytes : 1);
+    tree->buf = (u08b_t *) malloc(tree->batchLeaves * tree->leafBytes);
+    tree->out = (u08b_t *) malloc(tree->batchLeaves * tree->blockBytes);
+    if (r != SUCCESS || tree->buf == NULL || tree->out == NULL)
+        {
+        free(tree->buf);
+        free(tree->out);
+        free(tree);
+        return (r != SUCCESS) ? r : FAIL;
+        }
+
+    state->statebits = tree->cfg.statebits;
+    state->tree      = tree;
+    return SUCCESS;
+    }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* buffer message bytes, hashing each full batch once more arrive */
+static void Skein_Tree_Append(struct skein_tree *tree,const u08b_t *msg,size_t msgByteCnt)
+    {
+    size_t batchBytes = tree->batchLeaves * tree->leafBytes;
+    size_t n;
+
+    while (msgByteCnt)
+        {
+        if (tree->bufCnt == batchBytes)
+            {
+            Skein_Tree_Batch(tree,tree->buf,tree->batchLeaves,tree->leafBytes,0);
+            tree->bufCnt = 0;
+            }
+        /* hash whole batches straight from the message, keeping the end */
+        while (tree->bufCnt == 0 && msgByteCnt > batchBytes)
+            {
+            Skein_Tree_Batch(tree,msg,tree->batchLeaves,tree->leafBytes,0);
+            msg        += batchBytes;
+            msgByteCnt -= batchBytes;
+            }
+        n = batchBytes - tree->bufCnt;
+        if (n > msgByteCnt)
+            n = msgByteCnt;
+        memcpy(tree->buf+tree->bufCnt,msg,n);
+        tree->bufCnt += n;
+        msg          += n;
+        msgByteCnt   -= n;
+        }
+    }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* process data to be hashed, as Update() does */
+HashReturn TreeUpdate(hashState *state, const BitSequence *data, DataLength databitlen)
+    {
+    struct skein_tree *tree = state->tree;
+    u08b_t b,mask;
+
+    /* only the final Update() call is allowed do partial bytes, else assert an error */
+    Skein_Assert(tree->bitPad == 0 || databitlen == 0, FAIL);
+
+    Skein_Tree_Append(tree,data,databitlen >> 3);
+    if (databitlen & 7)
+        {   /* handle partial final byte */
+        mask = (u08b_t) (1u << (7 - (databitlen & 7)));       /* partial byte bit mask */
+        b    = (u08b_t) ((data[databitlen >> 3] & (0-mask)) | mask); /* apply bit padding */
+        Skein_Tree_Append(tree,&b,1);
+        tree->bitPad = 1;
+        }
+    return SUCCESS;
+    }
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* finish the tree and output the result (hashbitlen bits) */
+HashReturn TreeFinal(hashState *state, BitSequence *hashval)
+    {
+    struct skein_tree *tree = state->tree;
+    u08b_t   blk[SKEIN1024_BLOCK_BYTES];
+    size_t   nLeaves;
+    int      level;
+    hashState ctx;
+
+    /* the leaves still buffered; an empty message is one empty leaf */
+    nLeaves = (tree->bufCnt + tree->leafBytes - 1) / tree->leafBytes;
+    if (nLeaves == 0 && tree->cnt[1] == 0)
+        nLeaves = 1;
+    if (nLeaves)
+        Skein_Tree_Batch(tree,tree->buf,nLeaves,
+                         tree->bufCnt - (nLeaves-1)*tree->leafBytes,tree->bitPad);
+
+    /* climb until a level has one result, or the top level is reached */
+    for (level=1;;level++)
+        {
+        if (level == tree->maxLevel)
+            {
+            Skein_Tree_Final_Pad(&tree->node[level],blk);
+            break;
+            }
+        if (tree->cnt[level] == 1)
+            {
+            memcpy(blk,tree->last[level],tree->blockBytes);
+            break;
+            }
+        if (level+1 < tree->maxLevel && tree->fill[level+1])
+            {   /* finish the last, partly filled node above */
+            Skein_Tree_Final_Pad(&tree->node[level+1],blk);
+            tree->fill[level+1] = 0;
+            Skein_Tree_Push(tree,level+1,blk);
+            }
+        }
+
+    /* the output stage, keyed by the result */
+    ctx = tree->cfg;
+    switch ((ctx.statebits >> 8) & 3)
+        {
+        case 2:  Skein_Get64_LSB_First(ctx.u.ctx_512.X,blk,SKEIN_512_STATE_WORDS);
+                 Skein_512_Output(&ctx.u.ctx_512,hashval);
+                 break;
+        case 1:  Skein_Get64_LSB_First(ctx.u.ctx_256.X,blk,SKEIN_256_STATE_WORDS);
+                 Skein_256_Output(&ctx.u.ctx_256,hashval);
+                 break;
+        default: Skein_Get64_LSB_First(ctx.u.ctx1024.X,blk,SKEIN1024_STATE_WORDS);
+                 Skein1024_Output(&ctx.u.ctx1024,hashval);
+                 break;
+        }
+
+    free(tree->buf);
+    free(tree->out);
+    free(tree);
+    state->tree = NULL;
+    return SUCCESS;
+    }
@@ -27,6 +27,7 @@ typedef u08b_t   BitSequence;               /* bit stream type */
 typedef struct
     {
     uint_t  statebits;                      /* 256, 512, or 1024 */
+    struct skein_tree *tree;                /* tree hashing state, or NULL */
     union
         {
         Skein_Ctxt_Hdr_t h;                 /* common header "overlay" */
@@ -42,6 +43,13 @@ HashReturn Init  (hashState *state, int hashbitlen);
 HashReturn Update(hashState *state, const BitSequence *data, DataLength databitlen);
 HashReturn Final (hashState *state,       BitSequence *hashval);
 
+/* tree hashing (see skein_tree.c): TreeInit() in place of Init(), */
+/* then Update() and Final() as usual.  leaf, node and maxLevel are */
+/* the Skein tree parameters; the others are checked as by Init().  */
+HashReturn TreeInit  (hashState *state, int hashbitlen, int leaf, int node, int maxLevel);
+HashReturn TreeUpdate(hashState *state, const BitSequence *data, DataLength databitlen);
+HashReturn TreeFinal (hashState *state,       BitSequence *hashval);
+
 /* "all-in-one" call */
 HashReturn Hash  (int hashbitlen,   const BitSequence *data, 
                   DataLength databitlen,  BitSequence *hashval);
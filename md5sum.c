@@ -19,6 +19,7 @@
 #include <config.h>
 
 #include <getopt.h>
+#include <pthread.h>
 #include <sys/types.h>
 
 #include "system.h"
@@ -36,11 +37,19 @@
 # include "sha512.h"
 #endif
 #if HASH_ALGO_SHA3_224 || HASH_ALGO_SHA3_256 || HASH_ALGO_SHA3_384 || \
-    HASH_ALGO_SHA3_512
+    HASH_ALGO_SHA3_512 || HASH_ALGO_SHA3
 # include "sha3.h"
+# include "sha3_cache.h"
 #endif
+#include "c-strtod.h"
 #include "error.h"
+#include "full-read.h"
+#include "quote.h"
+#include "stat-time.h"
 #include "stdio--.h"
+#include "xstrndup.h"
+#include "xstrtod.h"
+#include "xstrtol.h"
 
 /* The official name of this program (e.g., no `g' prefix).  */
 #if HASH_ALGO_MD5
@@ -89,6 +98,10 @@
 # define PROGRAM_NAME "sha3_256sum"
 # define DIGEST_TYPE_STRING "SHA3_256"
 # define DIGEST_STREAM sha3_256_stream
+# define DIGEST_MMAP sha3_256_mmap
+# define DIGEST_READ sha3_256_read
+# define DIGEST_BATCH sha3_256_batch
+# define DIGEST_CACHE 1
 # define DIGEST_BITS 256
 # define DIGEST_REFERENCE "None"
 # define DIGEST_ALIGN 4
@@ -96,6 +109,10 @@
 # define PROGRAM_NAME "sha3_224sum"
 # define DIGEST_TYPE_STRING "SHA3_224"
 # define DIGEST_STREAM sha3_224_stream
+# define DIGEST_MMAP sha3_224_mmap
+# define DIGEST_READ sha3_224_read
+# define DIGEST_BATCH sha3_224_batch
+# define DIGEST_CACHE 1
 # define DIGEST_BITS 224
 # define DIGEST_REFERENCE "None"
 # define DIGEST_ALIGN 4
@@ -103,6 +120,10 @@
 # define PROGRAM_NAME "sha3_512sum"
 # define DIGEST_TYPE_STRING "SHA3_512"
 # define DIGEST_STREAM sha3_512_stream
+# define DIGEST_MMAP sha3_512_mmap
+# define DIGEST_READ sha3_512_read
+# define DIGEST_BATCH sha3_512_batch
+# define DIGEST_CACHE 1
 # define DIGEST_BITS 512
 # define DIGEST_REFERENCE "None"
 # define DIGEST_ALIGN 8
@@ -110,16 +131,36 @@
 # define PROGRAM_NAME "sha3_384sum"
 # define DIGEST_TYPE_STRING "SHA3_384"
 # define DIGEST_STREAM sha3_384_stream
+# define DIGEST_MMAP sha3_384_mmap
+# define DIGEST_READ sha3_384_read
+# define DIGEST_BATCH sha3_384_batch
+# define DIGEST_CACHE 1
 # define DIGEST_BITS 384
 # define DIGEST_REFERENCE "None"
 # define DIGEST_ALIGN 8
+#elif HASH_ALGO_SHA3
+/* Every linked-in entry, at any size, selected with --algo.  */
+# define PROGRAM_NAME "sha3sum"
+# define DIGEST_TYPE_STRING digest_type_string
+# define DIGEST_STREAM sha3_stream
+# define DIGEST_MMAP sha3_mmap
+# define DIGEST_READ sha3_read
+# define DIGEST_BATCH sha3_batch
+# define DIGEST_CACHE 1
+# define DIGEST_BITS (sha3_hashes[0].hashbitlen)
+# define DIGEST_BIN_BYTES (SHA3_MAX_HASHES * SHA3_MAX_DIGEST_SIZE)
+# define DIGEST_REFERENCE "None"
+# define DIGEST_ALIGN 8
 
 #else
 # error "Can't decide which hash algorithm to compile."
 #endif
 
 #define DIGEST_HEX_BYTES (DIGEST_BITS / 4)
-#define DIGEST_BIN_BYTES (DIGEST_BITS / 8)
+/* The size of a buffer that can hold every digest computed for a file.  */
+#ifndef DIGEST_BIN_BYTES
+# define DIGEST_BIN_BYTES (DIGEST_BITS / 8)
+#endif
 
 #define AUTHORS \
   proper_name ("Ulrich Drepper"), \
@@ -151,6 +192,64 @@ static bool status_only = false;
    improperly formatted checksum line.  */
 static bool warn = false;
 
+/* With --jobs, the number of files hashed concurrently.  */
+static unsigned long int n_jobs = 1;
+
+#ifdef DIGEST_BATCH
+/* Workers read regular files of up to JOB_BATCH_FILE_MAX bytes whole and
+   hash up to JOB_BATCH_MAX of them in one call to DIGEST_BATCH.  */
+# define JOB_BATCH_MAX SHA3_BATCH_MAX
+# define JOB_BATCH_FILE_MAX (64 * 1024)
+#else
+# define JOB_BATCH_MAX 1
+#endif
+
+/* How many jobs a worker takes from the queue at once: JOB_BATCH_MAX if
+   the selected digest can be batched, otherwise 1.  */
+static size_t job_batch = 1;
+
+#ifdef DIGEST_READ
+/* With --read-ahead, regular files are read ahead of the hashing instead
+   of being mapped.  */
+static bool read_ahead = false;
+#endif
+
+#ifdef DIGEST_CACHE
+/* With --cache, the digests of regular files are looked up here before
+   the files are read, and recorded here once they have been.  */
+static struct sha3_cache *digest_cache;
+
+/* With --xattr, the same is done with an extended attribute of each
+   file.  */
+static bool use_xattr = false;
+
+/* With --cache, the name of the cache file.  */
+static char const *cache_file;
+
+/* With --cache or --xattr, the name of the selected digests there.  */
+static char *cache_algo;
+
+/* With --cache-verify, the fraction of the files found in the cache or
+   their attributes that are hashed again anyway, and the seed choosing
+   which.  */
+static double cache_verify = 0;
+static uint64_t cache_verify_seed;
+#endif
+
+/* True if a file hashed again for --cache-verify did not match the digest
+   cached for it.  */
+static bool cache_stale_seen;
+
+#if HASH_ALGO_SHA3
+/* The tag of BSD-style checksum lines for the selected digest size,
+   e.g. "SHA3_512".  */
+static char digest_type_string[sizeof "SHA3_512"];
+
+/* With --impl, the build of every entry to use, including those selected
+   by --check for the lines tagged with them.  */
+static char const *algo_type;
+#endif
+
 /* The name this program was run with.  */
 char *program_name;
 
@@ -158,16 +257,59 @@ char *program_name;
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
 {
-  STATUS_OPTION = CHAR_MAX + 1
+  STATUS_OPTION = CHAR_MAX + 1,
+  JOBS_OPTION,
+  ALGO_OPTION,
+  IMPL_OPTION,
+  SKEIN_TREE_OPTION,
+  VARIANT_OPTION,
+  READ_AHEAD_OPTION,
+  DIRECT_OPTION,
+  READ_SIZE_OPTION,
+  CACHE_OPTION,
+  CACHE_VERIFY_OPTION,
+  XATTR_OPTION,
+  ONE_FILE_SYSTEM_OPTION,
+  SKIP_SPECIAL_OPTION
 };
 
 static const struct option long_options[] =
 {
+#if HASH_ALGO_SHA3
+  { "algo", required_argument, NULL, ALGO_OPTION },
+#endif
   { "binary", no_argument, NULL, 'b' },
+#ifdef DIGEST_CACHE
+  { "cache", required_argument, NULL, CACHE_OPTION },
+  { "cache-verify", optional_argument, NULL, CACHE_VERIFY_OPTION },
+#endif
   { "check", no_argument, NULL, 'c' },
+#ifdef DIGEST_READ
+  { "direct", no_argument, NULL, DIRECT_OPTION },
+#endif
+#if HASH_ALGO_SHA3
+  { "impl", required_argument, NULL, IMPL_OPTION },
+#endif
+  { "jobs", required_argument, NULL, JOBS_OPTION },
+  { "one-file-system", no_argument, NULL, ONE_FILE_SYSTEM_OPTION },
+#ifdef DIGEST_READ
+  { "read-ahead", no_argument, NULL, READ_AHEAD_OPTION },
+  { "read-size", required_argument, NULL, READ_SIZE_OPTION },
+#endif
+  { "recursive", no_argument, NULL, 'r' },
+#if HASH_ALGO_SHA3
+  { "skein-tree", required_argument, NULL, SKEIN_TREE_OPTION },
+#endif
+  { "skip-special", no_argument, NULL, SKIP_SPECIAL_OPTION },
   { "status", no_argument, NULL, STATUS_OPTION },
   { "text", no_argument, NULL, 't' },
+#if HASH_ALGO_SHA3
+  { "variant", required_argument, NULL, VARIANT_OPTION },
+#endif
   { "warn", no_argument, NULL, 'w' },
+#ifdef DIGEST_CACHE
+  { "xattr", no_argument, NULL, XATTR_OPTION },
+#endif
   { GETOPT_HELP_OPTION_DECL },
   { GETOPT_VERSION_OPTION_DECL },
   { NULL, 0, NULL, 0 }
@@ -190,6 +332,24 @@ With no FILE, or when FILE is -, read standard input.\n\
 	      program_name,
 	      DIGEST_TYPE_STRING,
 	      DIGEST_BITS);
+#if HASH_ALGO_SHA3
+      fputs (_("\
+      --algo=NAME-BITS    use entry NAME with a BITS-bit digest, where BITS\n\
+                          is 224, 256, 384 or 512 (e.g. skein-512); give a\n\
+                          comma-separated list to compute several digests\n\
+                          from one read of each FILE, one tagged line each\n\
+      --impl=TYPE         use the entry's TYPE build (ref, 32 or 64) instead\n\
+                          of the fastest one this CPU can run\n\
+      --skein-tree=LEAF,NODE,LEVELS\n\
+                          use Skein's tree hashing mode, with leaves of\n\
+                          2^LEAF blocks hashed in parallel, nodes of 2^NODE\n\
+                          blocks, and at most LEVELS levels; LEAF is 1 to 16,\n\
+                          NODE 1 to 32 and LEVELS 2 to 127\n\
+      --variant=NAME      use variant NAME of the entry's compression function\n\
+                          (AURORA's 64-bit build: full, shift or share)\n\
+                          instead of timing each at startup\n\
+"), stdout);
+#endif
       if (O_BINARY)
 	fputs (_("\
   -b, --binary            read in binary mode (default unless reading tty stdin)\n\
@@ -201,6 +361,12 @@ With no FILE, or when FILE is -, read standard input.\n\
       printf (_("\
   -c, --check             read %s sums from the FILEs and check them\n"),
 	      DIGEST_TYPE_STRING);
+#if HASH_ALGO_SHA3
+      fputs (_("\
+                          against the first --algo, or, for lines tagged\n\
+                          NAME-BITS, against that digest\n\
+"), stdout);
+#endif
       if (O_BINARY)
 	fputs (_("\
   -t, --text              read in text mode (default if reading tty stdin)\n\
@@ -210,6 +376,42 @@ With no FILE, or when FILE is -, read standard input.\n\
   -t, --text              read in text mode (default)\n\
 "), stdout);
       fputs (_("\
+      --jobs=N            hash up to N files at the same time; output order\n\
+                          is unchanged\n\
+  -r, --recursive         hash the files under each FILE that is a directory,\n\
+                          sorted by name, without following symbolic links\n\
+                          to directories; with --jobs, directories are read\n\
+                          ahead by up to 8 threads\n\
+      --one-file-system   with -r, skip directories on other file systems\n\
+      --skip-special      with -r, skip devices, FIFOs and sockets\n\
+"), stdout);
+#ifdef DIGEST_CACHE
+      fputs (_("\
+      --cache=FILE        look regular files up in the digest cache FILE,\n\
+                          by device, inode, size and times, instead of\n\
+                          reading them, and record the digests of those\n\
+                          that are read; FILE is created if need be\n\
+      --xattr             do the same with an extended attribute of each\n\
+                          file, user.sha3sums.NAME-BITS, holding its digest,\n\
+                          size and modification time\n\
+      --cache-verify[=FRACTION]\n\
+                          with --cache or --xattr, hash again FRACTION\n\
+                          (default 1) of the files found there, and fail\n\
+                          if any digest has changed\n\
+"), stdout);
+#endif
+#ifdef DIGEST_READ
+      fputs (_("\
+      --read-ahead        read regular files several megabytes ahead of the\n\
+                          hashing, through io_uring where the kernel has it,\n\
+                          instead of mapping them into memory\n\
+      --direct            read regular files that way, but with O_DIRECT, or\n\
+                          else dropping them from the page cache once read\n\
+      --read-size=SIZE    when reading ahead, read SIZE bytes at a time\n\
+                          (default 1M; K, M and G suffixes allowed)\n\
+"), stdout);
+#endif
+      fputs (_("\
 \n\
 The following two options are useful only when verifying checksums:\n\
       --status            don't output anything, status code shows success\n\
@@ -225,6 +427,27 @@ should be a former output of this program.  The default mode is to print\n\
 a line with checksum, a character indicating type (`*' for binary, ` ' for\n\
 text), and name for each FILE.\n"),
 	      DIGEST_REFERENCE);
+#ifdef DIGEST_READ
+      fputs (_("\n\
+Regular files are mapped into memory, unless --read-ahead is given; one\n\
+that shrinks while it is mapped is reported as an input/output error.\n\
+"), stdout);
+#endif
+#if HASH_ALGO_SHA3
+      {
+	const struct sha3_algo *const *a;
+
+	fputs (_("\nAvailable entries and builds:"), stdout);
+	for (a = sha3_algos; *a; a++)
+	  {
+	    if (a == sha3_algos || ! STREQ (a[-1]->name, (*a)->name))
+	      printf ("\n  %s:", (*a)->name);
+	    printf (" %s%s", (*a)->type,
+		    sha3_usable (*a) ? "" : _(" (unsupported by this CPU)"));
+	  }
+	putchar ('\n');
+      }
+#endif
       emit_bug_reporting_address ();
     }
 
@@ -273,13 +496,45 @@ bsd_split_3 (char *s, size_t s_len, unsigned char **hex_digest, char **file_name
   return true;
 }
 
+/* If S starts with the tag of a BSD-style checksum line for the selected
+   algorithm, or, in sha3sum, for any entry and size, such as "skein-512",
+   followed by " (", return the length of the tag; otherwise return 0.  */
+
+static size_t
+bsd_tag_length (char const *s)
+{
+  size_t len = strlen (DIGEST_TYPE_STRING);
+
+  if (strncmp (s, DIGEST_TYPE_STRING, len) == 0
+      && strncmp (s + len, " (", 2) == 0)
+    return len;
+
+#if HASH_ALGO_SHA3
+  {
+    char const *dash = NULL;
+
+    for (len = 0; s[len] && !ISWHITE (s[len]) && s[len] != '('; len++)
+      if (s[len] == '-')
+	dash = s + len;
+    if (dash && dash + 1 < s + len
+	&& strspn (dash + 1, "0123456789") == (size_t) (s + len - (dash + 1))
+	&& strncmp (s + len, " (", 2) == 0)
+      return len;
+  }
+#endif
+
+  return 0;
+}
+
 /* Split the string S (of length S_LEN) into three parts:
    a hexadecimal digest, binary flag, and the file name.
-   S is modified.  Return true if successful.  */
+   Point *TAG at the tag of a BSD-style line, null-terminated, or set it
+   to null for any other.  S is modified.  Return true if successful.  */
 
 static bool
 split_3 (char *s, size_t s_len,
-	 unsigned char **hex_digest, int *binary, char **file_name)
+	 unsigned char **hex_digest, int *binary, char **file_name,
+	 char **tag)
 {
   size_t i;
   bool escaped_filename = false;
@@ -289,17 +544,20 @@ split_3 (char *s, size_t s_len,
   while (ISWHITE (s[i]))
     ++i;
 
+  *tag = NULL;
+
   /* Check for BSD-style checksum line. */
-  algo_name_len = strlen (DIGEST_TYPE_STRING);
-  if (strncmp (s + i, DIGEST_TYPE_STRING, algo_name_len) == 0)
+  algo_name_len = bsd_tag_length (s + i);
+  if (algo_name_len)
     {
-      if (strncmp (s + i + algo_name_len, " (", 2) == 0)
-	{
-	  *binary = 0;
-	  return bsd_split_3 (s +      i + algo_name_len + 2,
-			      s_len - (i + algo_name_len + 2),
-			      hex_digest, file_name);
-	}
+      *binary = 0;
+      if (! bsd_split_3 (s +      i + algo_name_len + 2,
+			 s_len - (i + algo_name_len + 2),
+			 hex_digest, file_name))
+	return false;
+      *tag = s + i;
+      s[i + algo_name_len] = '\0';
+      return true;
     }
 
   /* Ignore this line if it is too short.
@@ -380,13 +638,13 @@ split_3 (char *s, size_t s_len,
   return true;
 }
 
-/* Return true if S is a NUL-terminated string of DIGEST_HEX_BYTES hex digits.
+/* Return true if S is a NUL-terminated string of HEX_BYTES hex digits.
    Otherwise, return false.  */
 static bool
-hex_digits (unsigned char const *s)
+hex_digits (unsigned char const *s, size_t hex_bytes)
 {
-  unsigned int i;
-  for (i = 0; i < digest_hex_bytes; i++)
+  size_t i;
+  for (i = 0; i < hex_bytes; i++)
     {
       if (!isxdigit (*s))
         return false;
@@ -395,6 +653,227 @@ hex_digits (unsigned char const *s)
   return *s == '\0';
 }
 
+#if HASH_ALGO_SHA3
+/* Make the entries and digest sizes named by SPECS the ones to compute.
+   SPECS is a comma-separated list of NAME-BITS (e.g. "skein-512"); every
+   file is read once and all of them are computed from it.  Use the build
+   of each entry named TYPE, or the fastest one this CPU can run if TYPE is
+   null.  Exit with a diagnostic if that is not possible.  */
+
+static void
+select_algo (char const *specs, char const *type)
+{
+  char *list = xstrdup (specs);
+  char *spec;
+  char *saveptr;
+  bool first = true;
+
+  for (spec = strtok_r (list, ",", &saveptr); spec;
+       spec = strtok_r (NULL, ",", &saveptr))
+    {
+      char *dash = strrchr (spec, '-');
+      unsigned long int bits;
+      int err;
+
+      if (!dash || xstrtoul (dash + 1, NULL, 10, &bits, "") != LONGINT_OK
+	  || INT_MAX < bits)
+	err = -1;
+      else
+	{
+	  *dash = '\0';
+	  err = (first
+		 ? sha3_select (spec, type, bits)
+		 : sha3_select_also (spec, type, bits));
+	  *dash = '-';
+	}
+
+      if (err == -3)
+	error (EXIT_FAILURE, 0, _("at most %d algorithms can be given"),
+	       SHA3_MAX_HASHES);
+      if (err == -2)
+	error (EXIT_FAILURE, 0, _("%s: no usable build on this CPU"),
+	       quote (spec));
+      if (err != 0 && type)
+	error (EXIT_FAILURE, 0, _("invalid algorithm or build: %s, %s"),
+	       quote_n (0, spec), quote_n (1, type));
+      if (err != 0)
+	error (EXIT_FAILURE, 0, _("invalid algorithm: %s"), quote (spec));
+      first = false;
+    }
+
+  if (first)
+    error (EXIT_FAILURE, 0, _("invalid algorithm: %s"), quote (specs));
+  free (list);
+
+  sprintf (digest_type_string, "SHA3_%d", sha3_hashes[0].hashbitlen);
+}
+
+/* Set the Skein tree hashing parameters from ARG, of the form
+   LEAF,NODE,LEVELS.  Exit with a diagnostic if it is invalid.  */
+
+static void
+parse_skein_tree (char const *arg)
+{
+  unsigned long int v[3];
+  char const *p = arg;
+  char *end;
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      if (xstrtoul (p, &end, 10, &v[i], NULL) != LONGINT_OK
+	  || *end != (i < 2 ? ',' : '\0'))
+	break;
+      p = end + 1;
+    }
+
+  if (i < 3 || v[0] < 1 || 16 < v[0] || v[1] < 1 || 32 < v[1]
+      || v[2] < 2 || 127 < v[2])
+    error (EXIT_FAILURE, 0, _("invalid Skein tree parameters: %s"),
+	   quote (arg));
+
+  sha3_tree.leaf = v[0];
+  sha3_tree.node = v[1];
+  sha3_tree.levels = v[2];
+}
+#endif
+
+#ifdef DIGEST_CACHE
+/* Return the name the selected digests are cached under: each entry, size
+   and build, e.g. "blake-256/64,skein-512/ref", and the tree hashing
+   parameters if any.  The builds of some entries disagree, so a digest
+   found under another build's name is not used.  */
+
+static char *
+cache_algo_name (void)
+{
+  size_t size = sizeof ":tree=,," + 3 * INT_BUFSIZE_BOUND (int);
+  char *name;
+  char *p;
+  size_t i;
+
+  for (i = 0; i < sha3_n_hashes; i++)
+    size += (strlen (sha3_hashes[i].algo->name)
+	     + strlen (sha3_hashes[i].algo->type) + 3 + INT_BUFSIZE_BOUND (int));
+  p = name = xmalloc (size);
+  for (i = 0; i < sha3_n_hashes; i++)
+    p += sprintf (p, "%s%s-%d/%s", i ? "," : "", sha3_hashes[i].algo->name,
+		  sha3_hashes[i].hashbitlen, sha3_hashes[i].algo->type);
+  if (sha3_tree.levels)
+    sprintf (p, ":tree=%d,%d,%d", sha3_tree.leaf, sha3_tree.node,
+	     sha3_tree.levels);
+  return name;
+}
+
+/* The number of bytes of a digest buffer that hold the selected digests.  */
+
+static size_t
+cache_digest_bytes (void)
+{
+  return ((sha3_n_hashes - 1) * SHA3_MAX_DIGEST_SIZE
+	  + sha3_hashes[sha3_n_hashes - 1].hashbitlen / 8);
+}
+
+/* Name the selected digests for --cache and --xattr, and open the --cache
+   file, if any, under that name.  Exit with a diagnostic if it cannot be
+   opened.  */
+
+static void
+cache_open (void)
+{
+  cache_algo = cache_algo_name ();
+
+  if (cache_file)
+    {
+      digest_cache = sha3_cache_open (cache_file, cache_algo);
+      if (! digest_cache && errno == EINVAL)
+	error (EXIT_FAILURE, 0, _("%s: not a checksum cache"),
+	       quote (cache_file));
+      if (! digest_cache)
+	error (EXIT_FAILURE, errno, "%s", quote (cache_file));
+    }
+}
+
+/* Look the file open on FD, whose status is *ST, up in the --cache and
+   then in its --xattr attribute, and if found put its digest in DIGEST,
+   unless that is null, and return true.  A digest found only in the
+   attribute is copied to the cache.  */
+
+static bool
+cache_lookup (int fd, struct stat const *st, unsigned char *digest)
+{
+  size_t bytes = cache_digest_bytes ();
+
+  if (digest_cache && sha3_cache_lookup (digest_cache, st, digest, bytes))
+    return true;
+  if (use_xattr && sha3_xattr_lookup (fd, cache_algo, st, digest, bytes))
+    {
+      if (digest_cache && digest)
+	sha3_cache_store (digest_cache, st, digest, bytes);
+      return true;
+    }
+  return false;
+}
+
+/* Record DIGEST, computed for the file open on FD whose status was *ST
+   before it was read, in the --cache and the file's --xattr attribute;
+   FD may be -1 to leave out the attribute.  Failing to record a digest
+   only costs the next run a read, so it is not reported.  */
+
+static void
+cache_record (int fd, struct stat const *st, unsigned char const *digest)
+{
+  size_t bytes = cache_digest_bytes ();
+
+  if (digest_cache)
+    sha3_cache_store (digest_cache, st, digest, bytes);
+  if (use_xattr && 0 <= fd)
+    sha3_xattr_store (fd, cache_algo, st, digest, bytes);
+}
+
+/* Return true if the file *ST describes, found in the cache, is one of
+   the fraction --cache-verify hashes again.  Which files those are is
+   fixed for a run but differs from one run to the next.  */
+
+static bool
+cache_verify_file (struct stat const *st)
+{
+  uint64_t x = (cache_verify_seed ^ (uint64_t) st->st_ino
+		^ (uint64_t) st->st_dev << 32);
+
+  if (1 <= cache_verify)
+    return true;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return (x >> 11) < cache_verify * 9007199254740992.0;
+}
+
+/* Return true if the file open on FD, which *ST described before it was
+   read, still has the same size and times, so that the digest just
+   computed can be cached against *ST.  */
+
+static bool
+cache_unchanged (int fd, struct stat const *st)
+{
+  struct stat now;
+
+  return (fstat (fd, &now) == 0 && now.st_size == st->st_size
+	  && timespec_cmp (get_stat_mtime (&now), get_stat_mtime (st)) == 0
+	  && timespec_cmp (get_stat_ctime (&now), get_stat_ctime (st)) == 0);
+}
+#endif
+
+/* Warn that the digest --cache-verify computed for FILENAME did not match
+   the cached one: the file changed without its size or times changing.  */
+
+static void
+cache_stale_warning (char const *filename)
+{
+  error (0, 0, _("%s: cached checksum did not match the file"), filename);
+  cache_stale_seen = true;
+}
+
 /* An interface to the function, DIGEST_STREAM.
    Operate on FILENAME (it may be "-").
 
@@ -404,14 +883,28 @@ hex_digits (unsigned char const *s)
    text because it was a terminal.
 
    Put the checksum in *BIN_RESULT, which must be properly aligned.
-   Return true if successful.  */
+   Set *CACHE_STALE if the file was found in the --cache, hashed again
+   for --cache-verify, and did not match.
+   Return true if successful.  Otherwise store the error number that
+   describes the failure in *ERRNUM; nothing is printed, so this may be
+   called from any thread.  */
 
 static bool
-digest_file (const char *filename, int *binary, unsigned char *bin_result)
+digest_file_r (const char *filename, int *binary, unsigned char *bin_result,
+	       bool *cache_stale, int *errnum)
 {
   FILE *fp;
   int err;
   bool is_stdin = STREQ (filename, "-");
+  bool stdin_buffered = is_stdin && have_read_stdin;
+#ifdef DIGEST_CACHE
+  struct stat cache_st;
+  bool cache_use = false;
+  bool cache_hit = false;
+  unsigned char cached[SHA3_CACHE_MAX_DIGEST];
+#endif
+
+  *cache_stale = false;
 
   if (is_stdin)
     {
@@ -430,181 +923,796 @@ digest_file (const char *filename, int *binary, unsigned char *bin_result)
       fp = fopen (filename, (O_BINARY && *binary ? "rb" : "r"));
       if (fp == NULL)
 	{
-	  error (0, errno, "%s", filename);
+	  *errnum = errno;
 	  return false;
 	}
     }
 
-  err = DIGEST_STREAM (fp, bin_result);
+#ifdef DIGEST_CACHE
+  /* A regular file found in the cache or its attribute is not read at
+     all, unless it is to be verified.  */
+  if ((digest_cache || use_xattr) && !is_stdin && (!O_BINARY || *binary)
+      && fstat (fileno (fp), &cache_st) == 0 && S_ISREG (cache_st.st_mode))
+    {
+      cache_use = true;
+      cache_hit = cache_lookup (fileno (fp), &cache_st, cached);
+      if (cache_hit && ! cache_verify_file (&cache_st))
+	{
+	  memcpy (bin_result, cached, cache_digest_bytes ());
+	  if (fclose (fp) != 0)
+	    {
+	      *errnum = errno;
+	      return false;
+	    }
+	  return true;
+	}
+    }
+#endif
+
+#ifdef DIGEST_MMAP
+  /* Regular files are hashed straight out of the page cache, or with
+     --read-ahead read ahead of the hashing.  Pipes, devices and standard
+     input are read ahead by a thread of their own, unless stdio may
+     already hold some of standard input.  Whatever is left, and anything
+     that cannot be mapped or read ahead, goes through the stream
+     interface.  */
+  {
+    struct stat st;
+
+    err = -1;
+    if ((!O_BINARY || *binary) && fstat (fileno (fp), &st) == 0)
+      {
+	if (!is_stdin && S_ISREG (st.st_mode) && !read_ahead)
+	  err = DIGEST_MMAP (fileno (fp), st.st_size, bin_result);
+	else if (!stdin_buffered)
+	  err = DIGEST_READ (fileno (fp), bin_result);
+      }
+  }
+  if (err < 0)
+#endif
+    err = DIGEST_STREAM (fp, bin_result);
   if (err)
     {
-      error (0, errno, "%s", filename);
+      *errnum = errno;
       if (fp != stdin)
 	fclose (fp);
       return false;
     }
 
+#ifdef DIGEST_CACHE
+  if (cache_use && cache_unchanged (fileno (fp), &cache_st))
+    {
+      if (cache_hit)
+	*cache_stale = memcmp (cached, bin_result,
+			       cache_digest_bytes ()) != 0;
+      if (! cache_hit || *cache_stale)
+	cache_record (fileno (fp), &cache_st, bin_result);
+    }
+#endif
+
   if (!is_stdin && fclose (fp) != 0)
     {
-      error (0, errno, "%s", filename);
+      *errnum = errno;
       return false;
     }
 
   return true;
 }
 
+/* Like digest_file_r, but diagnose any failure.  */
+
 static bool
-digest_check (const char *checkfile_name)
+digest_file (const char *filename, int *binary, unsigned char *bin_result)
 {
-  FILE *checkfile_stream;
-  uintmax_t n_properly_formatted_lines = 0;
-  uintmax_t n_mismatched_checksums = 0;
-  uintmax_t n_open_or_read_failures = 0;
-  unsigned char bin_buffer_unaligned[DIGEST_BIN_BYTES + DIGEST_ALIGN];
-  /* Make sure bin_buffer is properly aligned. */
-  unsigned char *bin_buffer = ptr_align (bin_buffer_unaligned, DIGEST_ALIGN);
-  uintmax_t line_number;
-  char *line;
-  size_t line_chars_allocated;
-  bool is_stdin = STREQ (checkfile_name, "-");
+  bool cache_stale;
+  int errnum;
 
-  if (is_stdin)
-    {
-      have_read_stdin = true;
-      checkfile_name = _("standard input");
-      checkfile_stream = stdin;
-    }
-  else
+  if (! digest_file_r (filename, binary, bin_result, &cache_stale, &errnum))
     {
-      checkfile_stream = fopen (checkfile_name, "r");
-      if (checkfile_stream == NULL)
-	{
-	  error (0, errno, "%s", checkfile_name);
-	  return false;
-	}
+      error (0, errnum, "%s", filename);
+      return false;
     }
 
-  line_number = 0;
-  line = NULL;
-  line_chars_allocated = 0;
-  do
-    {
-      char *filename IF_LINT (= NULL);
-      int binary;
-      unsigned char *hex_digest IF_LINT (= NULL);
-      ssize_t line_length;
-
-      ++line_number;
-      if (line_number == 0)
-	error (EXIT_FAILURE, 0, _("%s: too many checksum lines"),
-	       checkfile_name);
-
-      line_length = getline (&line, &line_chars_allocated, checkfile_stream);
-      if (line_length <= 0)
-	break;
+  if (cache_stale)
+    cache_stale_warning (filename);
+  return true;
+}
 
-      /* Ignore comment lines, which begin with a '#' character.  */
-      if (line[0] == '#')
-	continue;
+/* One file to be hashed by the --jobs worker pool.  */
+struct digest_job
+{
+  /* Set by the submitter.  */
+  const char *filename;
+  int binary;
+
+  /* With --check, the checksum line this job was parsed from (FILENAME
+     points into it), its line number, and the expected digest.  A null
+     HEX_DIGEST marks an improperly formatted line; such jobs are never
+     submitted, they only hold the line's place in the output order.  */
+  char *line;
+  size_t line_chars_allocated;
+  uintmax_t line_number;
+  unsigned char *hex_digest;
+
+  /* Which of the selected digests HEX_DIGEST is, and whether FILENAME is
+     also that of the line before, whose digests are then used instead of
+     hashing the file again.  A line tagged with an algorithm that cannot
+     be used has a null HEX_DIGEST, the tag in BAD_TAG, and why in
+     BAD_ALGO.  */
+  size_t hash_index;
+  bool same_file;
+  char const *bad_tag;
+  char const *bad_algo;
+
+  /* Set by the worker before DONE becomes true.  */
+  bool ok;
+  bool cache_stale;
+  int errnum;
+  unsigned char bin_buffer_unaligned[DIGEST_BIN_BYTES + DIGEST_ALIGN];
 
-      /* Remove any trailing newline.  */
-      if (line[line_length - 1] == '\n')
-	line[--line_length] = '\0';
+#ifdef DIGEST_CACHE
+  /* Set by job_read_whole if the digest of the file it read is to be
+     cached against CACHE_ST once it has been computed.  */
+  bool cache_record;
+  struct stat cache_st;
+#endif
 
-      if (! (split_3 (line, line_length, &hex_digest, &binary, &filename)
-	     && ! (is_stdin && STREQ (filename, "-"))
-	     && hex_digits (hex_digest)))
-	{
-	  if (warn)
-	    {
-	      error (0, 0,
-		     _("%s: %" PRIuMAX
-		       ": improperly formatted %s checksum line"),
-		     checkfile_name, line_number,
-		     DIGEST_TYPE_STRING);
-	    }
-	}
-      else
-	{
-	  static const char bin2hex[] = { '0', '1', '2', '3',
-					  '4', '5', '6', '7',
-					  '8', '9', 'a', 'b',
-					  'c', 'd', 'e', 'f' };
-	  bool ok;
+  bool queued;
+  bool done;
+  struct digest_job *next;
+};
 
-	  ++n_properly_formatted_lines;
+/* Jobs that have been submitted but not yet picked up by a worker,
+   and the state shared between the main thread and the workers.
+   All of it is protected by JOB_LOCK.  */
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t job_queued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t job_finished = PTHREAD_COND_INITIALIZER;
+static struct digest_job *job_head;
+static struct digest_job *job_tail;
+static bool jobs_closing;
+static pthread_t *job_workers;
+static size_t n_job_workers;
+
+static unsigned char *
+job_bin_buffer (struct digest_job *job)
+{
+  return ptr_align (job->bin_buffer_unaligned, DIGEST_ALIGN);
+}
 
-	  ok = digest_file (filename, &binary, bin_buffer);
+static void
+job_run (struct digest_job *job)
+{
+  job->ok = digest_file_r (job->filename, &job->binary, job_bin_buffer (job),
+			   &job->cache_stale, &job->errnum);
+}
 
-	  if (!ok)
-	    {
-	      ++n_open_or_read_failures;
-	      if (!status_only)
-		{
-		  printf (_("%s: FAILED open or read\n"), filename);
-		  fflush (stdout);
-		}
-	    }
-	  else
-	    {
-	      size_t digest_bin_bytes = digest_hex_bytes / 2;
-	      size_t cnt;
-	      /* Compare generated binary number with text representation
-		 in check file.  Ignore case of hex digits.  */
-	      for (cnt = 0; cnt < digest_bin_bytes; ++cnt)
-		{
-		  if (tolower (hex_digest[2 * cnt])
-		      != bin2hex[bin_buffer[cnt] >> 4]
-		      || (tolower (hex_digest[2 * cnt + 1])
-			  != (bin2hex[bin_buffer[cnt] & 0xf])))
-		    break;
-		}
-	      if (cnt != digest_bin_bytes)
-		++n_mismatched_checksums;
+/* Mark JOB, taken from the queue by a worker, as hashed.  */
 
-	      if (!status_only)
-		{
-		  printf ("%s: %s\n", filename,
-			  (cnt != digest_bin_bytes ? _("FAILED") : _("OK")));
-		  fflush (stdout);
-		}
-	    }
-	}
-    }
-  while (!feof (checkfile_stream) && !ferror (checkfile_stream));
+static void
+job_finish (struct digest_job *job)
+{
+  pthread_mutex_lock (&job_lock);
+  job->done = true;
+  pthread_cond_broadcast (&job_finished);
+  pthread_mutex_unlock (&job_lock);
+}
 
-  free (line);
+#ifdef DIGEST_BATCH
+/* Read the file JOB names into BUFFER, which has room for
+   JOB_BATCH_FILE_MAX + 1 bytes, and store its size in *LENGTH.  Return
+   true if it was read whole; otherwise, unless JOB->ok has been cleared
+   because the file could not be opened, JOB should be hashed on its own.  */
 
-  if (ferror (checkfile_stream))
+static bool
+job_read_whole (struct digest_job *job, unsigned char *buffer,
+		size_t *length)
+{
+  struct stat st;
+  bool ok;
+  int fd;
+
+  job->ok = true;
+  job->cache_stale = false;
+  if (O_BINARY && !job->binary)
+    return false;
+
+  fd = open (job->filename, O_RDONLY | O_BINARY);
+  if (fd < 0)
     {
-      error (0, 0, _("%s: read error"), checkfile_name);
+      job->ok = false;
+      job->errnum = errno;
       return false;
     }
 
-  if (!is_stdin && fclose (checkfile_stream) != 0)
+  /* One byte more than the largest file read whole shows whether the file
+     grew past it since it was stat'ed.  */
+  ok = (fstat (fd, &st) == 0 && S_ISREG (st.st_mode)
+	&& st.st_size <= JOB_BATCH_FILE_MAX);
+#ifdef DIGEST_CACHE
+  /* A file found in the cache is left to job_run, which won't read it.  */
+  if (ok && (digest_cache || use_xattr) && cache_lookup (fd, &st, NULL))
+    ok = false;
+#endif
+  if (ok)
     {
-      error (0, errno, "%s", checkfile_name);
-      return false;
+      errno = 0;
+      *length = full_read (fd, buffer, JOB_BATCH_FILE_MAX + 1);
+      ok = errno == 0 && *length <= JOB_BATCH_FILE_MAX;
+#ifdef DIGEST_CACHE
+      job->cache_record = (ok && (digest_cache || use_xattr)
+			   && *length == st.st_size
+			   && cache_unchanged (fd, &st));
+      job->cache_st = st;
+#endif
     }
+  return close (fd) == 0 && ok;
+}
 
-  if (n_properly_formatted_lines == 0)
+#ifdef DIGEST_CACHE
+/* Record the digest computed for JOB, whose file job_read_whole read and
+   closed.  The file's attribute is only set if its name still leads to
+   it and it has not changed since.  */
+
+static void
+job_cache_record (struct digest_job *job)
+{
+  int fd = use_xattr ? open (job->filename, O_RDONLY | O_BINARY) : -1;
+  struct stat st;
+
+  if (0 <= fd && ! (fstat (fd, &st) == 0 && SAME_INODE (st, job->cache_st)
+		    && cache_unchanged (fd, &job->cache_st)))
     {
-      /* Warn if no tests are found.  */
-      error (0, 0, _("%s: no properly formatted %s checksum lines found"),
-	     checkfile_name, DIGEST_TYPE_STRING);
+      close (fd);
+      fd = -1;
     }
-  else
+  cache_record (fd, &job->cache_st, job_bin_buffer (job));
+  if (0 <= fd)
+    close (fd);
+}
+#endif
+
+/* Hash the N jobs in BATCH, all taken from the queue by one worker, and
+   mark each as hashed.  Small regular files are read into BUFFER, which
+   has room for N of them, and hashed together; anything else is hashed on
+   its own first.  */
+
+static void
+job_run_batch (struct digest_job **batch, size_t n, unsigned char *buffer)
+{
+  const unsigned char *data[JOB_BATCH_MAX];
+  size_t length[JOB_BATCH_MAX];
+  void *resblock[JOB_BATCH_MAX];
+  struct digest_job *whole[JOB_BATCH_MAX];
+  size_t n_whole = 0;
+  size_t i;
+
+  for (i = 0; i < n; i++)
     {
-      if (!status_only)
-	{
-	  if (n_open_or_read_failures != 0)
-	    error (0, 0,
-		   ngettext ("WARNING: %" PRIuMAX " of %" PRIuMAX
-			     " listed file could not be read",
-			     "WARNING: %" PRIuMAX " of %" PRIuMAX
-			     " listed files could not be read",
-			     select_plural (n_properly_formatted_lines)),
-		   n_open_or_read_failures, n_properly_formatted_lines);
+      struct digest_job *job = batch[i];
+      unsigned char *p = buffer + n_whole * (JOB_BATCH_FILE_MAX + 1);
+
+      if (job_read_whole (job, p, &length[n_whole]))
+	{
+	  data[n_whole] = p;
+	  resblock[n_whole] = job_bin_buffer (job);
+	  whole[n_whole++] = job;
+	}
+      else
+	{
+	  if (job->ok)
+	    job_run (job);
+	  job_finish (job);
+	}
+    }
+
+  if (n_whole && DIGEST_BATCH (data, length, resblock, n_whole) != 0)
+    for (i = 0; i < n_whole; i++)
+      job_run (whole[i]);
+#ifdef DIGEST_CACHE
+  else
+    for (i = 0; i < n_whole; i++)
+      if (whole[i]->cache_record)
+	job_cache_record (whole[i]);
+#endif
+
+  for (i = 0; i < n_whole; i++)
+    job_finish (whole[i]);
+}
+#endif
+
+static void *
+job_worker (void *arg ATTRIBUTE_UNUSED)
+{
+  unsigned char *buffer = NULL;
+  size_t batch_max = 1;
+
+#ifdef DIGEST_BATCH
+  /* Without room for a batch of files, hash them one at a time.  */
+  if (1 < job_batch)
+    buffer = malloc (job_batch * (JOB_BATCH_FILE_MAX + 1));
+  if (buffer)
+    batch_max = job_batch;
+#endif
+
+  for (;;)
+    {
+      struct digest_job *batch[JOB_BATCH_MAX];
+      size_t n = 0;
+
+      /* Take as many of the queued jobs as make a batch, but don't wait
+	 for more to be queued.  */
+      pthread_mutex_lock (&job_lock);
+      while (!job_head && !jobs_closing)
+	pthread_cond_wait (&job_queued, &job_lock);
+      while (job_head && n < batch_max)
+	{
+	  batch[n++] = job_head;
+	  job_head = job_head->next;
+	}
+      if (!job_head)
+	job_tail = NULL;
+      pthread_mutex_unlock (&job_lock);
+
+      if (!n)
+	break;
+
+#ifdef DIGEST_BATCH
+      if (1 < n)
+	{
+	  job_run_batch (batch, n, buffer);
+	  continue;
+	}
+#endif
+      job_run (batch[0]);
+      job_finish (batch[0]);
+    }
+
+  free (buffer);
+  return NULL;
+}
+
+/* Start N worker threads.  */
+
+static void
+jobs_start (size_t n)
+{
+  jobs_closing = false;
+  job_workers = xnmalloc (n, sizeof *job_workers);
+  for (n_job_workers = 0; n_job_workers < n; n_job_workers++)
+    {
+      int err = pthread_create (&job_workers[n_job_workers], NULL,
+				job_worker, NULL);
+      if (err)
+	{
+	  if (n_job_workers == 0)
+	    error (EXIT_FAILURE, err, _("cannot create thread"));
+	  break;
+	}
+    }
+}
+
+/* Let the workers drain the queue, then wait for them to exit.  */
+
+static void
+jobs_stop (void)
+{
+  size_t i;
+
+  pthread_mutex_lock (&job_lock);
+  jobs_closing = true;
+  pthread_cond_broadcast (&job_queued);
+  pthread_mutex_unlock (&job_lock);
+
+  for (i = 0; i < n_job_workers; i++)
+    pthread_join (job_workers[i], NULL);
+  free (job_workers);
+  job_workers = NULL;
+  n_job_workers = 0;
+}
+
+/* Queue JOB for the workers.  Standard input is never queued: reading it
+   is only meaningful in argument order, so job_wait hashes it in the
+   calling thread instead.  The same happens to every job when no workers
+   are running.  */
+
+static void
+job_submit (struct digest_job *job)
+{
+  job->done = false;
+  job->next = NULL;
+  job->queued = n_job_workers != 0 && !STREQ (job->filename, "-");
+
+  if (!job->queued)
+    return;
+
+  pthread_mutex_lock (&job_lock);
+  if (job_tail)
+    job_tail->next = job;
+  else
+    job_head = job;
+  job_tail = job;
+  pthread_cond_signal (&job_queued);
+  pthread_mutex_unlock (&job_lock);
+}
+
+/* Wait until JOB, which was passed to job_submit, has been hashed.  */
+
+static void
+job_wait (struct digest_job *job)
+{
+  if (!job->queued)
+    {
+      job_run (job);
+      return;
+    }
+
+  pthread_mutex_lock (&job_lock);
+  while (!job->done)
+    pthread_cond_wait (&job_finished, &job_lock);
+  pthread_mutex_unlock (&job_lock);
+}
+
+/* The length of the hexadecimal form of selected digest I.  */
+
+static size_t
+check_hex_bytes (size_t i)
+{
+#if HASH_ALGO_SHA3
+  return sha3_hashes[i].hashbitlen / 4;
+#else
+  return digest_hex_bytes;
+#endif
+}
+
+/* Compare the digest computed for JOB with the one from its checksum
+   line.  Ignore case of hex digits.  */
+
+static bool
+job_digest_matches (struct digest_job *job)
+{
+  static const char bin2hex[] = { '0', '1', '2', '3',
+				  '4', '5', '6', '7',
+				  '8', '9', 'a', 'b',
+				  'c', 'd', 'e', 'f' };
+  unsigned char const *hex_digest = job->hex_digest;
+  unsigned char const *bin_buffer
+    = job_bin_buffer (job) + job->hash_index * SHA3_MAX_DIGEST_SIZE;
+  size_t digest_bin_bytes = check_hex_bytes (job->hash_index) / 2;
+  size_t cnt;
+
+  for (cnt = 0; cnt < digest_bin_bytes; ++cnt)
+    {
+      if (tolower (hex_digest[2 * cnt])
+	  != bin2hex[bin_buffer[cnt] >> 4]
+	  || (tolower (hex_digest[2 * cnt + 1])
+	      != (bin2hex[bin_buffer[cnt] & 0xf])))
+	break;
+    }
+  return cnt == digest_bin_bytes;
+}
+
+/* Return the index in sha3_hashes of the digest that a checksum line
+   tagged TAG is checked against: the first for DIGEST_TYPE_STRING, and
+   otherwise the entry and size TAG names, e.g. "skein-512".  One that is
+   not selected yet is selected as well, once the workers have hashed the
+   files already queued; every file is then hashed with it too.  If it
+   cannot be, set *WHY to the reason and return SHA3_MAX_HASHES.  */
+
+static size_t
+check_hash_index (char const *tag, char const **why)
+{
+#if HASH_ALGO_SHA3
+  char *name;
+  char *dash;
+  unsigned long int bits;
+  size_t i;
+  int err;
+
+  if (STREQ (tag, DIGEST_TYPE_STRING))
+    return 0;
+
+  name = xstrdup (tag);
+  dash = strrchr (name, '-');
+  *dash = '\0';
+  if (xstrtoul (dash + 1, NULL, 10, &bits, "") != LONGINT_OK
+      || INT_MAX < bits)
+    bits = 0;
+
+  for (i = 0; i < sha3_n_hashes; i++)
+    if (strcasecmp (name, sha3_hashes[i].algo->name) == 0
+	&& sha3_hashes[i].hashbitlen == bits)
+      break;
+
+  if (i == sha3_n_hashes)
+    {
+      if (1 < n_jobs)
+	jobs_stop ();
+
+      err = sha3_select_also (name, algo_type, bits);
+      if (err == 0 && sha3_tree.levels && ! sha3_hashes[i].algo->init_tree)
+	{
+	  sha3_n_hashes--;
+	  *why = _("no tree hashing mode");
+	}
+      else if (err == -3)
+	*why = _("too many algorithms");
+      else if (err == -2)
+	*why = _("no usable build on this CPU");
+      else if (err != 0)
+	*why = (algo_type ? _("invalid algorithm or build")
+		: _("invalid algorithm"));
+      else
+	{
+	  /* DIGEST_BATCH computes the first digest only.  */
+	  job_batch = 1;
+#ifdef DIGEST_CACHE
+	  if (cache_algo)
+	    {
+	      if (digest_cache && sha3_cache_close (digest_cache) != 0)
+		error (EXIT_FAILURE, errno, "%s", quote (cache_file));
+	      free (cache_algo);
+	      cache_open ();
+	    }
+#endif
+	}
+      /* Not selected after all.  */
+      if (i == sha3_n_hashes)
+	i = SHA3_MAX_HASHES;
+
+      if (1 < n_jobs)
+	jobs_start (n_jobs);
+    }
+
+  free (name);
+  return i;
+#else
+  return 0;
+#endif
+}
+
+/* Verify the checksum lines in CHECKFILE_NAME.  Lines are parsed by this
+   thread and, with --jobs, the files they name are hashed by the worker
+   pool while later lines are read.  Results are always reported in the
+   order of the lines, so the output does not depend on --jobs.  */
+
+static bool
+digest_check (const char *checkfile_name)
+{
+  FILE *checkfile_stream;
+  uintmax_t n_properly_formatted_lines = 0;
+  uintmax_t n_mismatched_checksums = 0;
+  uintmax_t n_open_or_read_failures = 0;
+  uintmax_t n_unusable_algorithms = 0;
+  uintmax_t line_number;
+  size_t window = 1 < n_jobs ? n_jobs * 4 * job_batch : 1;
+  struct digest_job *ring;
+  size_t n_submitted;
+  size_t n_reported;
+  size_t i;
+  bool eof;
+  bool is_stdin = STREQ (checkfile_name, "-");
+  char *last_filename = NULL;
+  bool last_ok = false;
+  int last_errnum = 0;
+  unsigned char last_bin_buffer[DIGEST_BIN_BYTES];
+
+  if (is_stdin)
+    {
+      have_read_stdin = true;
+      checkfile_name = _("standard input");
+      checkfile_stream = stdin;
+    }
+  else
+    {
+      checkfile_stream = fopen (checkfile_name, "r");
+      if (checkfile_stream == NULL)
+	{
+	  error (0, errno, "%s", checkfile_name);
+	  return false;
+	}
+    }
+
+  ring = xcalloc (window, sizeof *ring);
+  if (1 < n_jobs)
+    jobs_start (n_jobs);
+
+  line_number = 0;
+  n_submitted = 0;
+  n_reported = 0;
+  eof = false;
+  for (;;)
+    {
+      struct digest_job *job;
+
+      /* Parse ahead until the window of outstanding lines is full.  */
+      while (!eof && n_submitted - n_reported < window)
+	{
+	  char *filename IF_LINT (= NULL);
+	  int binary;
+	  unsigned char *hex_digest IF_LINT (= NULL);
+	  char *tag;
+	  size_t n_hashes = sha3_n_hashes;
+	  ssize_t line_length;
+	  char *line;
+
+	  job = &ring[n_submitted % window];
+
+	  ++line_number;
+	  if (line_number == 0)
+	    error (EXIT_FAILURE, 0, _("%s: too many checksum lines"),
+		   checkfile_name);
+
+	  line_length = getline (&job->line, &job->line_chars_allocated,
+				 checkfile_stream);
+	  if (line_length <= 0)
+	    {
+	      eof = true;
+	      break;
+	    }
+	  line = job->line;
+
+	  /* Ignore comment lines, which begin with a '#' character.  */
+	  if (line[0] == '#')
+	    continue;
+
+	  /* Remove any trailing newline.  */
+	  if (line[line_length - 1] == '\n')
+	    line[--line_length] = '\0';
+
+	  job->line_number = line_number;
+	  job->bad_algo = NULL;
+	  if (! (split_3 (line, line_length, &hex_digest, &binary, &filename,
+			  &tag)
+		 && ! (is_stdin && STREQ (filename, "-"))))
+	    job->hex_digest = NULL;
+	  else
+	    {
+	      job->hash_index = tag ? check_hash_index (tag, &job->bad_algo) : 0;
+	      job->bad_tag = tag;
+
+	      /* The files hashed so far lack a newly selected digest.  */
+	      if (sha3_n_hashes != n_hashes)
+		{
+		  free (last_filename);
+		  last_filename = NULL;
+		}
+
+	      if (job->bad_algo
+		  || ! hex_digits (hex_digest, check_hex_bytes (job->hash_index)))
+		job->hex_digest = NULL;
+	      else
+		{
+		  job->hex_digest = hex_digest;
+		  job->filename = filename;
+		  job->binary = binary;
+
+		  /* The lines --algo writes for the digests of one file
+		     follow each other; read it once for all of them.  */
+		  job->same_file = (last_filename
+				    && STREQ (filename, last_filename));
+		  if (! job->same_file)
+		    {
+		      free (last_filename);
+		      last_filename = xstrdup (filename);
+		      job_submit (job);
+		    }
+		}
+	    }
+	  n_submitted++;
+
+	  if (feof (checkfile_stream) || ferror (checkfile_stream))
+	    eof = true;
+	}
+
+      if (n_reported == n_submitted)
+	break;
+
+      job = &ring[n_reported++ % window];
+
+      if (! job->hex_digest)
+	{
+	  if (job->bad_algo)
+	    {
+	      ++n_unusable_algorithms;
+	      if (!status_only)
+		error (0, 0, _("%s: %" PRIuMAX ": %s: %s"),
+		       checkfile_name, job->line_number, quote (job->bad_tag),
+		       job->bad_algo);
+	    }
+	  else if (warn)
+	    {
+	      error (0, 0,
+		     _("%s: %" PRIuMAX
+		       ": improperly formatted %s checksum line"),
+		     checkfile_name, job->line_number,
+		     DIGEST_TYPE_STRING);
+	    }
+	  continue;
+	}
+
+      ++n_properly_formatted_lines;
+
+      if (job->same_file)
+	{
+	  job->ok = last_ok;
+	  job->errnum = last_errnum;
+	  job->cache_stale = false;
+	  memcpy (job_bin_buffer (job), last_bin_buffer, DIGEST_BIN_BYTES);
+	}
+      else
+	{
+	  job_wait (job);
+	  last_ok = job->ok;
+	  last_errnum = job->errnum;
+	  memcpy (last_bin_buffer, job_bin_buffer (job), DIGEST_BIN_BYTES);
+	}
+
+      if (job->ok && job->cache_stale)
+	cache_stale_warning (job->filename);
+      if (! job->ok)
+	{
+	  error (0, job->errnum, "%s", job->filename);
+	  ++n_open_or_read_failures;
+	  if (!status_only)
+	    {
+	      printf (_("%s: FAILED open or read\n"), job->filename);
+	      fflush (stdout);
+	    }
+	}
+      else
+	{
+	  bool match = job_digest_matches (job);
+
+	  if (!match)
+	    ++n_mismatched_checksums;
+
+	  if (!status_only)
+	    {
+	      printf ("%s: %s\n", job->filename,
+		      (match ? _("OK") : _("FAILED")));
+	      fflush (stdout);
+	    }
+	}
+    }
+
+  if (1 < n_jobs)
+    jobs_stop ();
+  for (i = 0; i < window; i++)
+    free (ring[i].line);
+  free (ring);
+  free (last_filename);
+
+  if (ferror (checkfile_stream))
+    {
+      error (0, 0, _("%s: read error"), checkfile_name);
+      return false;
+    }
+
+  if (!is_stdin && fclose (checkfile_stream) != 0)
+    {
+      error (0, errno, "%s", checkfile_name);
+      return false;
+    }
+
+  if (n_properly_formatted_lines == 0)
+    {
+      /* Warn if no tests are found.  */
+      error (0, 0, _("%s: no properly formatted %s checksum lines found"),
+	     checkfile_name, DIGEST_TYPE_STRING);
+    }
+  else
+    {
+      if (!status_only)
+	{
+	  if (n_open_or_read_failures != 0)
+	    error (0, 0,
+		   ngettext ("WARNING: %" PRIuMAX " of %" PRIuMAX
+			     " listed file could not be read",
+			     "WARNING: %" PRIuMAX " of %" PRIuMAX
+			     " listed files could not be read",
+			     select_plural (n_properly_formatted_lines)),
+		   n_open_or_read_failures, n_properly_formatted_lines);
 
 	  if (n_mismatched_checksums != 0)
 	    {
@@ -618,12 +1726,570 @@ digest_check (const char *checkfile_name)
 			       select_plural (n_computed_checksums)),
 		     n_mismatched_checksums, n_computed_checksums);
 	    }
+
+	  if (n_unusable_algorithms != 0)
+	    error (0, 0,
+		   ngettext ("WARNING: %" PRIuMAX " line names an algorithm"
+			     " that could not be used",
+			     "WARNING: %" PRIuMAX " lines name an algorithm"
+			     " that could not be used",
+			     select_plural (n_unusable_algorithms)),
+		   n_unusable_algorithms);
 	}
     }
 
   return (n_properly_formatted_lines != 0
 	  && n_mismatched_checksums == 0
-	  && n_open_or_read_failures == 0);
+	  && n_open_or_read_failures == 0
+	  && n_unusable_algorithms == 0);
+}
+
+/* Output FILE, translating each NEWLINE byte to the string, "\\n",
+   and each backslash to "\\\\".  */
+
+static void
+print_file_name (char const *file)
+{
+  size_t i;
+
+  for (i = 0; i < strlen (file); ++i)
+    {
+      switch (file[i])
+	{
+	case '\n':
+	  fputs ("\\n", stdout);
+	  break;
+
+	case '\\':
+	  fputs ("\\\\", stdout);
+	  break;
+
+	default:
+	  putchar (file[i]);
+	  break;
+	}
+    }
+}
+
+/* Output the checksum line for FILE, whose digest is in BIN_BUFFER.  */
+
+static void
+print_digest_line (char const *file, int file_is_binary,
+		   unsigned char const *bin_buffer)
+{
+  size_t i;
+
+#if HASH_ALGO_SHA3
+  /* With several digests, print one BSD-style line per digest, tagged
+     with its entry and size, e.g. "skein-512 (FILE) = ...".  Digest J is
+     at J * SHA3_MAX_DIGEST_SIZE in BIN_BUFFER.  */
+  if (1 < sha3_n_hashes)
+    {
+      size_t j;
+
+      for (j = 0; j < sha3_n_hashes; j++)
+	{
+	  unsigned char const *digest = bin_buffer + j * SHA3_MAX_DIGEST_SIZE;
+
+	  if (strchr (file, '\n') || strchr (file, '\\'))
+	    putchar ('\\');
+	  printf ("%s-%d (", sha3_hashes[j].algo->name,
+		  sha3_hashes[j].hashbitlen);
+	  print_file_name (file);
+	  fputs (") = ", stdout);
+	  for (i = 0; i < sha3_hashes[j].hashbitlen / 8; ++i)
+	    printf ("%02x", digest[i]);
+	  putchar ('\n');
+	}
+      return;
+    }
+#endif
+
+  /* Output a leading backslash if the file name contains
+     a newline or backslash.  */
+  if (strchr (file, '\n') || strchr (file, '\\'))
+    putchar ('\\');
+
+  for (i = 0; i < (digest_hex_bytes / 2); ++i)
+    printf ("%02x", bin_buffer[i]);
+
+  putchar (' ');
+  if (file_is_binary)
+    putchar ('*');
+  else
+    putchar (' ');
+
+  print_file_name (file);
+  putchar ('\n');
+}
+
+/* With -r, operands that are directories stand for the regular files and
+   other non-directories under them, in the order of their names compared
+   byte by byte, a directory's files coming where its name sorts.  The
+   main thread goes through the tree in that order, while up to
+   WALK_THREADS_MAX walker threads read the directories it is about to
+   reach, each with its entries sorted.  A directory no walker has taken
+   when the main thread gets to it is read by the main thread.  */
+
+#define WALK_THREADS_MAX 8
+
+/* The most directories walkers read ahead of the main thread.  */
+#define WALK_AHEAD_MAX 256
+
+enum walk_state
+{
+  WALK_UNREAD,
+  WALK_READING,
+  WALK_READ
+};
+
+struct walk_dir;
+
+/* A directory entry other than "." and "..": a file, whose full name is
+   PATH, or a subdirectory DIR.  */
+struct walk_entry
+{
+  char *path;
+  struct walk_dir *dir;
+};
+
+struct walk_dir
+{
+  char *path;
+
+  /* The device of the operand it is under, for --one-file-system.  */
+  dev_t dev;
+
+  /* Set when it is read.  ERRNUM is nonzero if it could not be.  */
+  struct walk_entry *entries;
+  size_t n_entries;
+  int errnum;
+
+  /* Protected by WALK_LOCK.  */
+  enum walk_state state;
+  bool ahead;
+  struct walk_dir *prev;
+  struct walk_dir *next;
+
+  /* The main thread's place in ENTRIES.  */
+  size_t next_entry;
+};
+
+/* With -r, --one-file-system and --skip-special.  */
+static bool recursive = false;
+static bool one_file_system = false;
+static bool skip_special = false;
+
+/* Directories not yet taken by a walker, the last found first, and how
+   many walkers have read that the main thread has not reached.  */
+static pthread_mutex_t walk_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t walk_queued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t walk_finished = PTHREAD_COND_INITIALIZER;
+static struct walk_dir *walk_head;
+static size_t walk_ahead;
+static bool walk_closing;
+static pthread_t walk_threads[WALK_THREADS_MAX];
+static size_t n_walk_threads;
+
+/* The main thread's state: the operands not yet reached, and the
+   directories it is in, the innermost last.  */
+static char **walk_operands;
+static size_t n_walk_operands;
+static struct walk_dir **walk_stack;
+static size_t walk_depth;
+static size_t walk_stack_allocated;
+static bool walk_ok;
+
+static struct walk_dir *
+walk_dir_new (char *path, dev_t dev)
+{
+  struct walk_dir *dir = xzalloc (sizeof *dir);
+
+  dir->path = path;
+  dir->dev = dev;
+  dir->state = WALK_UNREAD;
+  return dir;
+}
+
+/* Return DIR's full name joined with NAME.  */
+
+static char *
+walk_path (struct walk_dir const *dir, char const *name)
+{
+  size_t dir_len = strlen (dir->path);
+  size_t name_len = strlen (name);
+  bool slash = dir_len && dir->path[dir_len - 1] != '/';
+  char *path = xmalloc (dir_len + slash + name_len + 1);
+
+  memcpy (path, dir->path, dir_len);
+  if (slash)
+    path[dir_len] = '/';
+  memcpy (path + dir_len + slash, name, name_len + 1);
+  return path;
+}
+
+static int
+walk_entry_cmp (void const *a, void const *b)
+{
+  struct walk_entry const *x = a;
+  struct walk_entry const *y = b;
+
+  return strcmp (x->path, y->path);
+}
+
+/* What the entry NAME of the directory open on FD, whose type according
+   to readdir is TYPE, is to be taken for: 1 for a directory to descend
+   into, 0 for a file to hash, -1 for something to leave out.  */
+
+static int
+walk_entry_kind (struct walk_dir const *dir, int fd, char const *name,
+		 unsigned char type)
+{
+  struct stat st;
+
+  if (type == DT_REG)
+    return 0;
+  if (type == DT_DIR && !one_file_system)
+    return 1;
+  if (type == DT_UNKNOWN || type == DT_DIR)
+    {
+      if (fstatat (fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+	return type == DT_DIR;
+    }
+  else if (type == DT_LNK)
+    {
+      /* Symbolic links are hashed as what they lead to, but not followed
+	 into directories.  A dangling one is diagnosed when opened.  */
+      if (fstatat (fd, name, &st, 0) != 0)
+	return 0;
+      if (S_ISDIR (st.st_mode))
+	return -1;
+    }
+  else
+    return skip_special ? -1 : 0;
+
+  if (S_ISDIR (st.st_mode))
+    return !one_file_system || st.st_dev == dir->dev ? 1 : -1;
+  if (skip_special && !S_ISREG (st.st_mode))
+    return -1;
+  return 0;
+}
+
+/* Read DIR's entries and sort them.  Nothing shared is touched, so this
+   may be called from any thread.  */
+
+static void
+walk_read_dir (struct walk_dir *dir)
+{
+  struct walk_entry *entries = NULL;
+  size_t n_entries = 0;
+  size_t n_allocated = 0;
+  struct dirent *ent;
+  DIR *dirp;
+  size_t i;
+  int kind;
+  int fd;
+
+  fd = open (dir->path, O_RDONLY | O_DIRECTORY | O_NOCTTY);
+  dirp = 0 <= fd ? fdopendir (fd) : NULL;
+  if (! dirp)
+    {
+      dir->errnum = errno;
+      if (0 <= fd)
+	close (fd);
+      return;
+    }
+
+  /* Names go in PATH until the entries are sorted.  */
+  while ((errno = 0, ent = readdir (dirp)))
+    {
+      if (ent->d_name[0] == '.'
+	  && (ent->d_name[1] == '\0'
+	      || (ent->d_name[1] == '.' && ent->d_name[2] == '\0')))
+	continue;
+      kind = walk_entry_kind (dir, fd, ent->d_name, ent->d_type);
+      if (kind < 0)
+	continue;
+      if (n_entries == n_allocated)
+	entries = x2nrealloc (entries, &n_allocated, sizeof *entries);
+      entries[n_entries].path = xstrdup (ent->d_name);
+      /* Mark subdirectories until they get a walk_dir of their own.  */
+      entries[n_entries].dir = kind ? dir : NULL;
+      n_entries++;
+    }
+  dir->errnum = errno;
+  closedir (dirp);
+
+  qsort (entries, n_entries, sizeof *entries, walk_entry_cmp);
+  for (i = 0; i < n_entries; i++)
+    {
+      char *path = walk_path (dir, entries[i].path);
+
+      free (entries[i].path);
+      if (entries[i].dir)
+	{
+	  entries[i].dir = walk_dir_new (path, dir->dev);
+	  entries[i].path = NULL;
+	}
+      else
+	entries[i].path = path;
+    }
+  dir->entries = entries;
+  dir->n_entries = n_entries;
+}
+
+/* Mark DIR as read and queue its subdirectories for the walkers, the
+   first of them at the head.  WALK_LOCK must be held.  */
+
+static void
+walk_dir_done (struct walk_dir *dir)
+{
+  size_t i;
+
+  dir->state = WALK_READ;
+  for (i = dir->n_entries; i-- != 0; )
+    {
+      struct walk_dir *sub = dir->entries[i].dir;
+
+      if (sub)
+	{
+	  sub->prev = NULL;
+	  sub->next = walk_head;
+	  if (walk_head)
+	    walk_head->prev = sub;
+	  walk_head = sub;
+	}
+    }
+  pthread_cond_broadcast (&walk_queued);
+  pthread_cond_broadcast (&walk_finished);
+}
+
+static void
+walk_unqueue (struct walk_dir *dir)
+{
+  if (dir->prev)
+    dir->prev->next = dir->next;
+  else
+    walk_head = dir->next;
+  if (dir->next)
+    dir->next->prev = dir->prev;
+}
+
+static void *
+walk_worker (void *arg ATTRIBUTE_UNUSED)
+{
+  pthread_mutex_lock (&walk_lock);
+  for (;;)
+    {
+      struct walk_dir *dir;
+
+      while (!walk_closing && (!walk_head || WALK_AHEAD_MAX <= walk_ahead))
+	pthread_cond_wait (&walk_queued, &walk_lock);
+      if (walk_closing)
+	break;
+
+      dir = walk_head;
+      walk_unqueue (dir);
+      dir->state = WALK_READING;
+      dir->ahead = true;
+      walk_ahead++;
+      pthread_mutex_unlock (&walk_lock);
+
+      walk_read_dir (dir);
+
+      pthread_mutex_lock (&walk_lock);
+      walk_dir_done (dir);
+    }
+  pthread_mutex_unlock (&walk_lock);
+  return NULL;
+}
+
+/* Wait until DIR, which the main thread has reached, has been read,
+   reading it here if no walker has taken it.  */
+
+static void
+walk_wait (struct walk_dir *dir)
+{
+  pthread_mutex_lock (&walk_lock);
+  if (dir->state == WALK_UNREAD)
+    {
+      if (dir->prev || dir->next || walk_head == dir)
+	walk_unqueue (dir);
+      dir->state = WALK_READING;
+      pthread_mutex_unlock (&walk_lock);
+
+      walk_read_dir (dir);
+
+      pthread_mutex_lock (&walk_lock);
+      walk_dir_done (dir);
+    }
+  while (dir->state != WALK_READ)
+    pthread_cond_wait (&walk_finished, &walk_lock);
+  if (dir->ahead)
+    {
+      walk_ahead--;
+      pthread_cond_signal (&walk_queued);
+    }
+  pthread_mutex_unlock (&walk_lock);
+}
+
+/* Start going through the N_OPERANDS files in OPERANDS, with N_WALKERS
+   walker threads if recursing.  */
+
+static void
+walk_start (char **operands, size_t n_operands, size_t n_walkers)
+{
+  walk_operands = operands;
+  n_walk_operands = n_operands;
+  walk_ok = true;
+  walk_closing = false;
+
+  if (recursive)
+    for (n_walk_threads = 0; n_walk_threads < n_walkers; n_walk_threads++)
+      if (pthread_create (&walk_threads[n_walk_threads], NULL, walk_worker,
+			  NULL))
+	break;
+}
+
+/* Return the name of the next file to hash, to be freed by the caller,
+   or null once there are none left.  Directories that cannot be read are
+   diagnosed here.  */
+
+static char *
+walk_next (void)
+{
+  for (;;)
+    {
+      struct walk_dir *dir;
+      struct walk_entry *e;
+
+      if (walk_depth == 0)
+	{
+	  char *operand;
+	  struct stat st;
+
+	  if (n_walk_operands == 0)
+	    return NULL;
+	  operand = *walk_operands++;
+	  n_walk_operands--;
+	  if (! (recursive && !STREQ (operand, "-")
+		 && stat (operand, &st) == 0 && S_ISDIR (st.st_mode)))
+	    return xstrdup (operand);
+	  dir = walk_dir_new (xstrdup (operand), st.st_dev);
+	}
+      else
+	{
+	  dir = walk_stack[walk_depth - 1];
+	  if (dir->next_entry == dir->n_entries)
+	    {
+	      free (dir->entries);
+	      free (dir->path);
+	      free (dir);
+	      walk_depth--;
+	      continue;
+	    }
+	  e = &dir->entries[dir->next_entry++];
+	  if (! e->dir)
+	    return e->path;
+	  dir = e->dir;
+	}
+
+      walk_wait (dir);
+      if (dir->errnum)
+	{
+	  error (0, dir->errnum, _("cannot read directory %s"),
+		 quote (dir->path));
+	  walk_ok = false;
+	}
+      if (walk_depth == walk_stack_allocated)
+	walk_stack = x2nrealloc (walk_stack, &walk_stack_allocated,
+				 sizeof *walk_stack);
+      walk_stack[walk_depth++] = dir;
+    }
+}
+
+/* Stop the walkers, once walk_next has returned null.  Return true if
+   every directory could be read.  */
+
+static bool
+walk_stop (void)
+{
+  size_t i;
+
+  pthread_mutex_lock (&walk_lock);
+  walk_closing = true;
+  pthread_cond_broadcast (&walk_queued);
+  pthread_mutex_unlock (&walk_lock);
+
+  for (i = 0; i < n_walk_threads; i++)
+    pthread_join (walk_threads[i], NULL);
+  n_walk_threads = 0;
+  free (walk_stack);
+  walk_stack = NULL;
+  walk_stack_allocated = 0;
+  return walk_ok;
+}
+
+/* Hash the files walk_next names with N_THREADS worker threads and print
+   their checksum lines in that order.  At most a few jobs per worker are
+   in flight, so memory use does not grow with the number of files.
+   Return true if every file was hashed.  */
+
+static bool
+digest_files_parallel (size_t n_threads, int binary)
+{
+  size_t window = n_jobs * 4 * job_batch;
+  struct digest_job *ring = xcalloc (window, sizeof *ring);
+  size_t n_submitted = 0;
+  size_t n_output = 0;
+  bool more = true;
+  bool ok = true;
+
+  jobs_start (n_threads);
+
+  for (;;)
+    {
+      struct digest_job *job;
+
+      while (more && n_submitted - n_output < window)
+	{
+	  char *file = walk_next ();
+
+	  if (! file)
+	    {
+	      more = false;
+	      break;
+	    }
+	  job = &ring[n_submitted % window];
+	  job->filename = file;
+	  job->binary = binary;
+	  job_submit (job);
+	  n_submitted++;
+	}
+
+      if (n_output == n_submitted)
+	break;
+      job = &ring[n_output++ % window];
+      job_wait (job);
+
+      if (! job->ok)
+	{
+	  error (0, job->errnum, "%s", job->filename);
+	  ok = false;
+	}
+      else
+	{
+	  if (job->cache_stale)
+	    cache_stale_warning (job->filename);
+	  print_digest_line (job->filename, job->binary,
+			     job_bin_buffer (job));
+	}
+      free ((char *) job->filename);
+    }
+
+  jobs_stop ();
+  free (ring);
+  return ok;
 }
 
 int
@@ -636,6 +2302,10 @@ main (int argc, char **argv)
   int opt;
   bool ok = true;
   int binary = -1;
+#if HASH_ALGO_SHA3
+  char const *algo_spec = SHA3_DEFAULT_ALGO;
+  char const *algo_variant = NULL;
+#endif
 
   /* Setting values of global variables.  */
   initialize_main (&argc, &argv);
@@ -646,15 +2316,86 @@ main (int argc, char **argv)
 
   atexit (close_stdout);
 
-  while ((opt = getopt_long (argc, argv, "bctw", long_options, NULL)) != -1)
+#if HASH_ALGO_SHA3
+  /* --help describes the default.  */
+  select_algo (algo_spec, NULL);
+#endif
+
+  while ((opt = getopt_long (argc, argv, "bcrtw", long_options, NULL)) != -1)
     switch (opt)
       {
+#if HASH_ALGO_SHA3
+      case ALGO_OPTION:
+	algo_spec = optarg;
+	break;
+      case IMPL_OPTION:
+	algo_type = optarg;
+	break;
+      case SKEIN_TREE_OPTION:
+	parse_skein_tree (optarg);
+	break;
+      case VARIANT_OPTION:
+	algo_variant = optarg;
+	break;
+#endif
+#ifdef DIGEST_READ
+      case READ_AHEAD_OPTION:
+	read_ahead = true;
+	break;
+      case DIRECT_OPTION:
+	read_ahead = true;
+	sha3_read_opts.direct = 1;
+	break;
+      case READ_SIZE_OPTION:
+	{
+	  unsigned long int size;
+
+	  if (! (xstrtoul (optarg, NULL, 10, &size, "GKkMm0") == LONGINT_OK
+		 && 0 < size && size <= 1UL << 30))
+	    error (EXIT_FAILURE, 0, _("invalid read size: %s"),
+		   quote (optarg));
+	  sha3_read_opts.size = size;
+	}
+	break;
+#endif
+#ifdef DIGEST_CACHE
+      case CACHE_OPTION:
+	cache_file = optarg;
+	break;
+      case CACHE_VERIFY_OPTION:
+	cache_verify = 1;
+	if (optarg
+	    && ! (xstrtod (optarg, NULL, &cache_verify, c_strtod)
+		  && 0 <= cache_verify && cache_verify <= 1))
+	  error (EXIT_FAILURE, 0, _("invalid fraction: %s"), quote (optarg));
+	break;
+      case XATTR_OPTION:
+	use_xattr = true;
+	break;
+#endif
       case 'b':
 	binary = 1;
 	break;
+      case 'r':
+	recursive = true;
+	break;
+      case ONE_FILE_SYSTEM_OPTION:
+	one_file_system = true;
+	break;
+      case SKIP_SPECIAL_OPTION:
+	skip_special = true;
+	break;
       case 'c':
 	do_check = true;
 	break;
+      case JOBS_OPTION:
+	if (! (xstrtoul (optarg, NULL, 10, &n_jobs, "") == LONGINT_OK
+	       && 0 < n_jobs
+	       && n_jobs <= (SIZE_MAX / 4 / JOB_BATCH_MAX
+			   / sizeof (struct digest_job))))
+	  error (EXIT_FAILURE, 0, _("invalid number of jobs: %s"),
+		 quote (optarg));
+	break;
       case STATUS_OPTION:
 	status_only = true;
 	warn = false;
@@ -672,6 +2413,23 @@ main (int argc, char **argv)
 	usage (EXIT_FAILURE);
       }
 
+#if HASH_ALGO_SHA3
+  select_algo (algo_spec, algo_type);
+  if (sha3_tree.levels)
+    {
+      size_t i;
+
+      for (i = 0; i < sha3_n_hashes; i++)
+	if (! sha3_hashes[i].algo->init_tree)
+	  error (EXIT_FAILURE, 0, _("%s has no tree hashing mode"),
+		 quote (sha3_hashes[i].algo->name));
+    }
+  if (sha3_use_variant (algo_variant) != 0)
+    error (EXIT_FAILURE, 0, _("invalid variant: %s"), quote (algo_variant));
+#else
+  sha3_use_variant (NULL);
+#endif
+
   min_digest_line_length = MIN_DIGEST_LINE_LENGTH;
   digest_hex_bytes = DIGEST_HEX_BYTES;
 
@@ -682,6 +2440,20 @@ main (int argc, char **argv)
       usage (EXIT_FAILURE);
     }
 
+  if (recursive && do_check)
+    {
+      error (0, 0, _("the --recursive option is meaningless when "
+		     "verifying checksums"));
+      usage (EXIT_FAILURE);
+    }
+
+  if ((one_file_system || skip_special) && !recursive)
+    {
+      error (0, 0, _("the --one-file-system and --skip-special options are "
+		     "meaningful only with --recursive"));
+      usage (EXIT_FAILURE);
+    }
+
   if (status_only & !do_check)
     {
       error (0, 0,
@@ -696,68 +2468,71 @@ main (int argc, char **argv)
       usage (EXIT_FAILURE);
     }
 
+#ifdef DIGEST_CACHE
+  if (cache_verify && !cache_file && !use_xattr)
+    {
+      error (0, 0, _("the --cache-verify option is meaningful only with "
+		     "--cache or --xattr"));
+      usage (EXIT_FAILURE);
+    }
+
+  if (cache_file || use_xattr)
+    {
+      cache_open ();
+      cache_verify_seed = ((uint64_t) time (NULL) << 32) ^ getpid ();
+    }
+#endif
+
   if (!O_BINARY && binary < 0)
     binary = 0;
 
   if (optind == argc)
     argv[argc++] = "-";
 
-  for (; optind < argc; ++optind)
-    {
-      char *file = argv[optind];
+#ifdef DIGEST_BATCH
+  /* Files read with O_DIRECT are kept out of the page cache, which reading
+     them whole for a batch would not do.  */
+  if (1 < n_jobs && sha3_can_batch () && !sha3_read_opts.direct)
+    job_batch = JOB_BATCH_MAX;
+#endif
 
-      if (do_check)
-	ok &= digest_check (file);
+  if (do_check)
+    for (; optind < argc; ++optind)
+      ok &= digest_check (argv[optind]);
+  else
+    {
+      size_t n_operands = argc - optind;
+      char *file;
+
+      walk_start (argv + optind, n_operands,
+		  1 < n_jobs ? MIN (n_jobs, WALK_THREADS_MAX) : 0);
+      if (1 < n_jobs)
+	ok = digest_files_parallel (recursive ? n_jobs
+				    : MIN (n_jobs, n_operands), binary);
       else
-	{
-	  int file_is_binary = binary;
-
-	  if (! digest_file (file, &file_is_binary, bin_buffer))
-	    ok = false;
-	  else
-	    {
-	      size_t i;
-
-	      /* Output a leading backslash if the file name contains
-		 a newline or backslash.  */
-	      if (strchr (file, '\n') || strchr (file, '\\'))
-		putchar ('\\');
-
-	      for (i = 0; i < (digest_hex_bytes / 2); ++i)
-		printf ("%02x", bin_buffer[i]);
-
-	      putchar (' ');
-	      if (file_is_binary)
-		putchar ('*');
-	      else
-		putchar (' ');
-
-	      /* Translate each NEWLINE byte to the string, "\\n",
-		 and each backslash to "\\\\".  */
-	      for (i = 0; i < strlen (file); ++i)
-		{
-		  switch (file[i])
-		    {
-		    case '\n':
-		      fputs ("\\n", stdout);
-		      break;
-
-		    case '\\':
-		      fputs ("\\\\", stdout);
-		      break;
+	while ((file = walk_next ()))
+	  {
+	    int file_is_binary = binary;
+
+	    if (! digest_file (file, &file_is_binary, bin_buffer))
+	      ok = false;
+	    else
+	      print_digest_line (file, file_is_binary, bin_buffer);
+	    free (file);
+	  }
+      ok &= walk_stop ();
+    }
 
-		    default:
-		      putchar (file[i]);
-		      break;
-		    }
-		}
-	      putchar ('\n');
-	    }
-	}
+#ifdef DIGEST_CACHE
+  if (digest_cache && sha3_cache_close (digest_cache) != 0)
+    {
+      error (0, errno, "%s", quote (cache_file));
+      ok = false;
     }
+#endif
 
   if (have_read_stdin && fclose (stdin) == EOF)
     error (EXIT_FAILURE, errno, _("standard input"));
 
-  exit (ok ? EXIT_SUCCESS : EXIT_FAILURE);
+  exit (ok && !cache_stale_seen ? EXIT_SUCCESS : EXIT_FAILURE);
 }
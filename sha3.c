@@ -15,28 +15,768 @@
    You should have received a copy of the GNU General Public License
    along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
 
+#include <errno.h>
+#include <signal.h>
 #include <stddef.h>
 #include <stdio.h>
-#include "SHA3api_ref.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "sha3.h"
+#include "sha3_io.h"
 
 #define BUFFER_SIZE 4096
 
+/* When several digests are computed from one stream, the buffers it is
+   read into and how many of them are in use at once.  */
+#define FANOUT_BUFFER_SIZE (64 * 1024)
+#define FANOUT_BUFFERS 4
+
+/* How much of a mapped file is handed to Update at once, unless the entry
+   asks for more.  Large enough that the per-call overhead disappears, small
+   enough that no entry's internal length arithmetic can overflow. */
+#define MMAP_WINDOW_SIZE (1 << 20)
+
+/* How many files can be mapped at once; any more are hashed through the
+   stream interface instead.  */
+#define MAPPED_MAX 64
+
+/* SHA3_ENTRIES is set by the Makefile to SHA3_ENTRY(name, type) for each
+   build of each entry linked into this program.  A fixed build also passes
+   SHA3_ENTRY, naming its entry, for sha3_algo.c.  */
+#undef SHA3_ENTRY
+#define SHA3_ENTRY(name, type) \
+	extern const struct sha3_algo sha3_algo_##name##_##type;
+SHA3_ENTRIES
+#undef SHA3_ENTRY
+
+const struct sha3_algo *const sha3_algos[] = {
+#define SHA3_ENTRY(name, type) &sha3_algo_##name##_##type,
+	SHA3_ENTRIES
+#undef SHA3_ENTRY
+	NULL
+};
+
+#if HASH_ALGO_SHA3
+struct sha3_hash sha3_hashes[SHA3_MAX_HASHES];
+size_t sha3_n_hashes;
+#else
+/* Only the one build named by HASH and TYPE is linked in.  */
+# define SHA3_ENTRY(name, type) &sha3_algo_##name##_##type
+struct sha3_hash sha3_hashes[SHA3_MAX_HASHES] = {
+	{ SHA3_ENTRIES, HASH_ALGO_SHA3_BLOCK_SIZE * 8 }
+};
+# undef SHA3_ENTRY
+size_t sha3_n_hashes = 1;
+#endif
+
+struct sha3_tree sha3_tree;
+struct sha3_read_opts sha3_read_opts;
+
+static unsigned int cpu_features(void)
+{
+	unsigned int f = 0;
+
+#if defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("mmx"))
+		f |= SHA3_CPU_MMX;
+	if(__builtin_cpu_supports("sse2"))
+		f |= SHA3_CPU_SSE2;
+	if(__builtin_cpu_supports("ssse3"))
+		f |= SHA3_CPU_SSSE3;
+	if(__builtin_cpu_supports("sse4.1"))
+		f |= SHA3_CPU_SSE4_1;
+	if(__builtin_cpu_supports("avx"))
+		f |= SHA3_CPU_AVX;
+	if(__builtin_cpu_supports("avx2"))
+		f |= SHA3_CPU_AVX2;
+	if(__builtin_cpu_supports("avx512f"))
+		f |= SHA3_CPU_AVX512F;
+	if(__builtin_cpu_supports("gfni"))
+		f |= SHA3_CPU_GFNI;
+#endif
+
+	return f;
+}
+
+int sha3_usable(const struct sha3_algo *algo)
+{
+	static int probed;
+	static unsigned int features;
+
+	if(!probed) {
+		features = cpu_features();
+		probed = 1;
+	}
+
+	return (algo->cpu_needs & ~features) == 0;
+}
+
+/* How much faster a build of TYPE is expected to be than the others; the
+   entries' 64-bit builds do best where a long holds 64 bits, and their
+   32-bit builds elsewhere.  */
+static int type_rank(const char *type)
+{
+	if(strcmp(type, "64") == 0)
+		return sizeof(long) >= 8 ? 2 : 1;
+	if(strcmp(type, "32") == 0)
+		return sizeof(long) >= 8 ? 1 : 2;
+	return 0;
+}
+
+/* Hash LEN bytes of DATA with ALGO into RESBLOCK.  */
+static int hash_buffer(const struct sha3_algo *algo, int hashbitlen,
+		       const unsigned char *data, size_t len, void *resblock)
+{
+	void *state;
+	int r;
+
+	state = calloc(1, algo->state_size);
+	if(!state)
+		return 1;
+
+	r = algo->init(state, hashbitlen);
+	if(r == 0) {
+		r = algo->update(state, data, (unsigned long long) len * 8);
+		algo->final(state, resblock);
+	}
+
+	free(state);
+
+	return r;
+}
+
+/* Return nonzero if ALGO and REF give the same HASHBITLEN-bit digest for
+   a short message.  Some entries' optimized builds do not agree with their
+   reference build, and automatic selection must not change any digest.  */
+static int agrees(const struct sha3_algo *algo, const struct sha3_algo *ref,
+		  int hashbitlen)
+{
+	unsigned char msg[777];
+	unsigned char a[64], b[64];
+	size_t i;
+
+	for(i = 0; i < sizeof msg; i++)
+		msg[i] = i * 7;
+
+	return hash_buffer(algo, hashbitlen, msg, sizeof msg, a) == 0 &&
+	       hash_buffer(ref, hashbitlen, msg, sizeof msg, b) == 0 &&
+	       memcmp(a, b, hashbitlen / 8) == 0;
+}
+
+/* Find the build of NAME for sha3_select, or return its error code.  */
+static int find(const char *name, const char *type, int hashbitlen,
+		const struct sha3_algo **algo)
+{
+	const struct sha3_algo *const *a;
+	const struct sha3_algo *best = NULL;
+	const struct sha3_algo *ref = NULL;
+	int found = 0;
+	int rank;
+
+	if(hashbitlen != 224 && hashbitlen != 256 &&
+	   hashbitlen != 384 && hashbitlen != 512)
+		return -1;
+
+	for(a = sha3_algos; *a; a++) {
+		if(strcasecmp((*a)->name, name) != 0)
+			continue;
+		if(strcmp((*a)->type, "ref") == 0)
+			ref = *a;
+		if(type && strcmp((*a)->type, type) != 0)
+			continue;
+		found = 1;
+		if(type && sha3_usable(*a))
+			best = *a;
+	}
+
+	/* Without a TYPE, try the builds from the fastest down, and settle
+	   for the reference build if none of the others is usable.  */
+	for(rank = 2; !type && !best && rank >= 0; rank--) {
+		for(a = sha3_algos; *a && !best; a++) {
+			if(strcasecmp((*a)->name, name) == 0 &&
+			   type_rank((*a)->type) == rank && sha3_usable(*a) &&
+			   (!ref || *a == ref || agrees(*a, ref, hashbitlen)))
+				best = *a;
+		}
+	}
+
+	if(!best)
+		return found ? -2 : -1;
+
+	*algo = best;
+	return 0;
+}
+
+int sha3_select(const char *name, const char *type, int hashbitlen)
+{
+	const struct sha3_algo *algo;
+	int r;
+
+	r = find(name, type, hashbitlen, &algo);
+	if(r == 0) {
+		sha3_hashes[0].algo = algo;
+		sha3_hashes[0].hashbitlen = hashbitlen;
+		sha3_n_hashes = 1;
+	}
+
+	return r;
+}
+
+int sha3_select_also(const char *name, const char *type, int hashbitlen)
+{
+	const struct sha3_algo *algo;
+	int r;
+
+	if(sha3_n_hashes == SHA3_MAX_HASHES)
+		return -3;
+
+	r = find(name, type, hashbitlen, &algo);
+	if(r == 0) {
+		sha3_hashes[sha3_n_hashes].algo = algo;
+		sha3_hashes[sha3_n_hashes].hashbitlen = hashbitlen;
+		sha3_n_hashes++;
+	}
+
+	return r;
+}
+
+int sha3_use_variant(const char *name)
+{
+	size_t i, j;
+	int found = 0;
+
+	for(i = 0; i < sha3_n_hashes; i++) {
+		const struct sha3_algo *algo = sha3_hashes[i].algo;
+
+		if(!algo->use_variant)
+			continue;
+		found = 1;
+		/* An entry selected for two digest sizes picks once.  */
+		for(j = 0; j < i && sha3_hashes[j].algo != algo; j++)
+			;
+		if(j == i && algo->use_variant(name) != 0)
+			return -1;
+	}
+
+	return name && !found ? -1 : 0;
+}
+
+/* One of the digests being computed from a file.  */
+struct hasher {
+	const struct sha3_algo *algo;
+	int hashbitlen;
+	void *state;
+	unsigned char *resblock;
+	int r;
+	int threaded;
+	pthread_t thread;
+
+	/* What the thread hashes: the mapped file, or the buffers of a
+	   fanout, of which it has finished CONSUMED.  */
+	const unsigned char *map;
+	size_t length;
+	struct fanout *fanout;
+	unsigned long consumed;
+};
+
+/* The buffers a stream is read into when several hashers share it.  Each
+   is reused once every threaded hasher is done with it.  */
+struct fanout {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	unsigned char *buffer[FANOUT_BUFFERS];
+	size_t length[FANOUT_BUFFERS];
+	size_t pending[FANOUT_BUFFERS];
+	unsigned long produced;
+	int eof;
+};
+
+/* Set up a hasher for each selected digest, writing digest I at
+   I * SHA3_MAX_DIGEST_SIZE in RESBLOCK.  Return null on failure.  */
+static struct hasher *hashers_new(void *resblock)
+{
+	struct hasher *h;
+	size_t i;
+
+	h = calloc(sha3_n_hashes, sizeof *h);
+	if(!h)
+		return NULL;
+
+	for(i = 0; i < sha3_n_hashes; i++) {
+		h[i].algo = sha3_hashes[i].algo;
+		h[i].hashbitlen = sha3_hashes[i].hashbitlen;
+		h[i].resblock = (unsigned char *) resblock
+				+ i * SHA3_MAX_DIGEST_SIZE;
+		h[i].state = calloc(1, h[i].algo->state_size);
+		if(!h[i].state) {
+			while(i--)
+				free(h[i].state);
+			free(h);
+			return NULL;
+		}
+		if(!sha3_tree.levels)
+			h[i].r = h[i].algo->init(h[i].state, h[i].hashbitlen);
+		else if(h[i].algo->init_tree)
+			h[i].r = h[i].algo->init_tree(h[i].state,
+						      h[i].hashbitlen,
+						      sha3_tree.leaf,
+						      sha3_tree.node,
+						      sha3_tree.levels);
+		else
+			h[i].r = 1;
+	}
+
+	return h;
+}
+
+/* Finish every hasher and free them.  Return 0 if all succeeded.  */
+static int hashers_free(struct hasher *h)
+{
+	size_t i;
+	int r = 0;
+
+	for(i = 0; i < sha3_n_hashes; i++) {
+		if(h[i].r == 0)
+			h[i].algo->final(h[i].state, h[i].resblock);
+		else
+			r = 1;
+		free(h[i].state);
+	}
+	free(h);
+
+	return r;
+}
+
+static void hasher_update(struct hasher *h, const unsigned char *data,
+			  size_t len)
+{
+	if(h->r == 0)
+		h->r = h->algo->update(h->state, data,
+				       (unsigned long long) len * 8);
+}
+
+/* Start a thread running FN for each hasher but the first, which the
+   calling thread is left to run.  Hashers whose thread cannot be created
+   are also left to the caller.  */
+static void hashers_start(struct hasher *h, void *(*fn)(void *))
+{
+	size_t i;
+
+	for(i = 1; i < sha3_n_hashes; i++)
+		h[i].threaded = pthread_create(&h[i].thread, NULL,
+					       fn, &h[i]) == 0;
+}
+
+static void hashers_join(struct hasher *h)
+{
+	size_t i;
+
+	for(i = 1; i < sha3_n_hashes; i++)
+		if(h[i].threaded)
+			pthread_join(h[i].thread, NULL);
+}
+
+static void *hash_map(void *arg)
+{
+	struct hasher *h = arg;
+	const unsigned char *p = h->map;
+	size_t left = h->length, chunk;
+	size_t window = h->algo->window ? h->algo->window : MMAP_WINDOW_SIZE;
+
+	while(h->r == 0 && left) {
+		chunk = left < window ? left : window;
+		hasher_update(h, p, chunk);
+		p += chunk;
+		left -= chunk;
+	}
+
+	return NULL;
+}
+
+static void *hash_fanout(void *arg)
+{
+	struct hasher *h = arg;
+	struct fanout *f = h->fanout;
+	size_t slot;
+
+	for(;;) {
+		pthread_mutex_lock(&f->lock);
+		while(h->consumed == f->produced && !f->eof)
+			pthread_cond_wait(&f->cond, &f->lock);
+		if(h->consumed == f->produced) {
+			pthread_mutex_unlock(&f->lock);
+			return NULL;
+		}
+		pthread_mutex_unlock(&f->lock);
+
+		slot = h->consumed % FANOUT_BUFFERS;
+		hasher_update(h, f->buffer[slot], f->length[slot]);
+		h->consumed++;
+
+		pthread_mutex_lock(&f->lock);
+		if(--f->pending[slot] == 0)
+			pthread_cond_broadcast(&f->cond);
+		pthread_mutex_unlock(&f->lock);
+	}
+}
+
+/* Fill BUFFER with up to SIZE bytes from SOURCE, fewer only at its end,
+   and return how many.  On a read error, set *FAILED.  */
+typedef size_t (*fill_fn)(void *source, unsigned char *buffer, size_t size,
+			  int *failed);
+
+static size_t fill_stream(void *source, unsigned char *buffer, size_t size,
+			  int *failed)
+{
+	FILE *stream = source;
+	size_t read = fread(buffer, 1, size, stream);
+
+	if(read < size && ferror(stream))
+		*failed = 1;
+
+	return read;
+}
+
+/* A reader, what is left of the buffer it last returned, and how much it
+   has returned in all.  */
+struct read_source {
+	struct sha3_reader *reader;
+	const unsigned char *data;
+	size_t left;
+	off_t total;
+	int eof;
+};
+
+static size_t fill_reader(void *source, unsigned char *buffer, size_t size,
+			  int *failed)
+{
+	struct read_source *src = source;
+	size_t n, read = 0;
+
+	while(read < size && !src->eof) {
+		if(!src->left) {
+			if(sha3_reader_next(src->reader, &src->data,
+					    &src->left) != 0)
+				*failed = 1;
+			src->eof = *failed || !src->left;
+			src->total += src->left;
+			continue;
+		}
+		n = size - read < src->left ? size - read : src->left;
+		memcpy(buffer + read, src->data, n);
+		src->data += n;
+		src->left -= n;
+		read += n;
+	}
+
+	return read;
+}
+
+/* Read SOURCE once through FILL and hand every buffer to all the hashers:
+   the threaded ones take it from the fanout, the rest are updated here.  */
+static int fanout(fill_fn fill, void *source, struct hasher *h)
+{
+	struct fanout f;
+	size_t i, slot, n_threaded = 0, read;
+	unsigned char *buffers;
+	int r = 0;
+
+	buffers = malloc(FANOUT_BUFFERS * FANOUT_BUFFER_SIZE);
+	if(!buffers)
+		return 1;
+
+	memset(&f, 0, sizeof f);
+	pthread_mutex_init(&f.lock, NULL);
+	pthread_cond_init(&f.cond, NULL);
+	for(i = 0; i < FANOUT_BUFFERS; i++)
+		f.buffer[i] = buffers + i * FANOUT_BUFFER_SIZE;
+	for(i = 0; i < sha3_n_hashes; i++)
+		h[i].fanout = &f;
+
+	hashers_start(h, hash_fanout);
+	for(i = 0; i < sha3_n_hashes; i++)
+		n_threaded += h[i].threaded;
+
+	for(;;) {
+		slot = f.produced % FANOUT_BUFFERS;
+
+		pthread_mutex_lock(&f.lock);
+		while(f.pending[slot])
+			pthread_cond_wait(&f.cond, &f.lock);
+		pthread_mutex_unlock(&f.lock);
+
+		read = fill(source, f.buffer[slot], FANOUT_BUFFER_SIZE, &r);
+		if(!read)
+			break;
+
+		for(i = 0; i < sha3_n_hashes; i++)
+			if(!h[i].threaded)
+				hasher_update(&h[i], f.buffer[slot], read);
+
+		pthread_mutex_lock(&f.lock);
+		f.length[slot] = read;
+		f.pending[slot] = n_threaded;
+		f.produced++;
+		pthread_cond_broadcast(&f.cond);
+		pthread_mutex_unlock(&f.lock);
+	}
+
+	pthread_mutex_lock(&f.lock);
+	f.eof = 1;
+	pthread_cond_broadcast(&f.cond);
+	pthread_mutex_unlock(&f.lock);
+
+	hashers_join(h);
+	pthread_cond_destroy(&f.cond);
+	pthread_mutex_destroy(&f.lock);
+	free(buffers);
+
+	return r;
+}
+
 int sha3_stream(FILE *stream, void *resblock)
 {
 	unsigned char buffer[BUFFER_SIZE];
-	hashState state;
-	HashReturn r;
+	struct hasher *h;
+	int r;
 	size_t read;
 
-	r = Init(&state, HASH_ALGO_SHA3_BLOCK_SIZE * 8);
+	h = hashers_new(resblock);
+	if(!h)
+		return 1;
 
-	if(r == SUCCESS) {
-		while(r == SUCCESS &&
+	if(sha3_n_hashes > 1)
+		r = fanout(fill_stream, stream, h);
+	else {
+		while(h->r == 0 &&
 		      (read = fread(buffer, 1, BUFFER_SIZE, stream)))
-			r = Update(&state, buffer, read * 8);
-		Final(&state, resblock);
+			hasher_update(h, buffer, read);
+		r = ferror(stream) != 0;
 	}
 
-	return r == SUCCESS ? 0 : 1;
+	return hashers_free(h) || r;
+}
+
+/* The files being hashed by sha3_mmap.  A file that shrinks while it is
+   mapped raises SIGBUS on the first page past its new end, on whichever
+   thread touches it, the entries' own threads included; the handler maps
+   zeros over the rest of the mapping so that the hashing can run out, and
+   marks it truncated so that the file is reported as unreadable.  Slots
+   are claimed and read without locks, as the handler must.
+
+   POSIX does not list mmap among the functions a signal handler may call.
+   This relies on Linux, where it is a plain system call that takes no
+   lock the interrupted thread could hold, as it is on the BSDs.  Jumping
+   out of the handler with siglongjmp instead is no option: the fault can
+   be in an entry's own thread, midway through its compression function,
+   where there is nothing to jump back to.  */
+struct mapped {
+	const unsigned char *start;
+	size_t length;
+	int truncated;
+};
+
+static struct mapped mapped[MAPPED_MAX];
+static struct sigaction mapped_old_action;
+static uintptr_t mapped_page_size;
+static pthread_once_t mapped_once = PTHREAD_ONCE_INIT;
+static int mapped_handled;
+
+static void mapped_sigbus(int sig, siginfo_t *info, void *context)
+{
+	uintptr_t addr = (uintptr_t) info->si_addr, start;
+	size_t i, length;
+	int saved_errno = errno;
+
+	(void) context;
+	for(i = 0; i < MAPPED_MAX; i++) {
+		start = (uintptr_t) __atomic_load_n(&mapped[i].start,
+						    __ATOMIC_ACQUIRE);
+		length = __atomic_load_n(&mapped[i].length, __ATOMIC_RELAXED);
+		if(!start || addr < start || addr - start >= length)
+			continue;
+		addr &= ~(mapped_page_size - 1);
+		if(mmap((void *) addr, start + length - addr, PROT_READ,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+			-1, 0) == MAP_FAILED)
+			break;
+		__atomic_store_n(&mapped[i].truncated, 1, __ATOMIC_RELAXED);
+		errno = saved_errno;
+		return;
+	}
+
+	/* Not a mapped file: deliver the signal as if there were no handler.
+	   It stays blocked until the handler returns.  */
+	sigaction(sig, &mapped_old_action, NULL);
+	raise(sig);
+	errno = saved_errno;
+}
+
+static void mapped_install(void)
+{
+	struct sigaction act;
+
+	mapped_page_size = sysconf(_SC_PAGESIZE);
+	memset(&act, 0, sizeof act);
+	act.sa_sigaction = mapped_sigbus;
+	act.sa_flags = SA_SIGINFO;
+	sigemptyset(&act.sa_mask);
+	mapped_handled = sigaction(SIGBUS, &act, &mapped_old_action) == 0;
+}
+
+/* Claim a slot for MAP, LENGTH bytes long; null if none is free.  */
+static struct mapped *mapped_add(const unsigned char *map, size_t length)
+{
+	size_t i, none;
+
+	pthread_once(&mapped_once, mapped_install);
+	if(!mapped_handled)
+		return NULL;
+	for(i = 0; i < MAPPED_MAX; i++) {
+		none = 0;
+		if(__atomic_compare_exchange_n(&mapped[i].length, &none, length,
+					       0, __ATOMIC_ACQUIRE,
+					       __ATOMIC_RELAXED)) {
+			mapped[i].truncated = 0;
+			__atomic_store_n(&mapped[i].start, map,
+					 __ATOMIC_RELEASE);
+			return &mapped[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Release slot M; return nonzero if its file shrank while mapped.  */
+static int mapped_remove(struct mapped *m)
+{
+	int truncated = __atomic_load_n(&m->truncated, __ATOMIC_RELAXED);
+
+	__atomic_store_n(&m->start, NULL, __ATOMIC_RELAXED);
+	__atomic_store_n(&m->length, 0, __ATOMIC_RELEASE);
+
+	return truncated;
+}
+
+int sha3_mmap(int fd, off_t length, void *resblock)
+{
+	const unsigned char *map;
+	struct mapped *m;
+	struct hasher *h;
+	size_t i;
+	int r;
+
+	if(length <= 0 || (uintmax_t) length > SIZE_MAX)
+		return -1;
+
+	map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(map == MAP_FAILED)
+		return -1;
+	m = mapped_add(map, length);
+	if(!m) {
+		munmap((void *) map, length);
+		return -1;
+	}
+	madvise((void *) map, length, MADV_SEQUENTIAL);
+
+	h = hashers_new(resblock);
+	if(!h) {
+		mapped_remove(m);
+		munmap((void *) map, length);
+		return -1;
+	}
+
+	/* Every hasher walks the whole mapping on its own; the file is still
+	   read only once, into the page cache they share.  */
+	for(i = 0; i < sha3_n_hashes; i++) {
+		h[i].map = map;
+		h[i].length = length;
+	}
+	hashers_start(h, hash_map);
+	for(i = 0; i < sha3_n_hashes; i++)
+		if(!h[i].threaded)
+			hash_map(&h[i]);
+	hashers_join(h);
+
+	r = hashers_free(h);
+	if(mapped_remove(m)) {
+		munmap((void *) map, length);
+		errno = EIO;
+		return 1;
+	}
+	munmap((void *) map, length);
+
+	return r;
+}
+
+int sha3_read(int fd, void *resblock)
+{
+	struct read_source src;
+	struct hasher *h;
+	off_t offset;
+	int r = 0;
+
+	/* A file that cannot seek is read sequentially; one that can is read
+	   from where it is, and left where the reading stopped.  */
+	offset = lseek(fd, 0, SEEK_CUR);
+
+	memset(&src, 0, sizeof src);
+	src.reader = sha3_reader_open(fd, offset, sha3_read_opts.size,
+				      sha3_read_opts.direct ?
+				      SHA3_READ_DIRECT : 0);
+	if(!src.reader)
+		return -1;
+
+	h = hashers_new(resblock);
+	if(!h) {
+		sha3_reader_close(src.reader);
+		return -1;
+	}
+
+	/* A single hasher is updated straight from the reader's buffers.  */
+	if(sha3_n_hashes > 1)
+		r = fanout(fill_reader, &src, h);
+	else
+		while(h->r == 0 && !src.eof) {
+			if(sha3_reader_next(src.reader, &src.data,
+					    &src.left) != 0)
+				r = 1;
+			src.eof = r || !src.left;
+			if(!src.eof)
+				hasher_update(h, src.data, src.left);
+			src.total += src.left;
+		}
+
+	sha3_reader_close(src.reader);
+	if(offset >= 0)
+		lseek(fd, offset + src.total, SEEK_SET);
+
+	return hashers_free(h) || r;
+}
+
+int sha3_can_batch(void)
+{
+	return sha3_n_hashes == 1 && !sha3_tree.levels
+		&& sha3_hashes[0].algo->hash_batch
+		&& sha3_hashes[0].algo->batch_lanes(sha3_hashes[0].hashbitlen)
+		   > 1;
+}
+
+int sha3_batch(const unsigned char *const data[], const size_t length[],
+	       void *const resblock[], size_t n)
+{
+	if(!sha3_can_batch() || n > SHA3_BATCH_MAX)
+		return -1;
+
+	return sha3_hashes[0].algo->hash_batch(sha3_hashes[0].hashbitlen,
+					       data, length,
+					       (unsigned char *const *)
+					       resblock, n);
 }
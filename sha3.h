@@ -19,23 +19,130 @@
 #define SHA3_H
 
 #include <stdio.h>
+#include <sys/types.h>
+#include "sha3_algo.h"
 
 #if   HASH_ALGO_SHA3_224
 # define HASH_ALGO_SHA3_BLOCK_SIZE 28
 # define sha3_224_stream sha3_stream
+# define sha3_224_mmap sha3_mmap
+# define sha3_224_read sha3_read
+# define sha3_224_batch sha3_batch
 #elif HASH_ALGO_SHA3_256
 # define HASH_ALGO_SHA3_BLOCK_SIZE 32
 # define sha3_256_stream sha3_stream
+# define sha3_256_mmap sha3_mmap
+# define sha3_256_read sha3_read
+# define sha3_256_batch sha3_batch
 #elif HASH_ALGO_SHA3_384
 # define HASH_ALGO_SHA3_BLOCK_SIZE 48
 # define sha3_384_stream sha3_stream
+# define sha3_384_mmap sha3_mmap
+# define sha3_384_read sha3_read
+# define sha3_384_batch sha3_batch
 #elif HASH_ALGO_SHA3_512
 # define HASH_ALGO_SHA3_BLOCK_SIZE 64
 # define sha3_512_stream sha3_stream
+# define sha3_512_mmap sha3_mmap
+# define sha3_512_read sha3_read
+# define sha3_512_batch sha3_batch
+#elif HASH_ALGO_SHA3
+/* The hash and its size are picked at run time with sha3_select.  */
+# define HASH_ALGO_SHA3_BLOCK_SIZE (sha3_hashes[0].hashbitlen / 8)
 #else
 # error "Can't decide which hash algorithm to compile."
 #endif
 
+/* The builds of the entries linked into this program, terminated by a null
+   pointer.  All builds of one entry are adjacent.  */
+extern const struct sha3_algo *const sha3_algos[];
+
+/* The most digests sha3_stream and sha3_mmap compute from one read of a
+   file, and how far apart they are written to RESBLOCK.  */
+#define SHA3_MAX_HASHES 16
+#define SHA3_MAX_DIGEST_SIZE 64
+
+struct sha3_hash {
+	const struct sha3_algo *algo;
+	int hashbitlen;
+};
+
+/* The entries and digest sizes used by sha3_stream and sha3_mmap.  */
+extern struct sha3_hash sha3_hashes[SHA3_MAX_HASHES];
+extern size_t sha3_n_hashes;
+
+/* The tree hashing parameters every selected entry is to use, if LEVELS is
+   nonzero; they must all have a tree mode.  Zero, for sequential hashing,
+   by default.  */
+struct sha3_tree {
+	int leaf;
+	int node;
+	int levels;
+};
+extern struct sha3_tree sha3_tree;
+
+/* How sha3_read reads: SIZE bytes at a time, a megabyte if zero, and, if
+   DIRECT is nonzero, with O_DIRECT or else dropping each buffer's worth of
+   a regular file from the page cache once it is read.  */
+struct sha3_read_opts {
+	size_t size;
+	int direct;
+};
+extern struct sha3_read_opts sha3_read_opts;
+
+/* Return nonzero if ALGO only uses instructions this CPU has.  The CPU is
+   probed the first time this is called.  */
+int sha3_usable(const struct sha3_algo *algo);
+
+/* Make the entry named NAME, compared without regard to case, and
+   HASHBITLEN bits of output the ones to use.  If TYPE is null, the fastest
+   build of the entry this CPU can run is picked; otherwise it must be the
+   build named TYPE ("ref", "32" or "64").  Returns 0 on success, -1 if no
+   such entry or build is linked in or HASHBITLEN is not 224, 256, 384 or
+   512, and -2 if none of the builds asked for can run on this CPU.  */
+int sha3_select(const char *name, const char *type, int hashbitlen);
+
+/* Like sha3_select, but compute this digest as well as those already
+   selected.  Returns -3 if SHA3_MAX_HASHES are already selected.  */
+int sha3_select_also(const char *name, const char *type, int hashbitlen);
+
+/* Make every selected entry that has several variants of its compression
+   function use the one called NAME, or, if NAME is null, the one a short
+   timing run finds fastest on this machine.  Returns 0 on success, and -1
+   if NAME is not null and either no selected entry has variants or one of
+   those that do has none called NAME.  */
+int sha3_use_variant(const char *name);
+
+/* Hash STREAM with every selected entry.  Here and in sha3_mmap, when
+   there are several each runs in a thread of its own, and digest I is
+   written I * SHA3_MAX_DIGEST_SIZE bytes into RESBLOCK.  */
 int sha3_stream(FILE *stream, void *resblock);
 
+/* Hash the first LENGTH bytes of the regular file open on FD by mapping it
+   into memory instead of copying it through a buffer.  Returns 0 on success,
+   1 on a hashing error or, with errno set to EIO, if the file shrank while
+   it was being hashed, and -1 if the file could not be mapped, in which case
+   nothing has been hashed and the caller should fall back to sha3_stream. */
+int sha3_mmap(int fd, off_t length, void *resblock);
+
+/* Hash what is left of the file open on FD, reading it several buffers
+   ahead of the hashing so that the input and the processor are kept busy at
+   once.  FD may be a pipe or terminal; a file that can seek is left at the
+   offset where reading stopped.  Returns 0 on success, 1 on a read or
+   hashing error, and -1 if reading could not be started, in which case the
+   caller should fall back to sha3_stream.  */
+int sha3_read(int fd, void *resblock);
+
+/* Return nonzero if sha3_batch can hash several files at once: only one
+   digest is selected, not in tree mode, and its build has a hash_batch
+   that puts more than one message of that size through its lanes.  */
+int sha3_can_batch(void);
+
+/* Hash the N whole files DATA[I], LENGTH[I] bytes long, each into
+   RESBLOCK[I], at once.  N is at most SHA3_BATCH_MAX.  Returns 0 on
+   success, 1 on a hashing error, and -1 if sha3_can_batch would return 0,
+   in which case nothing has been hashed.  */
+int sha3_batch(const unsigned char *const data[], const size_t length[],
+	       void *const resblock[], size_t n);
+
 #endif
@@ -0,0 +1,160 @@
+/* Wrap one NIST SHA-3 contest entry in a struct sha3_algo.
+   Written for use with the GNU Coreutils md5sum program.
+   Copyright (C) 2008 Sam Fredrickson <kinghajj@gmail.com>
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* This file is compiled once per entry and TYPE, with that directory on the
+   include path and SHA3_ENTRY and SHA3_TYPE set to their names.  The result
+   is the only global symbol the Makefile keeps from the entry's objects.  */
+
+#include <stddef.h>
+#include "SHA3api_ref.h"
+#include "sha3_algo.h"
+
+#if !defined SHA3_ENTRY || !defined SHA3_TYPE
+# error "SHA3_ENTRY and SHA3_TYPE must name the entry being wrapped."
+#endif
+
+#define SHA3_STRINGIFY_(x) #x
+#define SHA3_STRINGIFY(x) SHA3_STRINGIFY_(x)
+#define SHA3_GLUE_(a, b) a##b
+#define SHA3_GLUE(a, b) SHA3_GLUE_(a, b)
+
+static int algo_init(void *state, int hashbitlen)
+{
+	return Init(state, hashbitlen) == SUCCESS ? 0 : 1;
+}
+
+static int algo_update(void *state, const unsigned char *data,
+		       unsigned long long databitlen)
+{
+#ifdef SHA3_BITLEN_WORDS
+	/* ARIRANG's 32-bit build takes the length as a pointer to two 32-bit
+	   words, least significant first.  */
+	unsigned int words[2];
+
+	words[0] = (unsigned int) databitlen;
+	words[1] = (unsigned int) (databitlen >> 32);
+	return Update(state, data, (void *) words) == SUCCESS ? 0 : 1;
+#else
+	return Update(state, data, databitlen) == SUCCESS ? 0 : 1;
+#endif
+}
+
+static int algo_final(void *state, unsigned char *hashval)
+{
+	return Final(state, hashval) == SUCCESS ? 0 : 1;
+}
+
+#ifdef SHA3_TREE_INIT
+/* Entries with a tree hashing mode name its Init in SHA3_TREE_INIT.  */
+static int algo_init_tree(void *state, int hashbitlen, int leaf, int node,
+			  int levels)
+{
+	return SHA3_TREE_INIT(state, hashbitlen, leaf, node, levels)
+		== SUCCESS ? 0 : 1;
+}
+#endif
+
+#ifdef SHA3_USE_VARIANT
+/* Entries built with several variants of their compression function name
+   the function choosing one in SHA3_USE_VARIANT.  */
+static int algo_use_variant(const char *name)
+{
+	return SHA3_USE_VARIANT(name) == SUCCESS ? 0 : 1;
+}
+#endif
+
+#ifdef SHA3_HASH_BATCH
+/* Entries that hash several messages side by side name the function in
+   SHA3_HASH_BATCH; it takes the arguments of hash_batch.  */
+static int algo_hash_batch(int hashbitlen, const unsigned char *const data[],
+			   const size_t length[],
+			   unsigned char *const hashval[], size_t n)
+{
+	return SHA3_HASH_BATCH(hashbitlen, data, length, hashval, n)
+		== SUCCESS ? 0 : 1;
+}
+
+/* They also name the function telling how many lanes it has for a size
+   in SHA3_BATCH_LANES.  */
+static size_t algo_batch_lanes(int hashbitlen)
+{
+	return SHA3_BATCH_LANES(hashbitlen);
+}
+#endif
+
+const struct sha3_algo
+SHA3_GLUE(SHA3_GLUE(SHA3_GLUE(sha3_algo_, SHA3_ENTRY), _), SHA3_TYPE) = {
+	SHA3_STRINGIFY(SHA3_ENTRY),
+	SHA3_STRINGIFY(SHA3_TYPE),
+	/* The entry was compiled with the same flags as this file, so the
+	   compiler may have used any extension they enable anywhere in it.  */
+	0
+#ifdef __MMX__
+	| SHA3_CPU_MMX
+#endif
+#ifdef __SSE2__
+	| SHA3_CPU_SSE2
+#endif
+#ifdef __SSSE3__
+	| SHA3_CPU_SSSE3
+#endif
+#ifdef __SSE4_1__
+	| SHA3_CPU_SSE4_1
+#endif
+#ifdef __AVX__
+	| SHA3_CPU_AVX
+#endif
+#ifdef __AVX2__
+	| SHA3_CPU_AVX2
+#endif
+#ifdef __AVX512F__
+	| SHA3_CPU_AVX512F
+#endif
+#ifdef __GFNI__
+	| SHA3_CPU_GFNI
+#endif
+	,
+	sizeof(hashState),
+	algo_init,
+	algo_update,
+	algo_final,
+#ifdef SHA3_TREE_INIT
+	algo_init_tree,
+#else
+	NULL,
+#endif
+	/* Entries that hash long updates on several threads ask for larger
+	   windows in SHA3_WINDOW.  */
+#ifdef SHA3_WINDOW
+	SHA3_WINDOW
+#else
+	0
+#endif
+	,
+#ifdef SHA3_HASH_BATCH
+	algo_hash_batch,
+	algo_batch_lanes,
+#else
+	NULL,
+	NULL,
+#endif
+#ifdef SHA3_USE_VARIANT
+	algo_use_variant
+#else
+	NULL
+#endif
+};
@@ -0,0 +1,78 @@
+/* The common interface of the NIST SHA-3 contest entries.
+   Written for use with the GNU Coreutils md5sum program.
+   Copyright (C) 2008 Sam Fredrickson <kinghajj@gmail.com>
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SHA3_ALGO_H
+#define SHA3_ALGO_H
+
+/* This header is included after an entry's SHA3api_ref.h, some of which
+   define the <stdint.h> types themselves, so it must not pull in any
+   system header that does the same.  */
+#include <stddef.h>
+
+/* Instruction set extensions an entry's object may have been compiled to
+   use, from the compiler's predefined macros.  */
+#define SHA3_CPU_MMX	0x01
+#define SHA3_CPU_SSE2	0x02
+#define SHA3_CPU_SSSE3	0x04
+#define SHA3_CPU_SSE4_1	0x08
+#define SHA3_CPU_AVX	0x10
+#define SHA3_CPU_AVX2	0x20
+#define SHA3_CPU_AVX512F	0x40
+#define SHA3_CPU_GFNI	0x80
+
+/* The most messages a hash_batch call is given.  */
+#define SHA3_BATCH_MAX 8
+
+/* The Init/Update/Final triple of one build (TYPE ref, 32 or 64) of one
+   entry.  Every entry exports these under the same global names, so each
+   one is wrapped by sha3_algo.c and only its sha3_algo_<entry>_<type>
+   table is left visible to the linker.  */
+struct sha3_algo {
+	const char *name;
+	const char *type;
+	unsigned int cpu_needs;
+	size_t state_size;
+	int (*init)(void *state, int hashbitlen);
+	int (*update)(void *state, const unsigned char *data,
+		      unsigned long long databitlen);
+	int (*final)(void *state, unsigned char *hashval);
+	/* Like init, but for the entry's tree hashing mode with the given
+	   parameters; null if it has none.  */
+	int (*init_tree)(void *state, int hashbitlen, int leaf, int node,
+			 int levels);
+	/* How much of a mapped file update should be given at once, for
+	   entries that split one call between threads; 0 for the default. */
+	size_t window;
+	/* Hash the N whole messages DATA[I], LENGTH[I] bytes long, into
+	   HASHVAL[I] at once, several to a set of SIMD registers; null if the
+	   entry cannot.  N is at most SHA3_BATCH_MAX.  */
+	int (*hash_batch)(int hashbitlen, const unsigned char *const data[],
+			  const size_t length[], unsigned char *const hashval[],
+			  size_t n);
+	/* How many messages of HASHBITLEN bits hash_batch hashes side by
+	   side in this build: 1 if it can only take them one after another,
+	   as without the vector instructions it needs.  Null if hash_batch
+	   is.  */
+	size_t (*batch_lanes)(int hashbitlen);
+	/* Make the entry use the variant of its compression function called
+	   NAME, or, if NAME is null, the one a short timing run finds fastest
+	   on this machine; nonzero if it has no variant NAME.  Null if the
+	   entry has only one.  Not to be called while hashing.  */
+	int (*use_variant)(const char *name);
+};
+
+#endif
@@ -0,0 +1,623 @@
+/* Remember the digests of files from one run to the next.
+   Written for use with the GNU Coreutils md5sum program.
+   Copyright (C) 2008 Sam Fredrickson <kinghajj@gmail.com>
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* The cache file is a header followed by records, each a struct rec, the
+   algorithm name and the digest, padded to a multiple of 8 bytes.  Both
+   are in the byte order and layout of the machine that wrote them; the
+   header marks which, and a file from another kind of machine is refused.
+   Records are only ever appended, each with one write() while holding a
+   shared flock(), so a later record for the same file and algorithm
+   replaces an earlier one.  A record whose check does not match, such as
+   one still being written, ends the file for whoever reads it.
+
+   The file is read in whole when it is opened and when it is compacted,
+   both under an exclusive flock(), which waits for appends in progress.
+   Compacting writes the records still in use to a new file and renames
+   it over the old one; whoever has the old one open notices once they
+   next take the lock, and opens the new one.
+
+   An extended attribute holds a version byte, then the size and the
+   modification time in nanoseconds, each as 8 bytes, least significant
+   first, then the digest.  Files keep their attributes when copied to
+   another machine, so unlike the cache file its layout is fixed.  */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined __linux__ && defined __has_include
+# if __has_include(<sys/xattr.h>)
+#  include <sys/xattr.h>
+#  define HAVE_XATTR 1
+# endif
+#endif
+
+#include "sha3_cache.h"
+
+#define CACHE_MAGIC "sha3sums"
+#define CACHE_VERSION 1
+#define CACHE_ORDER 0x01020304
+
+/* Compact once at least this many records have been replaced, and they
+   outnumber the records still in use.  */
+#define CACHE_COMPACT_MIN 1024
+
+/* Files changed less than this many nanoseconds ago are not recorded.  */
+#define CACHE_RACY_NS 1000000000LL
+
+#define XATTR_VERSION 1
+#define XATTR_HEAD 17
+#define XATTR_NAME_MAX 255
+
+struct head {
+	char magic[8];
+	uint32_t version;
+	uint32_t order;
+};
+
+struct rec {
+	uint32_t check;		/* of what follows, up to the padding */
+	uint16_t algo_len;
+	uint16_t digest_len;
+	uint64_t dev;
+	uint64_t ino;
+	uint64_t size;
+	int64_t mtime;
+	int64_t ctime;
+};
+
+/* A record appended by this program.  */
+struct node {
+	struct node *next;
+	struct rec rec;
+};
+
+/* The latest record of each file and algorithm, by open addressing.  */
+struct table {
+	const struct rec **slot;
+	size_t size;
+	size_t used;
+	size_t dead;		/* records replaced by later ones */
+	int bad;		/* a record did not check */
+	unsigned char *data;	/* the file as read */
+};
+
+struct sha3_cache {
+	pthread_mutex_t lock;
+	char *path;
+	char *algo;
+	size_t algo_len;
+	int fd;
+	struct table table;
+	struct node *nodes;
+};
+
+static size_t rec_bytes(size_t algo_len, size_t digest_len)
+{
+	return (sizeof(struct rec) + algo_len + digest_len + 7) & ~(size_t)7;
+}
+
+static const char *rec_algo(const struct rec *r)
+{
+	return (const char *)(r + 1);
+}
+
+static const unsigned char *rec_digest(const struct rec *r)
+{
+	return (const unsigned char *)(r + 1) + r->algo_len;
+}
+
+/* FNV-1a of a record but for its check.  */
+static uint32_t rec_check(const struct rec *r)
+{
+	const unsigned char *p = (const unsigned char *)&r->algo_len;
+	const unsigned char *end = rec_digest(r) + r->digest_len;
+	uint32_t h = 2166136261u;
+
+	for(; p < end; p++)
+		h = (h ^ *p) * 16777619u;
+	return h;
+}
+
+static int64_t time_ns(const struct timespec *ts)
+{
+	return (int64_t)ts->tv_sec * 1000000000 + ts->tv_nsec;
+}
+
+static size_t key_hash(uint64_t dev, uint64_t ino, const char *algo,
+		       size_t algo_len)
+{
+	uint64_t h = (ino ^ (dev << 32 | dev >> 32)) * 0x9e3779b97f4a7c15ull;
+	size_t i;
+
+	for(i = 0; i < algo_len; i++)
+		h = (h ^ (unsigned char)algo[i]) * 0x100000001b3ull;
+	return (size_t)(h ^ h >> 29);
+}
+
+/* The slot holding the record for DEV, INO and ALGO, or the empty slot
+   where it would go.  */
+static size_t table_find(const struct table *t, uint64_t dev, uint64_t ino,
+			 const char *algo, size_t algo_len)
+{
+	size_t mask = t->size - 1;
+	size_t i = key_hash(dev, ino, algo, algo_len) & mask;
+	const struct rec *r;
+
+	while((r = t->slot[i]) != NULL) {
+		if(r->dev == dev && r->ino == ino && r->algo_len == algo_len
+		   && memcmp(rec_algo(r), algo, algo_len) == 0)
+			break;
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+static int table_grow(struct table *t)
+{
+	struct table n = *t;
+	size_t i;
+
+	n.size = t->size ? 2 * t->size : 256;
+	n.slot = calloc(n.size, sizeof *n.slot);
+	if(n.slot == NULL)
+		return -1;
+	for(i = 0; i < t->size; i++) {
+		const struct rec *r = t->slot[i];
+		if(r != NULL)
+			n.slot[table_find(&n, r->dev, r->ino, rec_algo(r),
+					  r->algo_len)] = r;
+	}
+	free(t->slot);
+	*t = n;
+	return 0;
+}
+
+static int table_put(struct table *t, const struct rec *r)
+{
+	size_t i;
+
+	if(2 * (t->used + 1) > t->size && table_grow(t))
+		return -1;
+	i = table_find(t, r->dev, r->ino, rec_algo(r), r->algo_len);
+	if(t->slot[i] != NULL)
+		t->dead++;
+	else
+		t->used++;
+	t->slot[i] = r;
+	return 0;
+}
+
+static void table_free(struct table *t)
+{
+	free(t->slot);
+	free(t->data);
+	memset(t, 0, sizeof *t);
+}
+
+/* Read the file FD into T, which must be empty.  An empty file is given a
+   header.  */
+static int table_load(struct table *t, int fd)
+{
+	struct head head;
+	struct stat st;
+	size_t len, off;
+	ssize_t n;
+
+	if(fstat(fd, &st))
+		return -1;
+	if(st.st_size == 0) {
+		memset(&head, 0, sizeof head);
+		memcpy(head.magic, CACHE_MAGIC, sizeof head.magic);
+		head.version = CACHE_VERSION;
+		head.order = CACHE_ORDER;
+		n = write(fd, &head, sizeof head);
+		if(n == (ssize_t)sizeof head)
+			return 0;
+		if(n >= 0)
+			errno = ENOSPC;
+		return -1;
+	}
+	if((uintmax_t)st.st_size > SIZE_MAX - 8) {
+		errno = EFBIG;
+		return -1;
+	}
+
+	/* Room for a struct rec past the end keeps the parsing below from
+	   reading past the buffer.  */
+	len = st.st_size;
+	t->data = malloc(len + sizeof(struct rec));
+	if(t->data == NULL)
+		return -1;
+	for(off = 0; off < len; off += n) {
+		n = pread(fd, t->data + off, len - off, off);
+		if(n < 0 && errno == EINTR)
+			n = 0;
+		else if(n <= 0)
+			break;
+	}
+	if(n < 0)
+		return -1;
+	len = off;
+
+	memcpy(&head, t->data, len < sizeof head ? len : sizeof head);
+	if(len < sizeof head || memcmp(head.magic, CACHE_MAGIC, 8)
+	   || head.version != CACHE_VERSION || head.order != CACHE_ORDER) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for(off = sizeof head; off < len; ) {
+		const struct rec *r = (const struct rec *)(t->data + off);
+		size_t bytes;
+
+		if(len - off < sizeof *r)
+			break;
+		bytes = rec_bytes(r->algo_len, r->digest_len);
+		if(len - off < bytes || rec_check(r) != r->check)
+			break;
+		if(table_put(t, r))
+			return -1;
+		off += bytes;
+	}
+	t->bad = off < len;
+	return 0;
+}
+
+/* Take the flock() OP on the cache file, first opening it again if it has
+   been replaced.  */
+static int cache_lock(struct sha3_cache *c, int op)
+{
+	struct stat fst, pst;
+
+	for(;;) {
+		if(c->fd < 0) {
+			c->fd = open(c->path, O_RDWR | O_CREAT | O_APPEND
+				     | O_CLOEXEC, 0666);
+			if(c->fd < 0)
+				return -1;
+		}
+		while(flock(c->fd, op))
+			if(errno != EINTR)
+				return -1;
+		if(fstat(c->fd, &fst))
+			return -1;
+		if(stat(c->path, &pst) == 0) {
+			if(pst.st_dev == fst.st_dev && pst.st_ino == fst.st_ino)
+				return 0;
+		} else if(errno != ENOENT) {
+			return -1;
+		}
+		close(c->fd);
+		c->fd = -1;
+	}
+}
+
+static void cache_unlock(struct sha3_cache *c)
+{
+	flock(c->fd, LOCK_UN);
+}
+
+static void cache_free(struct sha3_cache *c)
+{
+	while(c->nodes != NULL) {
+		struct node *next = c->nodes->next;
+		free(c->nodes);
+		c->nodes = next;
+	}
+	table_free(&c->table);
+	if(c->fd >= 0)
+		close(c->fd);
+	pthread_mutex_destroy(&c->lock);
+	free(c->algo);
+	free(c->path);
+	free(c);
+}
+
+struct sha3_cache *sha3_cache_open(const char *path, const char *algo)
+{
+	struct sha3_cache *c;
+	int saved;
+
+	c = calloc(1, sizeof *c);
+	if(c == NULL)
+		return NULL;
+	pthread_mutex_init(&c->lock, NULL);
+	c->fd = -1;
+	c->path = strdup(path);
+	c->algo = strdup(algo);
+	c->algo_len = strlen(algo);
+	if(c->path == NULL || c->algo == NULL || c->algo_len > UINT16_MAX) {
+		errno = c->algo_len > UINT16_MAX ? EINVAL : ENOMEM;
+		goto fail;
+	}
+
+	if(cache_lock(c, LOCK_EX))
+		goto fail;
+	if(table_load(&c->table, c->fd)) {
+		cache_unlock(c);
+		goto fail;
+	}
+	cache_unlock(c);
+	return c;
+
+fail:
+	saved = errno;
+	cache_free(c);
+	errno = saved;
+	return NULL;
+}
+
+int sha3_cache_lookup(struct sha3_cache *c, const struct stat *st,
+		      void *digest, size_t len)
+{
+	const struct rec *r;
+	int hit = 0;
+
+	pthread_mutex_lock(&c->lock);
+	if(c->table.size != 0) {
+		r = c->table.slot[table_find(&c->table, st->st_dev, st->st_ino,
+					     c->algo, c->algo_len)];
+		if(r != NULL && r->size == (uint64_t)st->st_size
+		   && r->mtime == time_ns(&st->st_mtim)
+		   && r->ctime == time_ns(&st->st_ctim)
+		   && r->digest_len == len) {
+			if(digest != NULL)
+				memcpy(digest, rec_digest(r), len);
+			hit = 1;
+		}
+	}
+	pthread_mutex_unlock(&c->lock);
+	return hit;
+}
+
+/* Whether a file changed at T changed too recently to be recorded.  */
+static int racy(const struct timespec *t)
+{
+	struct timespec now;
+
+	if(clock_gettime(CLOCK_REALTIME, &now))
+		return 1;
+	return time_ns(t) > time_ns(&now) - CACHE_RACY_NS;
+}
+
+int sha3_cache_store(struct sha3_cache *c, const struct stat *st,
+		     const void *digest, size_t len)
+{
+	struct node *node;
+	struct rec *r;
+	size_t bytes;
+	ssize_t n;
+	int ret = -1;
+
+	if(len > SHA3_CACHE_MAX_DIGEST || racy(&st->st_mtim)
+	   || racy(&st->st_ctim))
+		return 0;
+
+	bytes = rec_bytes(c->algo_len, len);
+	node = calloc(1, offsetof(struct node, rec) + bytes);
+	if(node == NULL)
+		return -1;
+	r = &node->rec;
+	r->algo_len = c->algo_len;
+	r->digest_len = len;
+	r->dev = st->st_dev;
+	r->ino = st->st_ino;
+	r->size = st->st_size;
+	r->mtime = time_ns(&st->st_mtim);
+	r->ctime = time_ns(&st->st_ctim);
+	memcpy((char *)(r + 1), c->algo, c->algo_len);
+	memcpy((char *)(r + 1) + c->algo_len, digest, len);
+	r->check = rec_check(r);
+
+	pthread_mutex_lock(&c->lock);
+	if(cache_lock(c, LOCK_SH) == 0) {
+		n = write(c->fd, r, bytes);
+		if(n == (ssize_t)bytes)
+			ret = 0;
+		else if(n >= 0)
+			errno = ENOSPC;
+		cache_unlock(c);
+	}
+	if(ret == 0 && table_put(&c->table, r))
+		ret = -1;
+	if(ret == 0) {
+		node->next = c->nodes;
+		c->nodes = node;
+	} else {
+		free(node);
+	}
+	pthread_mutex_unlock(&c->lock);
+	return ret;
+}
+
+/* Rewrite the cache file with only its latest records, if it still needs
+   it once read again.  */
+static int cache_compact(struct sha3_cache *c)
+{
+	struct table t;
+	struct head head;
+	struct stat st;
+	unsigned char *buf = NULL;
+	char *tmp = NULL;
+	size_t len, i;
+	int fd = -1, ret = -1;
+
+	memset(&t, 0, sizeof t);
+	if(cache_lock(c, LOCK_EX))
+		return -1;
+	if(table_load(&t, c->fd) || fstat(c->fd, &st))
+		goto done;
+	if(!t.bad && (t.dead < CACHE_COMPACT_MIN || t.dead <= t.used)) {
+		ret = 0;
+		goto done;
+	}
+
+	len = sizeof head;
+	for(i = 0; i < t.size; i++)
+		if(t.slot[i] != NULL)
+			len += rec_bytes(t.slot[i]->algo_len,
+					 t.slot[i]->digest_len);
+	buf = malloc(len);
+	tmp = malloc(strlen(c->path) + sizeof ".XXXXXX");
+	if(buf == NULL || tmp == NULL)
+		goto done;
+	memcpy(&head, t.data, sizeof head);
+	memcpy(buf, &head, sizeof head);
+	len = sizeof head;
+	for(i = 0; i < t.size; i++) {
+		const struct rec *r = t.slot[i];
+		if(r != NULL) {
+			size_t bytes = rec_bytes(r->algo_len, r->digest_len);
+			memcpy(buf + len, r, bytes);
+			len += bytes;
+		}
+	}
+
+	strcat(strcpy(tmp, c->path), ".XXXXXX");
+	fd = mkstemp(tmp);
+	if(fd < 0)
+		goto done;
+	if(fchmod(fd, st.st_mode & 07777) == 0) {
+		ssize_t n = write(fd, buf, len);
+		if(n >= 0 && n != (ssize_t)len)
+			errno = ENOSPC;
+		else if(n >= 0 && fsync(fd) == 0 && close(fd) == 0
+			&& rename(tmp, c->path) == 0)
+			ret = 0;
+		fd = -1;
+	}
+	if(ret)
+		unlink(tmp);
+
+done:
+	if(ret) {
+		int saved = errno;
+		if(fd >= 0)
+			close(fd);
+		cache_unlock(c);
+		errno = saved;
+	} else {
+		cache_unlock(c);
+	}
+	free(tmp);
+	free(buf);
+	table_free(&t);
+	return ret;
+}
+
+int sha3_cache_close(struct sha3_cache *c)
+{
+	int ret = 0;
+
+	if(c->table.bad || (c->table.dead >= CACHE_COMPACT_MIN
+			    && c->table.dead > c->table.used))
+		ret = cache_compact(c);
+	if(c->fd >= 0 && close(c->fd) && ret == 0)
+		ret = -1;
+	c->fd = -1;
+	if(ret) {
+		int saved = errno;
+		cache_free(c);
+		errno = saved;
+	} else {
+		cache_free(c);
+	}
+	return ret;
+}
+
+#ifdef HAVE_XATTR
+static void put64(unsigned char *p, uint64_t x)
+{
+	int i;
+
+	for(i = 0; i < 8; i++)
+		p[i] = (unsigned char)(x >> 8 * i);
+}
+
+/* Put the attribute's name for ALGO in NAME, or return -1 if too long.  */
+static int xattr_name(char *name, const char *algo)
+{
+	if(strlen(algo) > XATTR_NAME_MAX - (sizeof SHA3_XATTR_PREFIX - 1))
+		return -1;
+	strcat(strcpy(name, SHA3_XATTR_PREFIX), algo);
+	return 0;
+}
+
+/* Put the start of the attribute for the file ST describes in HEAD.  */
+static void xattr_head(unsigned char *head, const struct stat *st)
+{
+	head[0] = XATTR_VERSION;
+	put64(head + 1, st->st_size);
+	put64(head + 9, time_ns(&st->st_mtim));
+}
+
+int sha3_xattr_lookup(int fd, const char *algo, const struct stat *st,
+		      void *digest, size_t len)
+{
+	char name[XATTR_NAME_MAX + 1];
+	unsigned char head[XATTR_HEAD];
+	unsigned char value[XATTR_HEAD + SHA3_CACHE_MAX_DIGEST];
+	ssize_t n;
+
+	if(len > SHA3_CACHE_MAX_DIGEST || xattr_name(name, algo))
+		return 0;
+	n = fgetxattr(fd, name, value, sizeof value);
+	if(n != (ssize_t)(XATTR_HEAD + len))
+		return 0;
+	xattr_head(head, st);
+	if(memcmp(value, head, XATTR_HEAD) != 0)
+		return 0;
+	if(digest != NULL)
+		memcpy(digest, value + XATTR_HEAD, len);
+	return 1;
+}
+
+int sha3_xattr_store(int fd, const char *algo, const struct stat *st,
+		     const void *digest, size_t len)
+{
+	char name[XATTR_NAME_MAX + 1];
+	unsigned char value[XATTR_HEAD + SHA3_CACHE_MAX_DIGEST];
+
+	if(len > SHA3_CACHE_MAX_DIGEST || xattr_name(name, algo)
+	   || racy(&st->st_mtim))
+		return 0;
+	xattr_head(value, st);
+	memcpy(value + XATTR_HEAD, digest, len);
+	return fsetxattr(fd, name, value, XATTR_HEAD + len, 0);
+}
+#else
+int sha3_xattr_lookup(int fd, const char *algo, const struct stat *st,
+		      void *digest, size_t len)
+{
+	return 0;
+}
+
+int sha3_xattr_store(int fd, const char *algo, const struct stat *st,
+		     const void *digest, size_t len)
+{
+	errno = ENOTSUP;
+	return -1;
+}
+#endif
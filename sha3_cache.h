@@ -0,0 +1,76 @@
+/* Remember the digests of files from one run to the next.
+   Written for use with the GNU Coreutils md5sum program.
+   Copyright (C) 2008 Sam Fredrickson <kinghajj@gmail.com>
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SHA3_CACHE_H
+#define SHA3_CACHE_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* The most bytes of digest one cache entry holds.  */
+#define SHA3_CACHE_MAX_DIGEST 1024
+
+/* A file of digests, each recorded against the device, inode, size,
+   modification and status change times a file had when it was hashed,
+   and the algorithm it was hashed with.  Several programs may use one
+   cache file at once.  All the functions may be called from any thread.  */
+struct sha3_cache;
+
+/* Open the cache file PATH, creating it if need be, for looking up and
+   recording digests made with ALGO, a string naming the algorithm and
+   its parameters.  Returns null, with errno set, on failure; errno is
+   EINVAL if PATH is not a cache file.  */
+struct sha3_cache *sha3_cache_open(const char *path, const char *algo);
+
+/* If a digest of LEN bytes is recorded for the file ST describes, with
+   its current size and times, copy it to DIGEST, unless that is null, and
+   return 1; otherwise return 0.  */
+int sha3_cache_lookup(struct sha3_cache *cache, const struct stat *st,
+		      void *digest, size_t len);
+
+/* Record the LEN-byte DIGEST of the file ST describes, as it was before
+   it was read.  A file changed within the last second is not recorded:
+   it may change again without its times changing.  Returns 0 on success
+   or if nothing was recorded, and -1, with errno set, if the cache file
+   could not be written.  */
+int sha3_cache_store(struct sha3_cache *cache, const struct stat *st,
+		     const void *digest, size_t len);
+
+/* Close CACHE, first rewriting the cache file without the entries later
+   ones replaced if they have come to outnumber the rest.  Returns 0 on
+   success and -1, with errno set, on failure.  */
+int sha3_cache_close(struct sha3_cache *cache);
+
+/* Digests can instead be kept with each file, in an extended attribute
+   named SHA3_XATTR_PREFIX followed by the algorithm and build, as in
+   "user.sha3sums.skein-512/64", along with the size and modification time
+   the file had when it was hashed.  The status change time cannot be
+   kept: setting the attribute changes it.  */
+#define SHA3_XATTR_PREFIX "user.sha3sums."
+
+/* Like sha3_cache_lookup, for the file open on FD, whose status is ST.  */
+int sha3_xattr_lookup(int fd, const char *algo, const struct stat *st,
+		      void *digest, size_t len);
+
+/* Like sha3_cache_store, for the file open on FD, whose status was ST
+   before it was read, but only its modification time need be a second
+   old.  Fails with ENOTSUP where there are no extended attributes.  */
+int sha3_xattr_store(int fd, const char *algo, const struct stat *st,
+		     const void *digest, size_t len);
+
+#endif
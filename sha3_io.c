@@ -0,0 +1,537 @@
+/* Read a file ahead of the code hashing it.
+   Written for use with the GNU Coreutils md5sum program.
+   Copyright (C) 2008 Sam Fredrickson <kinghajj@gmail.com>
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* The file is cut into blocks of the reader's size, block N starting N
+   blocks past the offset reading began at, and block N is read into slot
+   N % SHA3_READ_DEPTH.  A slot is read into again once the consumer hands
+   its block back, so up to SHA3_READ_DEPTH blocks are being read or
+   waiting to be hashed at any time.  The first short block is the last.
+
+   With SHA3_READ_DIRECT the file is switched to O_DIRECT for as long as it
+   is being read.  The buffers and blocks are page aligned, so every read
+   but the last is; the last, once it comes up short, continues from an
+   unaligned offset, which the kernel may refuse with EINVAL.  A file system
+   without O_DIRECT may refuse any read the same way.  Either way O_DIRECT
+   is dropped and the read retried through the page cache, and each block
+   is dropped from the cache once it has been read.  */
+
+/* For O_DIRECT.  */
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE 1
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sha3_io.h"
+
+#if defined __linux__ && defined __has_include
+# if __has_include(<linux/io_uring.h>)
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <sys/uio.h>
+#  ifdef __NR_io_uring_setup
+#   define HAVE_IO_URING 1
+#  endif
+# endif
+#endif
+
+struct slot {
+	unsigned char *data;
+	size_t len;
+	int error;
+	/* Set once LEN bytes are all the block will hold, or on an error.  */
+	int done;
+	/* Set if the block is being, or was, read with O_DIRECT throughout,
+	   which leaves nothing of it in the page cache.  */
+	int direct;
+};
+
+#ifdef HAVE_IO_URING
+/* The parts of an io_uring shared with the kernel.  */
+struct ring {
+	int fd;
+	unsigned int *sq_tail, *sq_mask, *sq_array;
+	unsigned int *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sq_map, *cq_map;
+	size_t sq_map_size, cq_map_size, sqes_size;
+	/* Reads submitted and not yet completed.  */
+	unsigned int pending;
+};
+#endif
+
+struct sha3_reader {
+	int fd;
+	off_t offset;
+	size_t size;
+	unsigned char *buffers;
+	struct slot slot[SHA3_READ_DEPTH];
+
+	/* The block the consumer gets next, the number it has handed back,
+	   and the number whose reads have been started.  */
+	unsigned long next;
+	unsigned long freed;
+	unsigned long issued;
+	int eof;
+
+#ifdef HAVE_IO_URING
+	int use_ring;
+	struct ring ring;
+	struct iovec iov[SHA3_READ_DEPTH];
+#endif
+
+	/* With SHA3_READ_DIRECT, whether blocks are dropped from the page
+	   cache, and whether O_DIRECT is still set, in which case FLAGS are
+	   the file status flags it was added to.  Only whoever reads the
+	   blocks changes DIRECT.  */
+	int dontneed;
+	int direct;
+	int flags;
+
+	/* Without io_uring, and for pipes, a thread reads the blocks.  */
+	int threaded;
+	int closing;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+static off_t block_offset(const struct sha3_reader *rd, unsigned long block)
+{
+	return rd->offset + (off_t) block * rd->size;
+}
+
+/* Go back to reading through the page cache.  */
+static void direct_off(struct sha3_reader *rd)
+{
+	fcntl(rd->fd, F_SETFL, rd->flags);
+	rd->direct = 0;
+}
+
+#ifdef HAVE_IO_URING
+static int ring_enter(const struct ring *r, unsigned int to_submit,
+		      unsigned int min_complete, unsigned int flags)
+{
+	return syscall(__NR_io_uring_enter, r->fd, to_submit, min_complete,
+		       flags, NULL, 0);
+}
+
+static void ring_unmap(struct ring *r)
+{
+	if(r->sqes && r->sqes != MAP_FAILED)
+		munmap(r->sqes, r->sqes_size);
+	if(r->cq_map && r->cq_map != MAP_FAILED && r->cq_map != r->sq_map)
+		munmap(r->cq_map, r->cq_map_size);
+	if(r->sq_map && r->sq_map != MAP_FAILED)
+		munmap(r->sq_map, r->sq_map_size);
+	close(r->fd);
+}
+
+/* Set up R with room for ENTRIES reads.  Returns -1 if the kernel has no
+   io_uring or will not let this process use it.  */
+static int ring_setup(struct ring *r, unsigned int entries)
+{
+	struct io_uring_params p;
+	unsigned char *sq, *cq;
+
+	memset(r, 0, sizeof *r);
+	memset(&p, 0, sizeof p);
+	r->fd = syscall(__NR_io_uring_setup, entries, &p);
+	if(r->fd < 0)
+		return -1;
+
+	r->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+	r->cq_map_size = p.cq_off.cqes +
+			 p.cq_entries * sizeof(struct io_uring_cqe);
+	r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+	if(p.features & IORING_FEAT_SINGLE_MMAP) {
+		if(r->cq_map_size > r->sq_map_size)
+			r->sq_map_size = r->cq_map_size;
+		r->cq_map_size = r->sq_map_size;
+	}
+#endif
+
+	r->sq_map = mmap(NULL, r->sq_map_size, PROT_READ | PROT_WRITE,
+			 MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+	if(r->sq_map == MAP_FAILED) {
+		ring_unmap(r);
+		return -1;
+	}
+#ifdef IORING_FEAT_SINGLE_MMAP
+	if(p.features & IORING_FEAT_SINGLE_MMAP)
+		r->cq_map = r->sq_map;
+	else
+#endif
+		r->cq_map = mmap(NULL, r->cq_map_size, PROT_READ | PROT_WRITE,
+				 MAP_SHARED | MAP_POPULATE, r->fd,
+				 IORING_OFF_CQ_RING);
+	r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE,
+		       MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+	if(r->cq_map == MAP_FAILED || r->sqes == MAP_FAILED) {
+		ring_unmap(r);
+		return -1;
+	}
+
+	sq = r->sq_map;
+	cq = r->cq_map;
+	r->sq_tail = (unsigned int *) (sq + p.sq_off.tail);
+	r->sq_mask = (unsigned int *) (sq + p.sq_off.ring_mask);
+	r->sq_array = (unsigned int *) (sq + p.sq_off.array);
+	r->cq_head = (unsigned int *) (cq + p.cq_off.head);
+	r->cq_tail = (unsigned int *) (cq + p.cq_off.tail);
+	r->cq_mask = (unsigned int *) (cq + p.cq_off.ring_mask);
+	r->cqes = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+
+	return 0;
+}
+
+/* Start reading the rest of slot I, whose block is BLOCK.  */
+static int ring_read(struct sha3_reader *rd, size_t i, unsigned long block)
+{
+	struct ring *r = &rd->ring;
+	struct slot *s = &rd->slot[i];
+	struct io_uring_sqe *sqe;
+	unsigned int tail, index;
+	int n;
+
+	rd->iov[i].iov_base = s->data + s->len;
+	rd->iov[i].iov_len = rd->size - s->len;
+
+	tail = *r->sq_tail;
+	index = tail & *r->sq_mask;
+	sqe = &r->sqes[index];
+	memset(sqe, 0, sizeof *sqe);
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = rd->fd;
+	sqe->off = block_offset(rd, block) + s->len;
+	sqe->addr = (unsigned long) &rd->iov[i];
+	sqe->len = 1;
+	sqe->user_data = block;
+	s->direct = rd->direct;
+	r->sq_array[index] = index;
+	__atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	while((n = ring_enter(r, 1, 0, 0)) < 0 && errno == EINTR)
+		;
+	if(n < 1) {
+		/* Nothing reads the queue but io_uring_enter, so the entry can
+		   be taken back.  */
+		__atomic_store_n(r->sq_tail, tail, __ATOMIC_RELEASE);
+		if(n == 0)
+			errno = EAGAIN;
+		return -1;
+	}
+	r->pending++;
+
+	return 0;
+}
+
+/* Wait for one read to complete and record its result.  */
+static int ring_complete(struct sha3_reader *rd)
+{
+	struct ring *r = &rd->ring;
+	struct io_uring_cqe cqe;
+	struct slot *s;
+	unsigned int head;
+
+	for(;;) {
+		head = *r->cq_head;
+		if(head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE))
+			break;
+		if(ring_enter(r, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+		   errno != EINTR)
+			return -1;
+	}
+	cqe = r->cqes[head & *r->cq_mask];
+	__atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+	r->pending--;
+
+	s = &rd->slot[cqe.user_data % SHA3_READ_DEPTH];
+	if(cqe.res == -EINVAL && s->direct && rd->direct)
+		direct_off(rd);
+	if(cqe.res == -EINTR || cqe.res == -EAGAIN ||
+	   (cqe.res == -EINVAL && s->direct) ||
+	   (cqe.res > 0 && (s->len += cqe.res) < rd->size)) {
+		/* Interrupted, short or refused O_DIRECT: read the rest of
+		   the block.  */
+		if(ring_read(rd, cqe.user_data % SHA3_READ_DEPTH,
+			     cqe.user_data) == 0)
+			return 0;
+		s->error = errno;
+	} else if(cqe.res < 0)
+		s->error = -cqe.res;
+	s->done = 1;
+
+	return 0;
+}
+#endif
+
+/* Read block BLOCK into slot S with pread, or with read if the file is
+   being read sequentially.  Pipes return what they have, so a block is only
+   short at the end of the file.  */
+static void read_block(struct sha3_reader *rd, struct slot *s,
+		       unsigned long block)
+{
+	ssize_t n;
+
+	s->direct = rd->direct;
+	while(s->len < rd->size) {
+		if(rd->offset < 0)
+			n = read(rd->fd, s->data + s->len, rd->size - s->len);
+		else
+			n = pread(rd->fd, s->data + s->len, rd->size - s->len,
+				  block_offset(rd, block) + s->len);
+		if(n < 0 && errno == EINVAL && rd->direct) {
+			direct_off(rd);
+			s->direct = 0;
+			continue;
+		}
+		if(n < 0 && errno == EINTR)
+			continue;
+		if(n < 0)
+			s->error = errno;
+		if(n <= 0)
+			break;
+		s->len += n;
+	}
+}
+
+static void *read_ahead(void *arg)
+{
+	struct sha3_reader *rd = arg;
+	struct slot *s;
+	unsigned long block;
+	int closing;
+
+	for(block = 0; ; block++) {
+		s = &rd->slot[block % SHA3_READ_DEPTH];
+
+		/* Wait for the consumer to hand the slot back.  */
+		pthread_mutex_lock(&rd->lock);
+		while(block >= rd->freed + SHA3_READ_DEPTH && !rd->closing)
+			pthread_cond_wait(&rd->cond, &rd->lock);
+		closing = rd->closing;
+		pthread_mutex_unlock(&rd->lock);
+		if(closing)
+			break;
+
+		s->len = 0;
+		s->error = 0;
+		read_block(rd, s, block);
+
+		pthread_mutex_lock(&rd->lock);
+		s->done = 1;
+		pthread_cond_broadcast(&rd->cond);
+		pthread_mutex_unlock(&rd->lock);
+
+		if(s->error || s->len < rd->size)
+			break;
+	}
+
+	return NULL;
+}
+
+/* Start reading every block whose slot is free.  */
+static void issue(struct sha3_reader *rd)
+{
+	struct slot *s;
+
+	while(rd->issued < rd->freed + SHA3_READ_DEPTH) {
+		s = &rd->slot[rd->issued % SHA3_READ_DEPTH];
+		s->len = 0;
+		s->error = 0;
+		s->done = 0;
+#ifdef HAVE_IO_URING
+		if(rd->use_ring) {
+			if(ring_read(rd, rd->issued % SHA3_READ_DEPTH,
+				     rd->issued) != 0) {
+				s->error = errno;
+				s->done = 1;
+			}
+		} else
+#endif
+		if(!rd->threaded) {
+			/* The reader thread could not be started.  */
+			read_block(rd, s, rd->issued);
+			s->done = 1;
+		}
+		rd->issued++;
+	}
+}
+
+/* Switch the file to O_DIRECT if it can be read that way from the offset
+   reading starts at, and drop what is read of it from the page cache either
+   way.  */
+static void direct_on(struct sha3_reader *rd, long page)
+{
+	rd->dontneed = 1;
+#ifdef O_DIRECT
+	if(rd->offset % page)
+		return;
+	rd->flags = fcntl(rd->fd, F_GETFL);
+	rd->direct = rd->flags != -1 && !(rd->flags & O_DIRECT) &&
+		     fcntl(rd->fd, F_SETFL, rd->flags | O_DIRECT) == 0;
+#endif
+}
+
+struct sha3_reader *sha3_reader_open(int fd, off_t offset, size_t size,
+				     int flags)
+{
+	struct sha3_reader *rd;
+	long page = sysconf(_SC_PAGESIZE);
+	size_t i;
+	int err;
+
+	if(page < 1)
+		page = 4096;
+	if(!size)
+		size = SHA3_READ_SIZE;
+	if(size > SIZE_MAX / SHA3_READ_DEPTH - page) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	size = (size + page - 1) / page * page;
+
+	rd = calloc(1, sizeof *rd);
+	if(!rd)
+		return NULL;
+	err = posix_memalign((void **) &rd->buffers, page,
+			     SHA3_READ_DEPTH * size);
+	if(err) {
+		free(rd);
+		errno = err;
+		return NULL;
+	}
+
+	rd->fd = fd;
+	rd->offset = offset;
+	rd->size = size;
+	for(i = 0; i < SHA3_READ_DEPTH; i++)
+		rd->slot[i].data = rd->buffers + i * size;
+	if((flags & SHA3_READ_DIRECT) && offset >= 0)
+		direct_on(rd, page);
+	pthread_mutex_init(&rd->lock, NULL);
+	pthread_cond_init(&rd->cond, NULL);
+
+#ifdef HAVE_IO_URING
+	rd->use_ring = offset >= 0 &&
+		       ring_setup(&rd->ring, SHA3_READ_DEPTH) == 0;
+	if(rd->use_ring) {
+		issue(rd);
+		return rd;
+	}
+#endif
+	rd->threaded = pthread_create(&rd->thread, NULL, read_ahead, rd) == 0;
+	if(rd->threaded)
+		rd->issued = SHA3_READ_DEPTH;
+	else
+		issue(rd);
+
+	return rd;
+}
+
+int sha3_reader_next(struct sha3_reader *rd, const unsigned char **data,
+		     size_t *len)
+{
+	struct slot *s;
+
+	/* The block handed out last time may be read into again.  */
+	if(rd->next > rd->freed && !rd->eof) {
+		pthread_mutex_lock(&rd->lock);
+		rd->slot[(rd->next - 1) % SHA3_READ_DEPTH].done = 0;
+		rd->freed = rd->next;
+		pthread_cond_broadcast(&rd->cond);
+		pthread_mutex_unlock(&rd->lock);
+		if(!rd->threaded)
+			issue(rd);
+	}
+
+	*data = NULL;
+	*len = 0;
+	if(rd->eof)
+		return 0;
+
+	s = &rd->slot[rd->next % SHA3_READ_DEPTH];
+#ifdef HAVE_IO_URING
+	while(rd->use_ring && !s->done) {
+		if(ring_complete(rd) != 0) {
+			s->error = errno;
+			s->done = 1;
+		}
+	}
+#endif
+	pthread_mutex_lock(&rd->lock);
+	while(!s->done)
+		pthread_cond_wait(&rd->cond, &rd->lock);
+	pthread_mutex_unlock(&rd->lock);
+
+	if(s->error) {
+		rd->eof = 1;
+		errno = s->error;
+		return -1;
+	}
+
+	/* The block is in the buffer now, so the page cache can let go of
+	   whatever reading it through the cache put there.  */
+	if(rd->dontneed && !s->direct && s->len)
+		posix_fadvise(rd->fd, block_offset(rd, rd->next), s->len,
+			      POSIX_FADV_DONTNEED);
+
+	*data = s->data;
+	*len = s->len;
+	rd->eof = s->len < rd->size;
+	rd->next++;
+
+	return 0;
+}
+
+void sha3_reader_close(struct sha3_reader *rd)
+{
+	int drained = 1;
+
+	if(rd->threaded) {
+		pthread_mutex_lock(&rd->lock);
+		rd->closing = 1;
+		pthread_cond_broadcast(&rd->cond);
+		pthread_mutex_unlock(&rd->lock);
+		pthread_join(rd->thread, NULL);
+	}
+#ifdef HAVE_IO_URING
+	if(rd->use_ring) {
+		/* The kernel may still be writing into the buffers.  */
+		while(rd->ring.pending && drained)
+			drained = ring_complete(rd) == 0;
+		ring_unmap(&rd->ring);
+	}
+#endif
+	if(rd->direct)
+		direct_off(rd);
+
+	pthread_cond_destroy(&rd->cond);
+	pthread_mutex_destroy(&rd->lock);
+	if(drained)
+		free(rd->buffers);
+	free(rd);
+}
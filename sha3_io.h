@@ -0,0 +1,59 @@
+/* Read a file ahead of the code hashing it.
+   Written for use with the GNU Coreutils md5sum program.
+   Copyright (C) 2008 Sam Fredrickson <kinghajj@gmail.com>
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SHA3_IO_H
+#define SHA3_IO_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/* How much a reader reads at once by default, and how many of those reads
+   it keeps in flight or waiting to be hashed.  */
+#define SHA3_READ_SIZE (1 << 20)
+#define SHA3_READ_DEPTH 4
+
+/* Flags for sha3_reader_open.  SHA3_READ_DIRECT keeps the file out of the
+   page cache: it is read with O_DIRECT where the file system allows it, and
+   otherwise what was read is dropped from the cache once it has been.  */
+#define SHA3_READ_DIRECT 1
+
+/* A file being read SHA3_READ_DEPTH buffers ahead of its consumer: through
+   io_uring where the kernel offers it, otherwise by a thread of its own
+   calling pread, or read for a pipe.  The thread waits whenever every
+   buffer is full, until the consumer hands one back.  */
+struct sha3_reader;
+
+/* Start reading the file open on FD from OFFSET to its end, or, if OFFSET
+   is negative, from wherever FD is to the end of its input, as a pipe or
+   terminal must be read.  SIZE bytes are read at once, SHA3_READ_SIZE if it
+   is zero, rounded up to a whole number of pages.  FLAGS is zero or
+   SHA3_READ_DIRECT, which has no effect on a pipe.  Returns null, with
+   errno set, on failure.  */
+struct sha3_reader *sha3_reader_open(int fd, off_t offset, size_t size,
+				     int flags);
+
+/* Wait for the next buffer of the file and point *DATA and *LEN at it; *LEN
+   is 0 at the end of the file.  The buffer stays valid until the next call,
+   which hands it back to be read into again.  Returns 0 on success and -1,
+   with errno set, on a read error.  */
+int sha3_reader_next(struct sha3_reader *reader, const unsigned char **data,
+		     size_t *len);
+
+/* Stop reading and free READER.  */
+void sha3_reader_close(struct sha3_reader *reader);
+
+#endif
@@ -0,0 +1,424 @@
+/* Benchmark every build of every NIST SHA-3 contest entry linked in.
+   Written for use with the GNU Coreutils md5sum program.
+   Copyright (C) 2008 Sam Fredrickson <kinghajj@gmail.com>
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Each message is hashed from memory, in the same Update windows sha3_mmap
+   uses, so neither the disk nor the page cache is measured.
+   Every sample is one Init/Update/Final of the whole message; a size is
+   sampled until both --reps samples and --time seconds have been taken.
+   With --cache-misses, each sample also counts the level 1 data cache
+   read misses the hashing took, through a Linux perf event, so that builds
+   differing mainly in the size of their tables can be compared. */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <getopt.h>
+#include <time.h>
+#if defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+# include <x86intrin.h>
+# define HAVE_RDTSC 1
+#endif
+#ifdef __linux__
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# define HAVE_PERF_EVENT 1
+#endif
+#include "sha3.h"
+
+#define WINDOW_SIZE (1 << 20)
+#define MIN_SIZE ((size_t) 16)
+#define MAX_SIZE ((size_t) 1 << 30)
+#define MAX_SAMPLES 100000
+
+struct sample {
+	uint64_t ns;
+	uint64_t cycles;
+	uint64_t misses;
+};
+
+static const char *only_algo;
+static const char *only_type;
+static const char *variant;
+static int hashbitlen = 256;
+static size_t min_size = MIN_SIZE;
+static size_t max_size = MAX_SIZE;
+static size_t min_reps = 5;
+static double min_time = 0.5;
+static int json;
+static int miss_fd = -1;
+
+static const struct option long_options[] = {
+	{ "algo", required_argument, NULL, 'a' },
+	{ "bits", required_argument, NULL, 'b' },
+	{ "cache-misses", no_argument, NULL, 'c' },
+	{ "impl", required_argument, NULL, 'i' },
+	{ "json", no_argument, NULL, 'j' },
+	{ "min-size", required_argument, NULL, 'm' },
+	{ "max-size", required_argument, NULL, 'M' },
+	{ "reps", required_argument, NULL, 'r' },
+	{ "time", required_argument, NULL, 't' },
+	{ "variant", required_argument, NULL, 'v' },
+	{ "help", no_argument, NULL, 'h' },
+	{ NULL, 0, NULL, 0 }
+};
+
+static void usage(const char *program_name, int status)
+{
+	fprintf(status ? stderr : stdout, "\
+Usage: %s [OPTION]...\n\
+Measure the speed of every entry and build linked into this program.\n\
+\n\
+  -a, --algo=NAME       only benchmark entry NAME\n\
+  -i, --impl=TYPE       only benchmark builds of TYPE (ref, 32 or 64)\n\
+  -b, --bits=BITS       digest size: 224, 256 (default), 384 or 512\n\
+  -m, --min-size=BYTES  smallest message (default 16)\n\
+  -M, --max-size=BYTES  largest message (default 1073741824); sizes go\n\
+                        up by a factor of 4\n\
+  -r, --reps=N          take at least N samples per size (default 5)\n\
+  -t, --time=SECONDS    and sample each size for at least this long\n\
+                        (default 0.5)\n\
+  -v, --variant=NAME    time variant NAME of the compression function of\n\
+                        builds that have several, instead of the one a\n\
+                        short timing run finds fastest, as sha3sum does\n\
+  -c, --cache-misses    also count level 1 data cache read misses\n\
+  -j, --json            print JSON instead of CSV\n\
+", program_name);
+	exit(status);
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t now_cycles(void)
+{
+#ifdef HAVE_RDTSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+/* Open a counter of the level 1 data cache read misses of this thread and
+   the threads it goes on to start in miss_fd, or leave it -1 and return -1
+   where there is none.  */
+static int open_miss_counter(void)
+{
+#ifdef HAVE_PERF_EVENT
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof attr);
+	attr.size = sizeof attr;
+	attr.type = PERF_TYPE_HW_CACHE;
+	attr.config = PERF_COUNT_HW_CACHE_L1D
+		| (PERF_COUNT_HW_CACHE_OP_READ << 8)
+		| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	attr.inherit = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	miss_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+	if(miss_fd >= 0)
+		ioctl(miss_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+	return miss_fd < 0 ? -1 : 0;
+}
+
+static uint64_t now_misses(void)
+{
+	uint64_t count = 0;
+
+#ifdef HAVE_PERF_EVENT
+	if(miss_fd >= 0 && read(miss_fd, &count, sizeof count) != sizeof count)
+		count = 0;
+#endif
+	return count;
+}
+
+/* Hash the LEN bytes at DATA once with ALGO.  */
+static int hash_once(const struct sha3_algo *algo, void *state,
+		     const unsigned char *data, size_t len)
+{
+	unsigned char digest[64];
+	size_t window = algo->window ? algo->window : WINDOW_SIZE;
+	size_t chunk;
+	int r;
+
+	r = algo->init(state, hashbitlen);
+	while(r == 0 && len) {
+		chunk = len < window ? len : window;
+		r = algo->update(state, data, (unsigned long long) chunk * 8);
+		data += chunk;
+		len -= chunk;
+	}
+	if(r == 0)
+		r = algo->final(state, digest);
+
+	return r;
+}
+
+static int compare_ns(const void *a, const void *b)
+{
+	const struct sample *x = a, *y = b;
+
+	return x->ns < y->ns ? -1 : x->ns > y->ns;
+}
+
+static int compare_cycles(const void *a, const void *b)
+{
+	const struct sample *x = a, *y = b;
+
+	return x->cycles < y->cycles ? -1 : x->cycles > y->cycles;
+}
+
+static int compare_misses(const void *a, const void *b)
+{
+	const struct sample *x = a, *y = b;
+
+	return x->misses < y->misses ? -1 : x->misses > y->misses;
+}
+
+/* The nearest-rank PERCENTILE of the N sorted samples.  */
+static size_t rank(size_t n, int percentile)
+{
+	size_t r = (n * percentile + 99) / 100;
+
+	return r ? r - 1 : 0;
+}
+
+static void report(const struct sha3_algo *algo, size_t len,
+		   struct sample *samples, size_t n, int first)
+{
+	uint64_t median_ns, p99_ns, median_cycles, p99_cycles, median_misses;
+	double gbps;
+
+	qsort(samples, n, sizeof *samples, compare_ns);
+	median_ns = samples[rank(n, 50)].ns;
+	p99_ns = samples[rank(n, 99)].ns;
+	qsort(samples, n, sizeof *samples, compare_cycles);
+	median_cycles = samples[rank(n, 50)].cycles;
+	p99_cycles = samples[rank(n, 99)].cycles;
+	qsort(samples, n, sizeof *samples, compare_misses);
+	median_misses = samples[rank(n, 50)].misses;
+	gbps = median_ns ? (double) len / median_ns : 0;
+
+	if(json) {
+		printf("%s  {\"entry\": \"%s\", \"type\": \"%s\", "
+		       "\"bits\": %d, \"bytes\": %lu, \"samples\": %lu, "
+		       "\"median_ns\": %llu, \"p99_ns\": %llu, ",
+		       first ? "" : ",\n", algo->name, algo->type, hashbitlen,
+		       (unsigned long) len, (unsigned long) n,
+		       (unsigned long long) median_ns,
+		       (unsigned long long) p99_ns);
+#ifdef HAVE_RDTSC
+		printf("\"median_cpb\": %.3f, \"p99_cpb\": %.3f, ",
+		       (double) median_cycles / len,
+		       (double) p99_cycles / len);
+#else
+		printf("\"median_cpb\": null, \"p99_cpb\": null, ");
+#endif
+		printf("\"median_gbps\": %.6g, ", gbps);
+		if(miss_fd >= 0)
+			printf("\"median_l1d_misses_pb\": %.6g}",
+			       (double) median_misses / len);
+		else
+			printf("\"median_l1d_misses_pb\": null}");
+	} else {
+		printf("%s,%s,%d,%lu,%lu,%llu,%llu,", algo->name, algo->type,
+		       hashbitlen, (unsigned long) len, (unsigned long) n,
+		       (unsigned long long) median_ns,
+		       (unsigned long long) p99_ns);
+#ifdef HAVE_RDTSC
+		printf("%.3f,%.3f,", (double) median_cycles / len,
+		       (double) p99_cycles / len);
+#else
+		printf(",,");
+#endif
+		printf("%.6g,", gbps);
+		if(miss_fd >= 0)
+			printf("%.6g\n", (double) median_misses / len);
+		else
+			printf("\n");
+	}
+	fflush(stdout);
+}
+
+static size_t parse_number(const char *s, const char *program_name)
+{
+	char *end;
+	unsigned long long v = strtoull(s, &end, 10);
+
+	if(end == s || *end || v == 0 || v > SIZE_MAX) {
+		fprintf(stderr, "%s: invalid number: %s\n", program_name, s);
+		exit(EXIT_FAILURE);
+	}
+
+	return v;
+}
+
+int main(int argc, char **argv)
+{
+	const struct sha3_algo *const *a;
+	struct sample *samples;
+	unsigned char *data;
+	void *state;
+	size_t len, i, n;
+	uint64_t deadline, t0, c0, m0;
+	int opt, failed, first = 1, status = EXIT_SUCCESS, misses = 0;
+
+	while((opt = getopt_long(argc, argv, "a:b:ci:jm:M:r:t:v:h",
+				 long_options, NULL)) != -1) {
+		switch(opt) {
+		case 'a':
+			only_algo = optarg;
+			break;
+		case 'b':
+			hashbitlen = atoi(optarg);
+			if(hashbitlen != 224 && hashbitlen != 256 &&
+			   hashbitlen != 384 && hashbitlen != 512) {
+				fprintf(stderr, "%s: invalid digest size: %s\n",
+					argv[0], optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'c':
+			misses = 1;
+			break;
+		case 'i':
+			only_type = optarg;
+			break;
+		case 'j':
+			json = 1;
+			break;
+		case 'm':
+			min_size = parse_number(optarg, argv[0]);
+			break;
+		case 'M':
+			max_size = parse_number(optarg, argv[0]);
+			break;
+		case 'r':
+			min_reps = parse_number(optarg, argv[0]);
+			if(min_reps > MAX_SAMPLES)
+				min_reps = MAX_SAMPLES;
+			break;
+		case 't':
+			min_time = atof(optarg);
+			break;
+		case 'v':
+			variant = optarg;
+			break;
+		case 'h':
+			usage(argv[0], EXIT_SUCCESS);
+		default:
+			usage(argv[0], EXIT_FAILURE);
+		}
+	}
+	if(optind != argc || min_size > max_size)
+		usage(argv[0], EXIT_FAILURE);
+
+	data = malloc(max_size);
+	samples = malloc(MAX_SAMPLES * sizeof *samples);
+	if(!data || !samples) {
+		fprintf(stderr, "%s: memory exhausted\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if(misses && open_miss_counter() < 0)
+		fprintf(stderr, "%s: cannot count cache misses on this "
+			"system\n", argv[0]);
+
+	/* Fill (and so fault in) the message with pseudo-random bytes.  */
+	for(i = 0; i < max_size; i++)
+		data[i] = (unsigned char) ((i * 2654435761u) >> 13);
+
+	if(json)
+		printf("[\n");
+	else
+		printf("entry,type,bits,bytes,samples,median_ns,p99_ns,"
+		       "median_cpb,p99_cpb,median_gbps,"
+		       "median_l1d_misses_pb\n");
+
+	for(a = sha3_algos; *a; a++) {
+		if((only_algo && strcasecmp((*a)->name, only_algo) != 0) ||
+		   (only_type && strcmp((*a)->type, only_type) != 0))
+			continue;
+		if(!sha3_usable(*a)) {
+			fprintf(stderr, "%s: skipping %s %s: unsupported by "
+				"this CPU\n", argv[0], (*a)->name, (*a)->type);
+			continue;
+		}
+		if((*a)->use_variant && (*a)->use_variant(variant) != 0) {
+			fprintf(stderr, "%s: skipping %s %s: no variant %s\n",
+				argv[0], (*a)->name, (*a)->type, variant);
+			continue;
+		}
+
+		state = calloc(1, (*a)->state_size);
+		if(!state) {
+			fprintf(stderr, "%s: memory exhausted\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+
+		for(len = min_size; len <= max_size; ) {
+			deadline = now_ns() + (uint64_t) (min_time * 1e9);
+			failed = 0;
+			for(n = 0; !failed && n < MAX_SAMPLES &&
+			    (n < min_reps || now_ns() < deadline); n++) {
+				m0 = now_misses();
+				t0 = now_ns();
+				c0 = now_cycles();
+				failed = hash_once(*a, state, data, len);
+				samples[n].cycles = now_cycles() - c0;
+				samples[n].ns = now_ns() - t0;
+				samples[n].misses = now_misses() - m0;
+			}
+			if(failed) {
+				fprintf(stderr, "%s: %s %s failed\n", argv[0],
+					(*a)->name, (*a)->type);
+				status = EXIT_FAILURE;
+				break;
+			}
+			report(*a, len, samples, n, first);
+			first = 0;
+
+			if(len > max_size / 4)
+				break;
+			len *= 4;
+		}
+
+		free(state);
+	}
+
+	if(json)
+		printf("\n]\n");
+
+#ifdef HAVE_PERF_EVENT
+	if(miss_fd >= 0)
+		close(miss_fd);
+#endif
+	free(samples);
+	free(data);
+	return status;
+}